@@ -66,6 +66,22 @@ static double config_load_input_gain() {
     return result;
 }
 
+static int config_load_worker_threads() {
+    GKeyFile *kf = g_key_file_new();
+    std::string path = config_path();
+    int result = 0;  // 0 = acquisition runs on the decoder thread
+    if (g_key_file_load_from_file(kf, path.c_str(), G_KEY_FILE_NONE, nullptr)) {
+        GError *err = nullptr;
+        int val = g_key_file_get_integer(kf, "decoder", "worker_threads", &err);
+        if (!err)
+            result = val < 0 ? 0 : val;
+        else
+            g_error_free(err);
+    }
+    g_key_file_free(kf);
+    return result;
+}
+
 /* ── Waterfall spectrum display ─────────────────────────────────────── */
 
 static void db_to_rgb(float dB, guchar *r, guchar *g, guchar *b) {
@@ -581,6 +597,7 @@ AppWindow *app_window_new(GtkApplication *app) {
     double saved_gain = config_load_input_gain();
     gtk_range_set_value(GTK_RANGE(win->gain_slider), saved_gain);
     win->decoder.set_input_gain(static_cast<float>(std::pow(10.0, saved_gain / 20.0)));
+    win->decoder.set_worker_threads(config_load_worker_threads());
     g_signal_connect(win->gain_slider, "value-changed",
                      G_CALLBACK(on_gain_slider_changed), win);
     gtk_box_pack_start(GTK_BOX(waterfall_box), win->gain_slider, FALSE, FALSE, 0);
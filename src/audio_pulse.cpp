@@ -1,9 +1,130 @@
 #include "audio_backend.h"
+#include "resampler.h"
 
 #include <pulse/pulseaudio.h>
 #include <pulse/simple.h>
 #include <pulse/error.h>
+#include <algorithm>
 #include <cstdio>
+#include <vector>
+
+/* ── Server introspection ──────────────────────────────────────────── */
+
+/* a context on its own threaded mainloop, for one-off queries; ok() is
+   false if the server could not be reached.  Callers hold the mainloop
+   lock (taken by the constructor) for the object's lifetime */
+struct PulseQuery {
+    pa_threaded_mainloop* ml  = nullptr;
+    pa_context*           ctx = nullptr;
+
+    PulseQuery();
+    ~PulseQuery();
+    bool ok() const { return ctx != nullptr; }
+    void wait(pa_operation* op);
+};
+
+static void context_state_cb(pa_context* ctx, void* userdata)
+{
+    auto* ml = static_cast<pa_threaded_mainloop*>(userdata);
+    pa_context_state_t state = pa_context_get_state(ctx);
+    if (state == PA_CONTEXT_READY || state == PA_CONTEXT_FAILED ||
+        state == PA_CONTEXT_TERMINATED)
+        pa_threaded_mainloop_signal(ml, 0);
+}
+
+PulseQuery::PulseQuery()
+{
+    ml = pa_threaded_mainloop_new();
+    if (!ml) return;
+
+    pa_mainloop_api* api = pa_threaded_mainloop_get_api(ml);
+    ctx = pa_context_new(api, "FreeDV Monitor");
+    if (!ctx) {
+        pa_threaded_mainloop_free(ml);
+        ml = nullptr;
+        return;
+    }
+
+    pa_context_set_state_callback(ctx, context_state_cb, ml);
+
+    pa_threaded_mainloop_lock(ml);
+    pa_threaded_mainloop_start(ml);
+
+    pa_context_connect(ctx, nullptr, PA_CONTEXT_NOFLAGS, nullptr);
+
+    // Wait for context to become ready
+    while (true) {
+        pa_context_state_t state = pa_context_get_state(ctx);
+        if (state == PA_CONTEXT_READY) break;
+        if (state == PA_CONTEXT_FAILED || state == PA_CONTEXT_TERMINATED) {
+            pa_context_unref(ctx);
+            ctx = nullptr;
+            break;
+        }
+        pa_threaded_mainloop_wait(ml);
+    }
+}
+
+PulseQuery::~PulseQuery()
+{
+    if (!ml) return;
+    if (ctx) {
+        pa_context_disconnect(ctx);
+        pa_context_unref(ctx);
+    }
+    pa_threaded_mainloop_unlock(ml);
+    pa_threaded_mainloop_stop(ml);
+    pa_threaded_mainloop_free(ml);
+}
+
+void PulseQuery::wait(pa_operation* op)
+{
+    if (!op) return;
+    while (pa_operation_get_state(op) == PA_OPERATION_RUNNING)
+        pa_threaded_mainloop_wait(ml);
+    pa_operation_unref(op);
+}
+
+struct PulseRateData {
+    int rate = 0;
+    pa_threaded_mainloop* ml;
+};
+
+static void source_rate_cb(pa_context* /*ctx*/, const pa_source_info* info,
+                           int eol, void* userdata)
+{
+    auto* data = static_cast<PulseRateData*>(userdata);
+    if (info) data->rate = static_cast<int>(info->sample_spec.rate);
+    if (eol != 0) pa_threaded_mainloop_signal(data->ml, 0);
+}
+
+static void sink_rate_cb(pa_context* /*ctx*/, const pa_sink_info* info,
+                         int eol, void* userdata)
+{
+    auto* data = static_cast<PulseRateData*>(userdata);
+    if (info) data->rate = static_cast<int>(info->sample_spec.rate);
+    if (eol != 0) pa_threaded_mainloop_signal(data->ml, 0);
+}
+
+/* the rate a source or sink (empty name: the default) runs at, so streams
+   can be opened there and the server has no resampling to do; 0 if the
+   server can't say */
+static int pulse_device_rate(const std::string& name, bool source)
+{
+    PulseQuery q;
+    if (!q.ok()) return 0;
+
+    PulseRateData data{};
+    data.ml = q.ml;
+    if (source) {
+        const char* dev = name.empty() ? "@DEFAULT_SOURCE@" : name.c_str();
+        q.wait(pa_context_get_source_info_by_name(q.ctx, dev, source_rate_cb, &data));
+    } else {
+        const char* dev = name.empty() ? "@DEFAULT_SINK@" : name.c_str();
+        q.wait(pa_context_get_sink_info_by_name(q.ctx, dev, sink_rate_cb, &data));
+    }
+    return data.rate;
+}
 
 /* ── PulseAudio capture ────────────────────────────────────────────── */
 
@@ -14,18 +135,26 @@ public:
     bool open(const std::string& device_id, int sample_rate, int channels) override {
         close();
 
+        /* capture mono at the source's own rate and convert here, so the
+           server's resampler is out of the path (multi-channel callers
+           still get the server's conversion) */
+        int device_rate = (channels == 1) ? pulse_device_rate(device_id, true) : 0;
+        if (device_rate <= 0) device_rate = sample_rate;
+
         pa_sample_spec spec{};
         spec.format   = PA_SAMPLE_FLOAT32LE;
-        spec.rate     = static_cast<uint32_t>(sample_rate);
+        spec.rate     = static_cast<uint32_t>(device_rate);
         spec.channels = static_cast<uint8_t>(channels);
 
         /* Use a larger server-side buffer to avoid gaps in the capture
            stream.  fragsize tells PulseAudio how much data to deliver per
            read; we set it to match the 512-frame reads in the decoder loop
-           and allow maxlength for ~4× that so the server can buffer ahead. */
+           (scaled to the device rate) and allow maxlength for ~4× that so
+           the server can buffer ahead. */
+        size_t frag = 512 * static_cast<size_t>(device_rate) / static_cast<size_t>(sample_rate);
         pa_buffer_attr attr{};
-        attr.maxlength = static_cast<uint32_t>(2048 * sizeof(float));  // 4× read size
-        attr.fragsize  = static_cast<uint32_t>(512 * sizeof(float));  // match READ_FRAMES
+        attr.maxlength = static_cast<uint32_t>(4 * frag * sizeof(float));  // 4× read size
+        attr.fragsize  = static_cast<uint32_t>(frag * sizeof(float));      // match READ_FRAMES
         attr.tlength   = static_cast<uint32_t>(-1);  // unused for record
         attr.prebuf    = static_cast<uint32_t>(-1);  // unused for record
         attr.minreq    = static_cast<uint32_t>(-1);  // unused for record
@@ -38,19 +167,35 @@ public:
             fprintf(stderr, "PulseAudio capture open failed: %s\n", pa_strerror(err));
             return false;
         }
-        fprintf(stderr, "PulseAudio capture: %s, %d Hz, float32\n",
-                device_id.empty() ? "(default)" : device_id.c_str(), sample_rate);
+
+        rs_.reset(device_rate, sample_rate);
+        device_buf_.resize(frag);
+        pending_.clear();
+        pending_pos_ = 0;
+
+        fprintf(stderr, "PulseAudio capture: %s, %d Hz -> %d Hz, float32\n",
+                device_id.empty() ? "(default)" : device_id.c_str(), device_rate, sample_rate);
         return true;
     }
 
     int read(float* buffer, int frames) override {
         if (!pa_) return -1;
-        int err = 0;
-        int ret = pa_simple_read(pa_, buffer,
-                                 static_cast<size_t>(frames) * sizeof(float), &err);
-        if (ret < 0) {
-            fprintf(stderr, "PulseAudio read error: %s\n", pa_strerror(err));
-            return -1;
+        if (rs_.passthrough())
+            return read_device(buffer, static_cast<size_t>(frames));
+
+        int filled = 0;
+        while (filled < frames) {
+            if (pending_pos_ == pending_.size()) {
+                if (read_device(device_buf_.data(), device_buf_.size()) < 0) return -1;
+                pending_.resize(rs_.max_output(device_buf_.size()));
+                pending_.resize(rs_.process(device_buf_.data(), device_buf_.size(),
+                                            pending_.data()));
+                pending_pos_ = 0;
+            }
+            size_t m = std::min(static_cast<size_t>(frames - filled), pending_.size() - pending_pos_);
+            std::copy_n(&pending_[pending_pos_], m, buffer + filled);
+            pending_pos_ += m;
+            filled       += static_cast<int>(m);
         }
         return 0;
     }
@@ -60,7 +205,21 @@ public:
     }
 
 private:
-    pa_simple* pa_ = nullptr;
+    int read_device(float* buffer, size_t frames) {
+        int err = 0;
+        int ret = pa_simple_read(pa_, buffer, frames * sizeof(float), &err);
+        if (ret < 0) {
+            fprintf(stderr, "PulseAudio read error: %s\n", pa_strerror(err));
+            return -1;
+        }
+        return 0;
+    }
+
+    pa_simple*         pa_ = nullptr;
+    Resampler          rs_;                // device rate -> requested rate
+    std::vector<float> device_buf_;
+    std::vector<float> pending_;           // converted, not yet returned
+    size_t             pending_pos_ = 0;
 };
 
 /* ── PulseAudio playback ───────────────────────────────────────────── */
@@ -72,9 +231,13 @@ public:
     bool open(int sample_rate, int channels) override {
         close();
 
+        /* play mono at the sink's own rate, converting here */
+        int device_rate = (channels == 1) ? pulse_device_rate("", false) : 0;
+        if (device_rate <= 0) device_rate = sample_rate;
+
         pa_sample_spec spec{};
         spec.format   = PA_SAMPLE_FLOAT32LE;
-        spec.rate     = static_cast<uint32_t>(sample_rate);
+        spec.rate     = static_cast<uint32_t>(device_rate);
         spec.channels = static_cast<uint8_t>(channels);
 
         int err = 0;
@@ -84,19 +247,27 @@ public:
             fprintf(stderr, "PulseAudio playback open failed: %s\n", pa_strerror(err));
             return false;
         }
+        rs_.reset(sample_rate, device_rate);
         return true;
     }
 
     int write(const float* buffer, int frames) override {
         if (!pa_) return -1;
+        const float* out = buffer;
+        size_t n = static_cast<size_t>(frames);
+        if (!rs_.passthrough()) {
+            device_buf_.resize(rs_.max_output(n));
+            n   = rs_.process(buffer, n, device_buf_.data());
+            out = device_buf_.data();
+        }
         int err = 0;
-        int ret = pa_simple_write(pa_, buffer,
-                                  static_cast<size_t>(frames) * sizeof(float), &err);
+        int ret = pa_simple_write(pa_, out, n * sizeof(float), &err);
         return (ret < 0) ? -1 : 0;
     }
 
     void flush() override {
         if (pa_) pa_simple_flush(pa_, nullptr);
+        rs_.clear();
     }
 
     void close() override {
@@ -104,7 +275,9 @@ public:
     }
 
 private:
-    pa_simple* pa_ = nullptr;
+    pa_simple*         pa_ = nullptr;
+    Resampler          rs_;                // requested rate -> device rate
+    std::vector<float> device_buf_;
 };
 
 /* ── Device enumeration ────────────────────────────────────────────── */
@@ -134,65 +307,16 @@ static void source_info_cb(pa_context* /*ctx*/, const pa_source_info* info,
     data->devices.push_back(std::move(dev));
 }
 
-static void context_state_cb(pa_context* ctx, void* userdata)
-{
-    auto* ml = static_cast<pa_threaded_mainloop*>(userdata);
-    pa_context_state_t state = pa_context_get_state(ctx);
-    if (state == PA_CONTEXT_READY || state == PA_CONTEXT_FAILED ||
-        state == PA_CONTEXT_TERMINATED)
-        pa_threaded_mainloop_signal(ml, 0);
-}
-
 std::vector<AudioDevice> audio_enumerate_inputs()
 {
-    PulseEnumData enum_data{};
-
-    pa_threaded_mainloop* ml = pa_threaded_mainloop_new();
-    if (!ml) return {};
-
-    enum_data.ml = ml;
+    PulseQuery q;
+    if (!q.ok()) return {};
 
-    pa_mainloop_api* api = pa_threaded_mainloop_get_api(ml);
-    pa_context* ctx = pa_context_new(api, "FreeDV Monitor");
-    if (!ctx) {
-        pa_threaded_mainloop_free(ml);
-        return {};
-    }
-
-    pa_context_set_state_callback(ctx, context_state_cb, ml);
-
-    pa_threaded_mainloop_lock(ml);
-    pa_threaded_mainloop_start(ml);
-
-    pa_context_connect(ctx, nullptr, PA_CONTEXT_NOFLAGS, nullptr);
-
-    // Wait for context to become ready
-    while (true) {
-        pa_context_state_t state = pa_context_get_state(ctx);
-        if (state == PA_CONTEXT_READY) break;
-        if (state == PA_CONTEXT_FAILED || state == PA_CONTEXT_TERMINATED) {
-            pa_context_unref(ctx);
-            pa_threaded_mainloop_unlock(ml);
-            pa_threaded_mainloop_stop(ml);
-            pa_threaded_mainloop_free(ml);
-            return {};
-        }
-        pa_threaded_mainloop_wait(ml);
-    }
+    PulseEnumData enum_data{};
+    enum_data.ml = q.ml;
 
     // Enumerate sources
-    pa_operation* op = pa_context_get_source_info_list(ctx, source_info_cb, &enum_data);
-    while (pa_operation_get_state(op) == PA_OPERATION_RUNNING)
-        pa_threaded_mainloop_wait(ml);
-    pa_operation_unref(op);
-
-    pa_context_disconnect(ctx);
-    pa_context_unref(ctx);
-
-    pa_threaded_mainloop_unlock(ml);
-    pa_threaded_mainloop_stop(ml);
-    pa_threaded_mainloop_free(ml);
-
+    q.wait(pa_context_get_source_info_list(q.ctx, source_info_cb, &enum_data));
     return enum_data.devices;
 }
 
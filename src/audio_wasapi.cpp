@@ -1,13 +1,14 @@
 #include "audio_backend.h"
+#include "resampler.h"
 
 #include <windows.h>
 #include <initguid.h>
 #include <mmdeviceapi.h>
 #include <audioclient.h>
 #include <functiondiscoverykeys_devpkey.h>
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
-#include <cmath>
 #include <vector>
 
 /* ── WASAPI stream flags for automatic format conversion (Win 7+) ──── */
@@ -153,7 +154,9 @@ public:
 
         target_rate_     = sample_rate;
         target_channels_ = channels;
-        resample_pos_    = 0.0;
+        rs_.reset(device_rate_, target_rate_);
+        pending_.clear();
+        pending_pos_ = 0;
 
         fprintf(stderr, "WASAPI capture: opened %s, device %d Hz %d ch -> target %d Hz %d ch\n",
                 device_id.empty() ? "(default)" : device_id.c_str(),
@@ -167,11 +170,14 @@ public:
         int filled = 0;
         while (filled < frames) {
             /* If we have resampled data buffered, consume it first */
-            while (filled < frames && !resample_buf_.empty()) {
-                buffer[filled++] = resample_buf_.back();
-                resample_buf_.pop_back();
+            if (pending_pos_ < pending_.size()) {
+                size_t m = std::min(static_cast<size_t>(frames - filled),
+                                    pending_.size() - pending_pos_);
+                std::memcpy(buffer + filled, &pending_[pending_pos_], m * sizeof(float));
+                pending_pos_ += m;
+                filled       += static_cast<int>(m);
+                continue;
             }
-            if (filled >= frames) break;
 
             /* Get next packet from WASAPI */
             UINT32 packet_len = 0;
@@ -189,24 +195,19 @@ public:
             hr = capture_->GetBuffer(&data, &num_frames, &flags, nullptr, nullptr);
             if (FAILED(hr)) return -1;
 
-            /* Convert device format to mono float at target rate */
-            if (flags & AUDCLNT_BUFFERFLAGS_SILENT) {
-                /* Produce silence at target rate */
-                int target_frames = static_cast<int>(
-                    static_cast<double>(num_frames) * target_rate_ / device_rate_);
-                for (int i = 0; i < target_frames && filled < frames; i++)
-                    buffer[filled++] = 0.0f;
-            } else {
-                /* Step 1: extract mono float from device format */
-                std::vector<float> mono(num_frames);
-                extract_mono_float(data, mono.data(), static_cast<int>(num_frames));
-
-                /* Step 2: resample from device_rate_ to target_rate_ */
-                resample_into(mono.data(), static_cast<int>(num_frames),
-                              buffer, frames, filled);
-            }
-
+            /* Step 1: extract mono float from device format (silent packets
+               still go through the resampler, to keep its timing) */
+            mono_.resize(num_frames);
+            if (flags & AUDCLNT_BUFFERFLAGS_SILENT)
+                std::fill(mono_.begin(), mono_.end(), 0.0f);
+            else
+                extract_mono_float(data, mono_.data(), static_cast<int>(num_frames));
             capture_->ReleaseBuffer(num_frames);
+
+            /* Step 2: resample from device_rate_ to target_rate_ */
+            pending_.resize(rs_.max_output(num_frames));
+            pending_.resize(rs_.process(mono_.data(), num_frames, pending_.data()));
+            pending_pos_ = 0;
         }
         return 0;
     }
@@ -215,8 +216,8 @@ public:
         if (client_) { client_->Stop(); }
         if (capture_) { capture_->Release(); capture_ = nullptr; }
         if (client_)  { client_->Release();  client_  = nullptr; }
-        resample_buf_.clear();
-        resample_pos_ = 0.0;
+        pending_.clear();
+        pending_pos_ = 0;
     }
 
 private:
@@ -248,29 +249,6 @@ private:
         }
     }
 
-    /* Resample from device rate to target rate, filling output buffer */
-    void resample_into(const float* src, int src_frames,
-                       float* dst, int dst_max, int& dst_filled) {
-        double ratio = static_cast<double>(device_rate_) / target_rate_;
-
-        while (dst_filled < dst_max) {
-            int idx = static_cast<int>(resample_pos_);
-            if (idx + 1 >= src_frames) break;
-
-            float frac = static_cast<float>(resample_pos_ - idx);
-            dst[dst_filled++] = src[idx] + frac * (src[idx + 1] - src[idx]);
-            resample_pos_ += ratio;
-        }
-
-        /* Adjust position for consumed source frames */
-        resample_pos_ -= src_frames;
-        if (resample_pos_ < 0.0) resample_pos_ = 0.0;
-
-        /* If we have leftover output capacity, buffer any remaining
-           resampled samples for the next read() call */
-        /* (position is already adjusted, leftover handled on next packet) */
-    }
-
     IAudioClient*        client_  = nullptr;
     IAudioCaptureClient* capture_ = nullptr;
 
@@ -279,12 +257,13 @@ private:
     int  device_bps_      = 0;
     bool device_is_float_ = false;
 
-    int    target_rate_     = 0;
-    int    target_channels_ = 0;
-    double resample_pos_    = 0.0;
+    int target_rate_     = 0;
+    int target_channels_ = 0;
 
-    /* Buffer for excess resampled samples (stored in reverse for pop_back) */
-    std::vector<float> resample_buf_;
+    Resampler          rs_;                // device rate -> target rate
+    std::vector<float> mono_;
+    std::vector<float> pending_;           // resampled, not yet returned
+    size_t             pending_pos_ = 0;
 };
 
 /* ── WASAPI Playback ───────────────────────────────────────────────── */
@@ -375,7 +354,7 @@ public:
 
         source_rate_     = sample_rate;
         source_channels_ = channels;
-        resample_pos_    = 0.0;
+        rs_.reset(source_rate_, device_rate_);
 
         fprintf(stderr, "WASAPI playback: source %d Hz %d ch -> device %d Hz %d ch\n",
                 source_rate_, source_channels_, device_rate_, device_channels_);
@@ -386,39 +365,15 @@ public:
         if (!client_ || !render_) return -1;
 
         /* Resample source (e.g. 16kHz mono) to device format (e.g. 48kHz stereo) */
-        double ratio = static_cast<double>(device_rate_) / source_rate_;
-        int out_frames = static_cast<int>(frames * ratio) + 2;
-        std::vector<float> resampled(static_cast<size_t>(out_frames * device_channels_));
-
-        int produced = 0;
-        for (int i = 0; i < out_frames; i++) {
-            double src_pos = resample_pos_ + i / ratio;
-            int idx = static_cast<int>(src_pos);
-            if (idx + 1 >= frames) break;
+        mono_.resize(rs_.max_output(static_cast<size_t>(frames)));
+        int produced = static_cast<int>(rs_.process(buffer, static_cast<size_t>(frames), mono_.data()));
 
-            float frac = static_cast<float>(src_pos - idx);
-            float sample = buffer[idx] + frac * (buffer[idx + 1] - buffer[idx]);
-
-            /* Duplicate mono to all device channels */
-            for (int ch = 0; ch < device_channels_; ch++) {
-                if (device_is_float_) {
-                    resampled[static_cast<size_t>(produced * device_channels_ + ch)] = sample;
-                } else {
-                    /* For int16 devices, still write as float — WASAPI shared mode
-                       mix format is almost always float32 */
-                    resampled[static_cast<size_t>(produced * device_channels_ + ch)] = sample;
-                }
-            }
-            produced++;
-        }
-
-        /* Update fractional position for continuity */
-        resample_pos_ = (resample_pos_ + static_cast<double>(frames)) -
-                         static_cast<int>(resample_pos_ + static_cast<double>(frames));
-        /* Actually, track how many source samples we consumed */
-        resample_pos_ = fmod(resample_pos_ + static_cast<double>(produced) / ratio -
-                              static_cast<double>(frames), 1.0);
-        if (resample_pos_ < 0.0) resample_pos_ += 1.0;
+        /* Duplicate mono to all device channels.  For int16 devices we still
+           write float — WASAPI shared mode mix format is almost always float32 */
+        resampled_.resize(static_cast<size_t>(produced * device_channels_));
+        for (int i = 0; i < produced; i++)
+            for (int ch = 0; ch < device_channels_; ch++)
+                resampled_[static_cast<size_t>(i * device_channels_ + ch)] = mono_[static_cast<size_t>(i)];
 
         /* Write resampled data to WASAPI buffer */
         int written = 0;
@@ -442,7 +397,7 @@ public:
             if (FAILED(hr)) return -1;
 
             std::memcpy(data,
-                        &resampled[static_cast<size_t>(written * device_channels_)],
+                        &resampled_[static_cast<size_t>(written * device_channels_)],
                         static_cast<size_t>(to_write) * device_channels_ * sizeof(float));
 
             render_->ReleaseBuffer(to_write, 0);
@@ -458,6 +413,7 @@ public:
             client_->Reset();
             client_->Start();
         }
+        rs_.clear();
     }
 
     void close() override {
@@ -465,7 +421,6 @@ public:
         if (render_)  { render_->Release();  render_  = nullptr; }
         if (client_)  { client_->Release();  client_  = nullptr; }
         buffer_frames_ = 0;
-        resample_pos_  = 0.0;
     }
 
 private:
@@ -477,9 +432,12 @@ private:
     int  device_channels_ = 0;
     bool device_is_float_ = false;
 
-    int    source_rate_     = 0;
-    int    source_channels_ = 0;
-    double resample_pos_    = 0.0;
+    int source_rate_     = 0;
+    int source_channels_ = 0;
+
+    Resampler          rs_;                // source rate -> device rate
+    std::vector<float> mono_;
+    std::vector<float> resampled_;         // interleaved device frames
 };
 
 /* ── Device enumeration ────────────────────────────────────────────── */
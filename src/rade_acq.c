@@ -34,123 +34,482 @@
 */
 
 #include "rade_acq.h"
-#include <string.h>
+#include "rade_nco.h"
+#include "rade_vec.h"
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
 /*---------------------------------------------------------------------------*\
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-void rade_acq_init(rade_acq *acq, const rade_ofdm *ofdm, float frange, float fstep) {
-    memset(acq, 0, sizeof(rade_acq));
+void rade_acq_tables_init(rade_acq_tables *tab, const rade_ofdm *ofdm, float frange, float fstep) {
+    memset(tab, 0, sizeof(rade_acq_tables));
 
-    acq->fs = RADE_FS;
-    acq->m = RADE_M;
-    acq->ncp = RADE_NCP;
-    acq->nmf = RADE_NMF;
+    tab->fs = RADE_FS;
+    tab->m = RADE_M;
+    tab->ncp = RADE_NCP;
+    tab->nmf = RADE_NMF;
 
-    acq->Pacq_error1 = RADE_ACQ_PACQ_ERR1;
-    acq->Pacq_error2 = RADE_ACQ_PACQ_ERR2;
+    tab->Pacq_error1 = RADE_ACQ_PACQ_ERR1;
+    tab->Pacq_error1_search = RADE_ACQ_PACQ_ERR1;
+    tab->Pacq_error2 = RADE_ACQ_PACQ_ERR2;
 
     /* Copy pilot symbols from OFDM */
-    memcpy(acq->p, ofdm->p, sizeof(RADE_COMP) * RADE_M);
-    memcpy(acq->pend, ofdm->pend, sizeof(RADE_COMP) * RADE_M);
+    memcpy(tab->p, ofdm->p, sizeof(RADE_COMP) * RADE_M);
+    memcpy(tab->pend, ofdm->pend, sizeof(RADE_COMP) * RADE_M);
 
     /* Calculate pilot power */
     RADE_COMP p_dot = rade_cdot(ofdm->p, ofdm->p, RADE_M);
-    acq->sigma_p = sqrtf(p_dot.real);
+    tab->sigma_p = sqrtf(p_dot.real);
 
     /* Set up frequency search range */
-    acq->n_fcoarse = 0;
-    for (float f = -frange / 2.0f; f < frange / 2.0f && acq->n_fcoarse < RADE_ACQ_NFREQ; f += fstep) {
-        acq->fcoarse_range[acq->n_fcoarse++] = f;
+    tab->n_fcoarse = 0;
+    tab->fstep = fstep;
+    for (float f = -frange / 2.0f; f < frange / 2.0f && tab->n_fcoarse < RADE_ACQ_NFREQ; f += fstep) {
+        tab->fcoarse_range[tab->n_fcoarse++] = f;
+    }
+
+    /* A wider search has proportionally more independent noise points to
+       exceed the threshold, so keep its false alarms per call. The rows are
+       closer than the correlation's resolution, so scale by the range. The
+       EOO check tests a single point and keeps Pacq_error1 */
+    if (frange > RADE_ACQ_PACQ_FRANGE) {
+        tab->Pacq_error1_search *= RADE_ACQ_PACQ_FRANGE / frange;
     }
 
-    /* Pre-compute frequency-shifted pilots: p_w[n][f_idx] = p[n] * exp(j*w*n)
-       where w = 2*pi*f/Fs */
-    for (int f_idx = 0; f_idx < acq->n_fcoarse; f_idx++) {
-        float f = acq->fcoarse_range[f_idx];
-        float w = 2.0f * M_PI * f / acq->fs;
+    /* Pre-compute frequency-shifted pilots: p_w[f_idx][n] = p[n] * exp(j*w*n)
+       where w = 2*pi*f/Fs, stored split so correlations are unit stride */
+    for (int f_idx = 0; f_idx < tab->n_fcoarse; f_idx++) {
+        float f = tab->fcoarse_range[f_idx];
+        float w = 2.0f * M_PI * f / tab->fs;
 
         for (int n = 0; n < RADE_M; n++) {
             RADE_COMP w_vec = rade_cexp(w * n);
-            acq->p_w[n][f_idx] = rade_cmul(w_vec, acq->p[n]);
+            RADE_COMP p_w = rade_cmul(w_vec, tab->p[n]);
+            tab->p_w_re[f_idx][n] = p_w.real;
+            tab->p_w_im[f_idx][n] = p_w.imag;
+        }
+    }
+
+    /* FFT engine set up. Each pilot position is correlated separately over
+       Nmf timing offsets, which must not wrap around the circular
+       convolution. Search frequencies are tracked in half bins. */
+    int N = RADE_ACQ_NFFT;
+    assert(N >= tab->nmf + tab->m - 1);
+
+    tab->use_fft = 1;
+    for (int f_idx = 0; f_idx < tab->n_fcoarse; f_idx++) {
+        float s = 2.0f * tab->fcoarse_range[f_idx] * N / tab->fs;
+        int s_int = (int)roundf(s);
+        if (fabsf(s - s_int) > 1E-3f) {
+            tab->use_fft = 0;
+        }
+        s_int = ((s_int % (2 * N)) + 2 * N) % (2 * N);
+        tab->fbin[f_idx] = s_int >> 1;
+        tab->fhalf[f_idx] = s_int & 1;
+    }
+
+    if (tab->use_fft) {
+        RADE_COMP p_h[RADE_ACQ_NFFT], P_h[RADE_ACQ_NFFT];
+
+        rade_fft_init(&tab->fft, tab->fft_twiddles, N);
+
+        /* G[h][k] = P_h[-k]/N, where P_0 = FFT(p) and P_1 is the FFT of p
+           shifted up by half a bin */
+        for (int h = 0; h < 2; h++) {
+            memset(p_h, 0, sizeof(p_h));
+            for (int n = 0; n < RADE_M; n++) {
+                p_h[n] = rade_cmul(tab->p[n], rade_cexp(h * M_PI * n / N));
+            }
+            rade_fft_forward(&tab->fft, P_h, p_h);
+            for (int k = 0; k < N; k++) {
+                tab->G[h][k] = rade_cscale(P_h[(N - k) % N], 1.0f / N);
+            }
+        }
+
+        /* Coarse grid, each coarse frequency in the middle of the fdec
+           search frequencies it stands for. Coarse frequencies stay about
+           RADE_ACQ_FDEC*RADE_ACQ_FSTEP apart whatever the step, further and
+           the correlation peak can fall between them */
+        assert(N % RADE_ACQ_TDEC == 0 && tab->nmf % RADE_ACQ_TDEC == 0);
+        rade_fft_init(&tab->fft_c, tab->fft_c_twiddles, N / RADE_ACQ_TDEC);
+        tab->fdec = (int)roundf(RADE_ACQ_FDEC * RADE_ACQ_FSTEP / fstep);
+        if (tab->fdec < 1) tab->fdec = 1;
+        for (int f_idx = tab->fdec / 2; f_idx < tab->n_fcoarse; f_idx += tab->fdec) {
+            tab->fc_idx[tab->n_fc++] = f_idx;
         }
     }
 }
 
+int rade_acq_init(rade_acq *acq, const rade_acq_tables *tab) {
+    memset(acq, 0, sizeof(rade_acq));
+    acq->tab = tab;
+    acq->seed = RADE_ACQ_SEED;
+
+    /* The coarse grid has fewer rows, so fits in the same space */
+    acq->grid = (float (*)[RADE_NMF])calloc(1, rade_acq_grid_size(tab));
+    if (acq->grid == NULL) {
+        return -1;
+    }
+    acq->Dt1 = acq->grid;
+    acq->Dt2 = acq->grid + tab->n_fcoarse;
+
+    return 0;
+}
+
+void rade_acq_close(rade_acq *acq) {
+    free(acq->grid);
+    acq->grid = acq->Dt1 = acq->Dt2 = NULL;
+}
+
+size_t rade_acq_grid_size(const rade_acq_tables *tab) {
+    return 2 * (size_t)tab->n_fcoarse * sizeof(float[RADE_NMF]);
+}
+
+void rade_acq_reset(rade_acq *acq) {
+    acq->Dt2_reusable = 0;
+}
+
+void rade_acq_set_pool(rade_acq *acq, rade_pool *pool) {
+    acq->pool = pool;
+}
+
+void rade_acq_set_coarse(rade_acq *acq, int coarse) {
+    /* The grids change shape, so nothing carries over */
+    acq->coarse = coarse && acq->tab->use_fft;
+    acq->Dt2_reusable = 0;
+}
+
 /*---------------------------------------------------------------------------*\
-                           PILOT DETECTION
+                         CORRELATION GRID
 \*---------------------------------------------------------------------------*/
 
-int rade_acq_detect_pilots(rade_acq *acq, const RADE_COMP *rx, int *tmax, float *fmax) {
-    int M = acq->m;
-    int Nmf = acq->nmf;
-    int n_fcoarse = acq->n_fcoarse;
+/* Arguments for one correlation grid job, tasks split the frequency bins */
+typedef struct {
+    rade_acq *acq;
+    const RADE_COMP *rx;
+    const RADE_COMP *Y;                     /* Spectrum of conj(rx), FFT grid only */
+    float (*Dt)[RADE_NMF];
+} acq_grid_job;
+
+static void acq_task_bins(const rade_acq_tables *tab, int task, int *f_start, int *f_end) {
+    *f_start = task * tab->n_fcoarse / RADE_ACQ_NTASK;
+    *f_end = (task + 1) * tab->n_fcoarse / RADE_ACQ_NTASK;
+}
 
-    /* We need buffer of 2*Nmf + M + Ncp samples */
-    /* Search over one modem frame for maxima */
+/* Direct evaluation of a correlation magnitude grid, used when the frequency
+   grid does not line up with the FFT bins. conj(rx) has already been split
+   into y_re/y_im by the caller. */
+static void acq_correlate_direct_task(void *arg, int task) {
+    acq_grid_job *job = (acq_grid_job *)arg;
+    rade_acq *acq = job->acq;
+    const rade_acq_tables *tab = acq->tab;
+    int M = tab->m;
+    int Nmf = tab->nmf;
+    int f_start, f_end;
+
+    acq_task_bins(tab, task, &f_start, &f_end);
+    for (int f_idx = f_start; f_idx < f_end; f_idx++) {
+        double sum = 0.0;
+
+        for (int t = 0; t < Nmf; t++) {
+            /* Correlate with frequency-shifted pilot at time t
+               Note: Python uses np.conj(rx) first, then matmul
+               So Dt[t] = conj(rx[t:t+M]) . p_w[f_idx] */
+            RADE_COMP Dt_c = rade_vec_cdot(&acq->y_re[t], &acq->y_im[t],
+                                           tab->p_w_re[f_idx], tab->p_w_im[f_idx], M);
 
-    float Dtmax12 = 0.0f;
-    int f_ind_max = 0;
-    int t_max = 0;
-    float f_max = 0.0f;
+            job->Dt[f_idx][t] = rade_cabs(Dt_c);
+            sum += job->Dt[f_idx][t];
+        }
+
+        acq->fsum[f_idx] = sum;
+    }
+}
 
-    /* Clear correlation grids */
-    memset(acq->Dt1, 0, sizeof(acq->Dt1));
-    memset(acq->Dt2, 0, sizeof(acq->Dt2));
+/* Correlation magnitude grid via FFTs. With y = conj(rx), and s the shift of
+   the search frequency in bins (possibly half a bin):
+
+     D[t] = sum_n y[t+n] p[n] exp(j*2*pi*s*n/N) = IDFT(Y[k] P[-(k+s)])[t] / N
+
+   so each frequency costs one product and one inverse FFT. Y is computed by
+   the caller before the tasks start. The product and correlation scratch
+   live on the stack of the thread running the task. */
+static void acq_correlate_fft_task(void *arg, int task) {
+    acq_grid_job *job = (acq_grid_job *)arg;
+    rade_acq *acq = job->acq;
+    const rade_acq_tables *tab = acq->tab;
+    const RADE_COMP *Y = job->Y;
+    int Nmf = tab->nmf;
+    int N = RADE_ACQ_NFFT;
+    RADE_COMP Z[RADE_ACQ_NFFT];
+    RADE_COMP D[RADE_ACQ_NFFT];
+    int f_start, f_end;
+
+    acq_task_bins(tab, task, &f_start, &f_end);
+    for (int f_idx = f_start; f_idx < f_end; f_idx++) {
+        int s = tab->fbin[f_idx];
+        const RADE_COMP *G = tab->G[tab->fhalf[f_idx]];
+        double sum = 0.0;
+
+        /* k + s wraps once, so split the product rather than take a modulo */
+        rade_vec_cmul(Z, Y, &G[s], N - s);
+        rade_vec_cmul(&Z[N - s], &Y[N - s], G, s);
+        rade_fft_inverse(&tab->fft, D, Z);
+
+        float *Dt = job->Dt[f_idx];
+        rade_vec_cabs(Dt, D, Nmf);
+        for (int t = 0; t < Nmf; t++) {
+            sum += Dt[t];
+        }
 
-    /* Search over time and frequency */
-    for (int t = 0; t < Nmf; t++) {
-        for (int f_idx = 0; f_idx < n_fcoarse; f_idx++) {
-            /* Correlate with frequency-shifted pilot at time t
-               Dt1 = sum(conj(rx[t:t+M]) * p_w[:][f_idx]) */
-            RADE_COMP Dt1 = rade_czero();
-            RADE_COMP Dt2 = rade_czero();
-
-            for (int n = 0; n < M; n++) {
-                /* Note: Python uses np.conj(rx) first, then matmul
-                   So Dt1[t] = conj(rx[t:t+M]) . p_w */
-                Dt1 = rade_cadd(Dt1, rade_cmul(rade_cconj(rx[t + n]), acq->p_w[n][f_idx]));
-                Dt2 = rade_cadd(Dt2, rade_cmul(rade_cconj(rx[t + Nmf + n]), acq->p_w[n][f_idx]));
+        acq->fsum[f_idx] = sum;
+    }
+}
+
+/* Coarse grid via FFTs: the product as for the full grid, folded to
+   N/RADE_ACQ_TDEC bins, whose inverse FFT is D[t*RADE_ACQ_TDEC] */
+static void acq_correlate_coarse_task(void *arg, int task) {
+    acq_grid_job *job = (acq_grid_job *)arg;
+    rade_acq *acq = job->acq;
+    const rade_acq_tables *tab = acq->tab;
+    const RADE_COMP *Y = job->Y;
+    int N = RADE_ACQ_NFFT;
+    int Nc = RADE_ACQ_NFFT / RADE_ACQ_TDEC;
+    int Ntc = tab->nmf / RADE_ACQ_TDEC;
+    RADE_COMP Z[RADE_ACQ_NFFT];
+    RADE_COMP Zc[RADE_ACQ_NFFT / RADE_ACQ_TDEC];
+    RADE_COMP D[RADE_ACQ_NFFT / RADE_ACQ_TDEC];
+    int r_start = task * tab->n_fc / RADE_ACQ_NTASK;
+    int r_end = (task + 1) * tab->n_fc / RADE_ACQ_NTASK;
+
+    for (int r = r_start; r < r_end; r++) {
+        int f_idx = tab->fc_idx[r];
+        int s = tab->fbin[f_idx];
+        const RADE_COMP *G = tab->G[tab->fhalf[f_idx]];
+        double sum = 0.0;
+
+        rade_vec_cmul(Z, Y, &G[s], N - s);
+        rade_vec_cmul(&Z[N - s], &Y[N - s], G, s);
+        memcpy(Zc, Z, sizeof(Zc));
+        for (int m = 1; m < RADE_ACQ_TDEC; m++) {
+            for (int k = 0; k < Nc; k++) {
+                Zc[k] = rade_cadd(Zc[k], Z[m * Nc + k]);
             }
+        }
+        rade_fft_inverse(&tab->fft_c, D, Zc);
+
+        float *Dt = job->Dt[r];
+        rade_vec_cabs(Dt, D, Ntc);
+        for (int t = 0; t < Ntc; t++) {
+            sum += Dt[t];
+        }
+
+        acq->fsum[r] = sum;
+    }
+}
+
+/* Fill one correlation magnitude grid, returns the sum of the grid. Per bin
+   sums are combined in bin order so the result does not depend on how the
+   tasks were scheduled. */
+static double acq_correlate(rade_acq *acq, const RADE_COMP *rx, float (*Dt)[RADE_NMF]) {
+    const rade_acq_tables *tab = acq->tab;
+    RADE_COMP Y[RADE_ACQ_NFFT];
+    acq_grid_job job = {acq, rx, Y, Dt};
+
+    if (tab->use_fft) {
+        int N = RADE_ACQ_NFFT;
+        int nrx = tab->nmf + tab->m - 1;
+        RADE_COMP y[RADE_ACQ_NFFT];
+
+        for (int n = 0; n < nrx; n++) {
+            y[n] = rade_cconj(rx[n]);
+        }
+        memset(&y[nrx], 0, sizeof(RADE_COMP) * (N - nrx));
+        rade_fft_forward(&tab->fft, Y, y);
+
+        rade_pool_run(acq->pool, acq->coarse ? acq_correlate_coarse_task : acq_correlate_fft_task,
+                      &job, RADE_ACQ_NTASK);
+    } else {
+        rade_vec_split_conj(acq->y_re, acq->y_im, rx, tab->nmf + tab->m - 1);
+        rade_pool_run(acq->pool, acq_correlate_direct_task, &job, RADE_ACQ_NTASK);
+    }
+
+    double sum = 0.0;
+    int n_rows = acq->coarse ? tab->n_fc : tab->n_fcoarse;
+    for (int f_idx = 0; f_idx < n_rows; f_idx++) {
+        sum += acq->fsum[f_idx];
+    }
 
-            acq->Dt1[t][f_idx] = Dt1;
-            acq->Dt2[t][f_idx] = Dt2;
+    return sum;
+}
 
-            /* Combined metric: |Dt1| + |Dt2| */
-            float Dt12 = rade_cabs(Dt1) + rade_cabs(Dt2);
+/* Noise estimate from the running sums of both grids
+   Ref: radae.pdf "Pilot Detection over Multiple Frames" */
+static float acq_sigma_r(const rade_acq *acq) {
+    const rade_acq_tables *tab = acq->tab;
+    int count = acq->coarse ? tab->nmf / RADE_ACQ_TDEC * tab->n_fc : tab->nmf * tab->n_fcoarse;
+    float sigma_r1 = (float)(acq->sum_Dt1 / count) / sqrtf(M_PI / 2.0f);
+    float sigma_r2 = (float)(acq->sum_Dt2 / count) / sqrtf(M_PI / 2.0f);
+    return (sigma_r1 + sigma_r2) / 2.0f;
+}
 
-            if (Dt12 > Dtmax12) {
-                Dtmax12 = Dt12;
-                f_ind_max = f_idx;
-                f_max = acq->fcoarse_range[f_idx];
-                t_max = t;
+/* xorshift32, a private generator per receiver in place of rand() */
+static int acq_rand(uint32_t *seed) {
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return (int)(x >> 1);
+}
+
+/*---------------------------------------------------------------------------*\
+                           PILOT DETECTION
+\*---------------------------------------------------------------------------*/
+
+/* |Dt1| + |Dt2| at one point of the full resolution grid, conj(rx) has
+   been split into y_re/y_im */
+static float acq_dt12(const rade_acq *acq, int t, int f_idx) {
+    const rade_acq_tables *tab = acq->tab;
+    const float *p_re = tab->p_w_re[f_idx];
+    const float *p_im = tab->p_w_im[f_idx];
+    RADE_COMP Dt1 = rade_vec_cdot(&acq->y_re[t], &acq->y_im[t], p_re, p_im, tab->m);
+    RADE_COMP Dt2 = rade_vec_cdot(&acq->y_re[t + tab->nmf], &acq->y_im[t + tab->nmf], p_re, p_im, tab->m);
+    return rade_cabs(Dt1) + rade_cabs(Dt2);
+}
+
+/* Second stage of the hierarchical search: the RADE_ACQ_NCAND largest
+   coarse peaks, each searched at full resolution over the timing offsets
+   and then the frequencies nearer it than any other coarse point. The
+   correlation peak is several samples and tens of Hz wide, so the true
+   peak sits among the largest coarse points however it falls on the grid */
+static float acq_search_coarse(rade_acq *acq, const RADE_COMP *rx, int *t_out, int *f_out) {
+    const rade_acq_tables *tab = acq->tab;
+    int Nmf = tab->nmf;
+    int Ntc = Nmf / RADE_ACQ_TDEC;
+
+    /* Largest first, a later equal point goes after the earlier ones */
+    float cand_D[RADE_ACQ_NCAND];
+    int cand_r[RADE_ACQ_NCAND], cand_t[RADE_ACQ_NCAND];
+    int n_cand = 0;
+    for (int r = 0; r < tab->n_fc; r++) {
+        for (int t = 0; t < Ntc; t++) {
+            float Dt12 = acq->Dt1[r][t] + acq->Dt2[r][t];
+            if (n_cand == RADE_ACQ_NCAND && Dt12 <= cand_D[n_cand - 1]) continue;
+
+            int i = (n_cand < RADE_ACQ_NCAND) ? n_cand++ : n_cand - 1;
+            for (; i > 0 && cand_D[i - 1] < Dt12; i--) {
+                cand_D[i] = cand_D[i - 1];
+                cand_r[i] = cand_r[i - 1];
+                cand_t[i] = cand_t[i - 1];
             }
+            cand_D[i] = Dt12;
+            cand_r[i] = r;
+            cand_t[i] = t;
         }
     }
 
-    /* Calculate threshold based on noise statistics
-       Ref: radae.pdf "Pilot Detection over Multiple Frames" */
-    float sum_abs_Dt1 = 0.0f;
-    float sum_abs_Dt2 = 0.0f;
-    int count = 0;
+    rade_vec_split_conj(acq->y_re, acq->y_im, rx, RADE_ACQ_NRX);
 
-    for (int t = 0; t < Nmf; t++) {
-        for (int f_idx = 0; f_idx < n_fcoarse; f_idx++) {
-            sum_abs_Dt1 += rade_cabs(acq->Dt1[t][f_idx]);
-            sum_abs_Dt2 += rade_cabs(acq->Dt2[t][f_idx]);
-            count++;
+    float Dtmax12 = 0.0f;
+    int t_max = 0, f_max = 0;
+    for (int c = 0; c < n_cand; c++) {
+        int t0 = cand_t[c] * RADE_ACQ_TDEC;
+        int f0 = tab->fc_idx[cand_r[c]];
+        float Dt_best = 0.0f;
+        int t_best = t0, f_best = f0;
+
+        int t_start = (t0 - RADE_ACQ_TDEC / 2 > 0) ? t0 - RADE_ACQ_TDEC / 2 : 0;
+        int t_end = (t0 + RADE_ACQ_TDEC / 2 < Nmf - 1) ? t0 + RADE_ACQ_TDEC / 2 : Nmf - 1;
+        for (int t = t_start; t <= t_end; t++) {
+            float Dt12 = acq_dt12(acq, t, f0);
+            if (Dt12 > Dt_best) {
+                Dt_best = Dt12;
+                t_best = t;
+            }
+        }
+
+        int f_start = (f0 - tab->fdec / 2 > 0) ? f0 - tab->fdec / 2 : 0;
+        int f_end = (f0 + tab->fdec / 2 < tab->n_fcoarse - 1) ? f0 + tab->fdec / 2 : tab->n_fcoarse - 1;
+        for (int f_idx = f_start; f_idx <= f_end; f_idx++) {
+            if (f_idx == f0) continue;
+            float Dt12 = acq_dt12(acq, t_best, f_idx);
+            if (Dt12 > Dt_best) {
+                Dt_best = Dt12;
+                f_best = f_idx;
+            }
+        }
+
+        /* Ties as for the full search, earliest time then lowest frequency */
+        if (Dt_best > Dtmax12 ||
+            (Dt_best == Dtmax12 && (t_best < t_max || (t_best == t_max && f_best < f_max)))) {
+            Dtmax12 = Dt_best;
+            t_max = t_best;
+            f_max = f_best;
         }
     }
 
-    float sigma_r1 = (sum_abs_Dt1 / count) / sqrtf(M_PI / 2.0f);
-    float sigma_r2 = (sum_abs_Dt2 / count) / sqrtf(M_PI / 2.0f);
-    float sigma_r = (sigma_r1 + sigma_r2) / 2.0f;
+    *t_out = t_max;
+    *f_out = f_max;
+    return Dtmax12;
+}
+
+int rade_acq_detect_pilots(rade_acq *acq, const RADE_COMP *rx, int *tmax, float *fmax) {
+    const rade_acq_tables *tab = acq->tab;
+    int Nmf = tab->nmf;
+    int n_fcoarse = tab->n_fcoarse;
+
+    /* We need buffer of 2*Nmf + M + Ncp samples */
+    /* Search over one modem frame for maxima */
+
+    float Dtmax12 = 0.0f;
+    int f_ind_max = 0;
+    int t_max = 0;
+    float f_max = 0.0f;
+
+    /* rx has advanced by Nmf since the last call, so the second pilot grid
+       from last time is this call's first pilot grid, and the old first
+       pilot grid is overwritten */
+    if (acq->Dt2_reusable) {
+        float (*Dt1)[RADE_NMF] = acq->Dt1;
+        acq->Dt1 = acq->Dt2;
+        acq->Dt2 = Dt1;
+        acq->sum_Dt1 = acq->sum_Dt2;
+    } else {
+        acq->sum_Dt1 = acq_correlate(acq, rx, acq->Dt1);
+    }
+    acq->sum_Dt2 = acq_correlate(acq, &rx[Nmf], acq->Dt2);
+    acq->Dt2_reusable = 1;
+
+    /* Search over time and frequency, walking each frequency row. Ties go to
+       the earliest time, then the lowest frequency, as for a time major scan */
+    if (acq->coarse) {
+        Dtmax12 = acq_search_coarse(acq, rx, &t_max, &f_ind_max);
+        f_max = tab->fcoarse_range[f_ind_max];
+    } else {
+        for (int f_idx = 0; f_idx < n_fcoarse; f_idx++) {
+            const float *Dt1 = acq->Dt1[f_idx];
+            const float *Dt2 = acq->Dt2[f_idx];
+
+            for (int t = 0; t < Nmf; t++) {
+                /* Combined metric: |Dt1| + |Dt2| */
+                float Dt12 = Dt1[t] + Dt2[t];
+
+                if (Dt12 > Dtmax12 || (Dt12 == Dtmax12 && Dt12 > 0.0f && t < t_max)) {
+                    Dtmax12 = Dt12;
+                    f_ind_max = f_idx;
+                    f_max = tab->fcoarse_range[f_idx];
+                    t_max = t;
+                }
+            }
+        }
+    }
 
     /* Threshold for detection */
-    acq->Dthresh = 2.0f * sigma_r * sqrtf(-logf(acq->Pacq_error1 / 5.0f));
+    acq->Dthresh = 2.0f * acq_sigma_r(acq) * sqrtf(-logf(tab->Pacq_error1_search / 5.0f));
     acq->Dtmax12 = Dtmax12;
     acq->f_ind_max = f_ind_max;
 
@@ -160,42 +519,61 @@ int rade_acq_detect_pilots(rade_acq *acq, const RADE_COMP *rx, int *tmax, float
     return (Dtmax12 > acq->Dthresh) ? 1 : 0;
 }
 
-void rade_acq_refine(rade_acq *acq, const RADE_COMP *rx,
-                     int *tmax, float *fmax,
-                     int tfine_range_start, int tfine_range_end,
-                     float ffine_range_start, float ffine_range_end, float ffine_step) {
-    int M = acq->m;
-    int Nmf = acq->nmf;
+/* Arguments for one refine job, tasks split the frequency list */
+typedef struct {
+    const rade_acq *acq;
+    const float *f_list;
+    int nf;
+    int t_start;
+    int t_end;
+    float Dtmax[RADE_ACQ_NTASK];            /* Per task results */
+    int t_best[RADE_ACQ_NTASK];
+    float f_best[RADE_ACQ_NTASK];
+} acq_refine_job;
+
+/* rx from t_start has been split into y_re/y_im by the caller */
+static void acq_refine_task(void *arg, int task) {
+    acq_refine_job *job = (acq_refine_job *)arg;
+    const rade_acq *acq = job->acq;
+    const rade_acq_tables *tab = acq->tab;
+    const float *y_re = acq->y_re;
+    const float *y_im = acq->y_im;
+    int M = tab->m;
+    int Nmf = tab->nmf;
+    int i_start = task * job->nf / RADE_ACQ_NTASK;
+    int i_end = (task + 1) * job->nf / RADE_ACQ_NTASK;
 
     float Dtmax = 0.0f;
-    int t_best = *tmax;
-    float f_best = *fmax;
-
-    /* Fine search over time and frequency */
-    for (float f = ffine_range_start; f < ffine_range_end; f += ffine_step) {
-        float w = 2.0f * M_PI * f / acq->fs;
-
-        /* Pre-compute frequency shift vectors */
-        RADE_COMP w_vec1_p[RADE_M];
-        RADE_COMP w_vec2_p[RADE_M];
-
-        for (int n = 0; n < M; n++) {
-            RADE_COMP w_vec1 = rade_cexp(-w * n);
-            w_vec1_p[n] = rade_cmul(w_vec1, rade_cconj(acq->p[n]));
-
-            RADE_COMP w_vec2 = rade_cmul(w_vec1, rade_cexp(-w * Nmf));
-            w_vec2_p[n] = rade_cmul(w_vec2, rade_cconj(acq->p[n]));
-        }
-
-        for (int t = tfine_range_start; t < tfine_range_end; t++) {
+    int t_best = 0;
+    float f_best = 0.0f;
+
+    for (int i = i_start; i < i_end; i++) {
+        float f = job->f_list[i];
+        float w = 2.0f * M_PI * f / tab->fs;
+
+        /* Pre-compute frequency shift vectors, split real/imag:
+           exp(-j*w*n)*conj(p[n]) = conj(exp(j*w*n)*p[n]) from n = 0 and
+           from n = Nmf */
+        float w1_re[RADE_M], w1_im[RADE_M];
+        float w2_re[RADE_M], w2_im[RADE_M];
+        RADE_COMP q[RADE_M];
+        rade_nco nco;
+
+        rade_nco_init(&nco, w);
+        rade_nco_gen(&nco, q, M);
+        rade_vec_cmul(q, q, tab->p, M);
+        rade_vec_split_conj(w1_re, w1_im, q, M);
+
+        rade_nco_set_phase(&nco, (double)w * Nmf);
+        rade_nco_gen(&nco, q, M);
+        rade_vec_cmul(q, q, tab->p, M);
+        rade_vec_split_conj(w2_re, w2_im, q, M);
+
+        for (int t = job->t_start; t < job->t_end; t++) {
             /* Correlate at this time/freq */
-            RADE_COMP Dt1 = rade_czero();
-            RADE_COMP Dt2 = rade_czero();
-
-            for (int n = 0; n < M; n++) {
-                Dt1 = rade_cadd(Dt1, rade_cmul(rx[t + n], w_vec1_p[n]));
-                Dt2 = rade_cadd(Dt2, rade_cmul(rx[t + Nmf + n], w_vec2_p[n]));
-            }
+            int k = t - job->t_start;
+            RADE_COMP Dt1 = rade_vec_cdot(&y_re[k], &y_im[k], w1_re, w1_im, M);
+            RADE_COMP Dt2 = rade_vec_cdot(&y_re[k + Nmf], &y_im[k + Nmf], w2_re, w2_im, M);
 
             /* Combined metric: |Dt1 + Dt2| */
             RADE_COMP Dt_sum = rade_cadd(Dt1, Dt2);
@@ -209,90 +587,132 @@ void rade_acq_refine(rade_acq *acq, const RADE_COMP *rx,
         }
     }
 
-    *tmax = t_best;
-    *fmax = f_best;
+    job->Dtmax[task] = Dtmax;
+    job->t_best[task] = t_best;
+    job->f_best[task] = f_best;
 }
 
-int rade_acq_check_pilots(rade_acq *acq, const RADE_COMP *rx,
-                          int tmax, float fmax,
-                          int *valid, int *endofover) {
-    int M = acq->m;
-    int Ncp = acq->ncp;
-    int Nmf = acq->nmf;
-    float Fs = (float)acq->fs;
+void rade_acq_refine(rade_acq *acq, const RADE_COMP *rx,
+                     int *tmax, float *fmax,
+                     int tfine_range_start, int tfine_range_end,
+                     float ffine_range_start, float ffine_range_end, float ffine_step) {
+    /* Frequency list built by the same accumulation as a serial sweep */
+    float f_list[RADE_ACQ_NREFINE];
+    int nf = 0;
+    for (float f = ffine_range_start; f < ffine_range_end; f += ffine_step) {
+        assert(nf < RADE_ACQ_NREFINE);
+        f_list[nf++] = f;
+    }
 
-    /* Update 5% of the correlation grid for noise estimation */
-    int Nupdate = (int)(0.05f * Nmf);
-    for (int i = 0; i < Nupdate; i++) {
-        int t = rand() % Nmf;
+    /* Split the rx samples the search touches once, shared by all tasks */
+    int nrx = tfine_range_end - tfine_range_start + acq->tab->nmf + acq->tab->m - 1;
+    assert(tfine_range_start >= 0 && nrx <= RADE_ACQ_NRX);
+    rade_vec_split(acq->y_re, acq->y_im, &rx[tfine_range_start], nrx);
 
-        for (int f_idx = 0; f_idx < acq->n_fcoarse; f_idx++) {
-            RADE_COMP Dt1 = rade_czero();
-            RADE_COMP Dt2 = rade_czero();
+    acq_refine_job job;
+    job.acq = acq;
+    job.f_list = f_list;
+    job.nf = nf;
+    job.t_start = tfine_range_start;
+    job.t_end = tfine_range_end;
 
-            for (int n = 0; n < M; n++) {
-                Dt1 = rade_cadd(Dt1, rade_cmul(rade_cconj(rx[t + n]), acq->p_w[n][f_idx]));
-                Dt2 = rade_cadd(Dt2, rade_cmul(rade_cconj(rx[t + Nmf + n]), acq->p_w[n][f_idx]));
-            }
+    /* Fine search over time and frequency */
+    rade_pool_run(acq->pool, acq_refine_task, &job, RADE_ACQ_NTASK);
 
-            acq->Dt1[t][f_idx] = Dt1;
-            acq->Dt2[t][f_idx] = Dt2;
+    /* Tasks cover contiguous parts of the frequency list, so combining them
+       in order with a strict > picks the same point as a serial sweep */
+    float Dtmax = 0.0f;
+    int t_best = *tmax;
+    float f_best = *fmax;
+
+    for (int task = 0; task < RADE_ACQ_NTASK; task++) {
+        if (job.Dtmax[task] > Dtmax) {
+            Dtmax = job.Dtmax[task];
+            t_best = job.t_best[task];
+            f_best = job.f_best[task];
         }
     }
 
-    /* Recalculate noise statistics */
-    float sum_abs_Dt1 = 0.0f;
-    float sum_abs_Dt2 = 0.0f;
-    int count = 0;
+    *tmax = t_best;
+    *fmax = f_best;
+}
 
-    for (int t = 0; t < Nmf; t++) {
-        for (int f_idx = 0; f_idx < acq->n_fcoarse; f_idx++) {
-            sum_abs_Dt1 += rade_cabs(acq->Dt1[t][f_idx]);
-            sum_abs_Dt2 += rade_cabs(acq->Dt2[t][f_idx]);
-            count++;
+int rade_acq_check_pilots(rade_acq *acq, const RADE_COMP *rx,
+                          int tmax, float fmax,
+                          int *valid, int *endofover) {
+    const rade_acq_tables *tab = acq->tab;
+    int M = tab->m;
+    int Ncp = tab->ncp;
+    int Nmf = tab->nmf;
+    float Fs = (float)tab->fs;
+
+    /* Update 5% of the correlation grid for noise estimation, keeping the
+       running sums in step */
+    const float *y_re = acq->y_re;
+    const float *y_im = acq->y_im;
+    rade_vec_split_conj(acq->y_re, acq->y_im, rx, RADE_ACQ_NRX);
+
+    /* The coarse grid's points in the hierarchical search */
+    int n_rows = acq->coarse ? tab->n_fc : tab->n_fcoarse;
+    int t_step = acq->coarse ? RADE_ACQ_TDEC : 1;
+    int n_cols = Nmf / t_step;
+
+    int Nupdate = (int)(0.05f * n_cols);
+    for (int i = 0; i < Nupdate; i++) {
+        int col = acq_rand(&acq->seed) % n_cols;
+        int t = col * t_step;
+
+        for (int row = 0; row < n_rows; row++) {
+            int f_idx = acq->coarse ? tab->fc_idx[row] : row;
+            const float *p_re = tab->p_w_re[f_idx];
+            const float *p_im = tab->p_w_im[f_idx];
+            RADE_COMP Dt1 = rade_vec_cdot(&y_re[t], &y_im[t], p_re, p_im, M);
+            RADE_COMP Dt2 = rade_vec_cdot(&y_re[t + Nmf], &y_im[t + Nmf], p_re, p_im, M);
+
+            float abs_Dt1 = rade_cabs(Dt1);
+            float abs_Dt2 = rade_cabs(Dt2);
+            acq->sum_Dt1 += (double)abs_Dt1 - acq->Dt1[row][col];
+            acq->sum_Dt2 += (double)abs_Dt2 - acq->Dt2[row][col];
+            acq->Dt1[row][col] = abs_Dt1;
+            acq->Dt2[row][col] = abs_Dt2;
         }
     }
 
-    float sigma_r1 = (sum_abs_Dt1 / count) / sqrtf(M_PI / 2.0f);
-    float sigma_r2 = (sum_abs_Dt2 / count) / sqrtf(M_PI / 2.0f);
-    float sigma_r = (sigma_r1 + sigma_r2) / 2.0f;
+    /* Grid rows now come from different buffers */
+    acq->Dt2_reusable = 0;
 
-    acq->Dthresh = 2.0f * sigma_r * sqrtf(-logf(acq->Pacq_error2 / 5.0f));
-    float Dthresh_eoo = 2.0f * sigma_r * sqrtf(-logf(acq->Pacq_error1 / 5.0f));
+    /* Noise statistics */
+    float sigma_r = acq_sigma_r(acq);
 
-    /* Compute correlation at current timing/freq */
+    acq->Dthresh = 2.0f * sigma_r * sqrtf(-logf(tab->Pacq_error2 / 5.0f));
+    float Dthresh_eoo = 2.0f * sigma_r * sqrtf(-logf(tab->Pacq_error1 / 5.0f));
+
+    /* Compute correlation at current timing/freq. conj(rx * exp(-j*w*n)) * p
+       = conj(rx) * (p * exp(j*w*n)), so the shift is applied to the pilots */
     float w = 2.0f * M_PI * fmax / Fs;
-    RADE_COMP w_vec[RADE_M];
-    for (int n = 0; n < M; n++) {
-        w_vec[n] = rade_cexp(-w * n);
-    }
+    float q_re[RADE_M], q_im[RADE_M];
+    float qend_re[RADE_M], qend_im[RADE_M];
+    RADE_COMP w_vec[RADE_M], q[RADE_M];
+    rade_nco nco;
+
+    rade_nco_init(&nco, w);
+    rade_nco_gen(&nco, w_vec, M);
+    rade_vec_cmul(q, w_vec, tab->p, M);
+    rade_vec_split(q_re, q_im, q, M);
+    rade_vec_cmul(q, w_vec, tab->pend, M);
+    rade_vec_split(qend_re, qend_im, q, M);
 
     /* Correlate with normal pilots */
-    RADE_COMP Dt1 = rade_czero();
-    RADE_COMP Dt2 = rade_czero();
-    for (int n = 0; n < M; n++) {
-        RADE_COMP rx_shifted = rade_cmul(w_vec[n], rx[tmax + n]);
-        Dt1 = rade_cadd(Dt1, rade_cmul(rade_cconj(rx_shifted), acq->p[n]));
-
-        rx_shifted = rade_cmul(w_vec[n], rx[tmax + Nmf + n]);
-        Dt2 = rade_cadd(Dt2, rade_cmul(rade_cconj(rx_shifted), acq->p[n]));
-    }
+    RADE_COMP Dt1 = rade_vec_cdot(&y_re[tmax], &y_im[tmax], q_re, q_im, M);
+    RADE_COMP Dt2 = rade_vec_cdot(&y_re[tmax + Nmf], &y_im[tmax + Nmf], q_re, q_im, M);
 
     float Dtmax12 = rade_cabs(Dt1) + rade_cabs(Dt2);
     acq->Dtmax12 = Dtmax12;
 
-    /* Correlate with EOO pilots */
-    RADE_COMP Dt1_eoo = rade_czero();
-    RADE_COMP Dt2_eoo = rade_czero();
-    for (int n = 0; n < M; n++) {
-        /* EOO pilot at position M+Ncp after start */
-        RADE_COMP rx_shifted = rade_cmul(w_vec[n], rx[tmax + M + Ncp + n]);
-        Dt1_eoo = rade_cadd(Dt1_eoo, rade_cmul(rade_cconj(rx_shifted), acq->pend[n]));
-
-        /* EOO pilot at Nmf */
-        rx_shifted = rade_cmul(w_vec[n], rx[tmax + Nmf + n]);
-        Dt2_eoo = rade_cadd(Dt2_eoo, rade_cmul(rade_cconj(rx_shifted), acq->pend[n]));
-    }
+    /* Correlate with EOO pilots, at position M+Ncp after start and at Nmf */
+    int t_eoo = tmax + M + Ncp;
+    RADE_COMP Dt1_eoo = rade_vec_cdot(&y_re[t_eoo], &y_im[t_eoo], qend_re, qend_im, M);
+    RADE_COMP Dt2_eoo = rade_vec_cdot(&y_re[tmax + Nmf], &y_im[tmax + Nmf], qend_re, qend_im, M);
 
     float Dtmax12_eoo = rade_cabs(Dt1_eoo) + rade_cabs(Dt2_eoo);
     acq->Dtmax12_eoo = Dtmax12_eoo;
@@ -38,15 +38,25 @@
 
 #include "rade_dsp.h"
 #include "rade_ofdm.h"
+#include "rade_fft.h"
+#include "rade_pool.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define RADE_ACQ_NTASK          8       /* Tasks the search is split into */
+#define RADE_ACQ_NREFINE        256     /* Max frequencies in a refine sweep */
+#define RADE_ACQ_NRX            (2 * RADE_NMF + RADE_M + RADE_NCP)  /* rx samples per call */
+
 /*---------------------------------------------------------------------------*\
-                           ACQUISITION STATE
+                           ACQUISITION TABLES
 \*---------------------------------------------------------------------------*/
 
+/* Read only after rade_acq_tables_init(), one copy is shared by every
+   receiver using the same OFDM configuration */
 typedef struct {
     /* Configuration */
     int fs;                                     /* Sample rate */
@@ -57,9 +67,11 @@ typedef struct {
     /* Frequency search range */
     float fcoarse_range[RADE_ACQ_NFREQ];       /* Frequency offsets to search */
     int n_fcoarse;                              /* Number of frequency steps */
+    float fstep;                                /* Frequency step (Hz) */
 
-    /* Pre-computed frequency-shifted pilots: p_w[M][n_freq] */
-    RADE_COMP p_w[RADE_M][RADE_ACQ_NFREQ];
+    /* Pre-computed frequency-shifted pilots, split real/imag: p_w[n_freq][M] */
+    float p_w_re[RADE_ACQ_NFREQ][RADE_M];
+    float p_w_im[RADE_ACQ_NFREQ][RADE_M];
 
     /* Pilot power for normalization */
     float sigma_p;
@@ -68,9 +80,67 @@ typedef struct {
     RADE_COMP p[RADE_M];                        /* Time-domain pilot */
     RADE_COMP pend[RADE_M];                     /* EOO pilot */
 
-    /* Correlation grid (for threshold calculation) */
-    RADE_COMP Dt1[RADE_NMF][RADE_ACQ_NFREQ];   /* Correlation at first pilot */
-    RADE_COMP Dt2[RADE_NMF][RADE_ACQ_NFREQ];   /* Correlation at second pilot */
+    /* FFT correlation engine, used when every search frequency lies on a bin
+       of the RADE_ACQ_NFFT point FFT, otherwise the grid is computed directly */
+    int use_fft;
+    rade_fft fft;
+    RADE_COMP fft_twiddles[RADE_ACQ_NFFT];
+    RADE_COMP G[2][RADE_ACQ_NFFT];              /* Pilot spectra, reversed and scaled: P[-k]/N,
+                                                   [1] is offset by half a bin */
+    int fbin[RADE_ACQ_NFREQ];                   /* Bin shift (mod N) of each search frequency */
+    int fhalf[RADE_ACQ_NFREQ];                  /* 1 if search frequency has an extra half bin */
+
+    /* Coarse grid for the hierarchical search, every fdec-th search
+       frequency at every RADE_ACQ_TDEC-th timing offset. Needs the FFT
+       engine: the correlation spectrum folded to N/RADE_ACQ_TDEC bins
+       transforms to the correlation at the coarse offsets */
+    int fdec;                                   /* Search frequencies per coarse one */
+    int n_fc;                                   /* Coarse frequencies */
+    int fc_idx[RADE_ACQ_NFREQ];                 /* Their indices in fcoarse_range */
+    rade_fft fft_c;
+    RADE_COMP fft_c_twiddles[RADE_ACQ_NFFT / RADE_ACQ_TDEC];
+
+    /* Acquisition probabilities */
+    float Pacq_error1;
+    float Pacq_error1_search;                   /* Pacq_error1 over the whole search grid,
+                                                   lower for a wide range */
+    float Pacq_error2;
+
+} rade_acq_tables;
+
+/*---------------------------------------------------------------------------*\
+                           ACQUISITION STATE
+\*---------------------------------------------------------------------------*/
+
+typedef struct {
+    /* Shared tables (not owned) */
+    const rade_acq_tables *tab;
+
+    double fsum[RADE_ACQ_NFREQ];                /* Scratch: grid sum of each frequency */
+    float y_re[RADE_ACQ_NRX];                   /* Scratch: rx (or conj(rx)) split real/imag */
+    float y_im[RADE_ACQ_NRX];
+
+    /* Optional worker pool (not owned), NULL runs the search serially */
+    rade_pool *pool;
+
+    /* Hierarchical search (rade_acq_set_coarse()), the grids below are then
+       the coarse grid: row r is frequency fc_idx[r], column t offset
+       t*RADE_ACQ_TDEC */
+    int coarse;
+
+    /* Correlation magnitude grid (for threshold calculation), one row of
+       timing offsets per search frequency. Allocated for the tables' search
+       range, so a +/-50 Hz receiver doesn't carry a wide search's grids */
+    float (*Dt1)[RADE_NMF];                     /* |correlation| at first pilot */
+    float (*Dt2)[RADE_NMF];                     /* |correlation| at second pilot */
+    float (*grid)[RADE_NMF];                    /* Both grids, n_fcoarse rows each */
+    double sum_Dt1;                             /* Running sums of the grids */
+    double sum_Dt2;
+    int Dt2_reusable;                           /* Dt2 becomes next detect call's Dt1 */
+
+    /* Grid positions refreshed by rade_acq_check_pilots(), drawn from a per
+       receiver generator so receivers don't share hidden state */
+    uint32_t seed;
 
     /* Detection thresholds and results */
     float Dthresh;
@@ -78,21 +148,42 @@ typedef struct {
     float Dtmax12_eoo;
     int f_ind_max;
 
-    /* Acquisition probabilities */
-    float Pacq_error1;
-    float Pacq_error2;
-
 } rade_acq;
 
 /*---------------------------------------------------------------------------*\
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-/* Initialize acquisition state
+/* Compute the acquisition tables
    ofdm: pointer to OFDM state (for pilot symbols)
    frange: frequency search range in Hz (e.g., 100)
    fstep: frequency search step in Hz (e.g., 2.5) */
-void rade_acq_init(rade_acq *acq, const rade_ofdm *ofdm, float frange, float fstep);
+void rade_acq_tables_init(rade_acq_tables *tab, const rade_ofdm *ofdm, float frange, float fstep);
+
+/* Initialize acquisition state, tab must outlive acq
+   Returns 0 on success, -1 if the grids can't be allocated */
+int rade_acq_init(rade_acq *acq, const rade_acq_tables *tab);
+
+/* Free the grids allocated by rade_acq_init() */
+void rade_acq_close(rade_acq *acq);
+
+/* Bytes allocated for the grids, the bulk of a receiver's memory */
+size_t rade_acq_grid_size(const rade_acq_tables *tab);
+
+/* Discard correlation state carried between calls, must be called when the
+   rx buffer has not advanced by exactly Nmf since the last detect call */
+void rade_acq_reset(rade_acq *acq);
+
+/* Share the detect and refine searches across a worker pool (NULL for
+   serial). Results are identical either way. */
+void rade_acq_set_pool(rade_acq *acq, rade_pool *pool);
+
+/* Hierarchical pilot detection: search a coarse grid, every RADE_ACQ_TDEC
+   samples and about RADE_ACQ_FDEC*RADE_ACQ_FSTEP Hz, then the full resolution grid
+   around its RADE_ACQ_NCAND largest peaks. The threshold comes from the
+   coarse grid's noise statistics. Ignored unless the tables use the FFT
+   engine. */
+void rade_acq_set_coarse(rade_acq *acq, int coarse);
 
 /*---------------------------------------------------------------------------*\
                            PILOT DETECTION
@@ -102,7 +193,10 @@ void rade_acq_init(rade_acq *acq, const rade_ofdm *ofdm, float frange, float fst
    rx: received samples, length = 2*Nmf + M + Ncp
    tmax: output timing offset (samples from start of rx)
    fmax: output frequency offset (Hz)
-   Returns 1 if candidate detected, 0 otherwise */
+   Returns 1 if candidate detected, 0 otherwise
+
+   Consecutive calls assume rx has advanced by Nmf samples, and reuse the
+   second pilot grid from the previous call as the first pilot grid. */
 int rade_acq_detect_pilots(rade_acq *acq, const RADE_COMP *rx, int *tmax, float *fmax);
 
 /* Refine timing and frequency estimates
@@ -41,18 +41,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <pthread.h>
 
 #include "rade_api.h"
 #include "rade_rx.h"
+#include "rade_pool.h"
+#include "rade_arch.h"
+#include "rade_weights.h"
 
 /*---------------------------------------------------------------------------*\
                           RADE CONTEXT
 \*---------------------------------------------------------------------------*/
 
+/* Read only once opened, shared by reference between receivers */
+struct rade_context {
+    int flags;
+
+    /* Weight file mapping, NULL when using the built-in weights */
+    rade_weights *weights;
+
+    /* Tables and decoder layers */
+    rade_rx_tables tab;
+
+    /* Held by rade_context_open() and each receiver, under context_lock */
+    int refcount;
+};
+
+static pthread_mutex_t context_lock = PTHREAD_MUTEX_INITIALIZER;
+
 struct rade {
     int flags;
-    int auxdata;
-    int bottleneck;
+
+    /* Shared context, one reference held */
+    struct rade_context *ctx;
+
+    /* Latents waiting for the batched decoder in rade_rx_multi() */
+    float z_hat[RADE_NZMF * RADE_LATENT_DIM];
+    int decode_pending;
+
+    /* Unique word errors from rade_rx_decode_frame() not yet seen by the
+       demodulator, the two may run on different threads */
+    pthread_mutex_t uw_lock;
+    int uw_errors;
 
     /* Receiver state */
     rade_rx_state rx;
@@ -70,7 +100,81 @@ void rade_finalize(void) {
     /* No finalization needed without Python */
 }
 
-struct rade *rade_open(char model_file[], int flags) {
+static void rade_context_unref(struct rade_context *ctx) {
+    pthread_mutex_lock(&context_lock);
+    int last = (--ctx->refcount == 0);
+    pthread_mutex_unlock(&context_lock);
+
+    if (last) {
+        rade_weights_close(ctx->weights);
+        free(ctx);
+    }
+}
+
+struct rade_context *rade_context_open(char model_file[], int flags) {
+    struct rade_context *ctx = (struct rade_context *)malloc(sizeof(struct rade_context));
+    if (ctx == NULL) {
+        fprintf(stderr, "rade_open: failed to allocate memory\n");
+        return NULL;
+    }
+    memset(ctx, 0, sizeof(struct rade_context));
+
+    ctx->flags = flags;
+    ctx->refcount = 1;
+
+    /* Weight file from the caller or the environment, otherwise the
+       weights compiled in via rade_dec_data.c */
+    if (model_file == NULL || model_file[0] == '\0') {
+        model_file = getenv("RADE_WEIGHTS");
+    }
+    if (model_file != NULL && model_file[0] != '\0') {
+        ctx->weights = rade_weights_open(model_file);
+    }
+
+    /* Receiver tables, bottleneck 3 with auxdata */
+    const WeightArray *arrays = ctx->weights ? rade_weights_arrays(ctx->weights) : NULL;
+    int ret = rade_rx_tables_init(&ctx->tab, arrays, 3, 1, (flags & RADE_ACQ_WIDE) != 0);
+#ifndef USE_WEIGHTS_FILE
+    if (model_file != NULL && model_file[0] != '\0' && (ctx->weights == NULL || ret != 0)) {
+        fprintf(stderr, "rade_open: can't use %s, using built-in weights\n", model_file);
+        rade_weights_close(ctx->weights);
+        ctx->weights = NULL;
+        ret = rade_rx_tables_init(&ctx->tab, NULL, 3, 1, (flags & RADE_ACQ_WIDE) != 0);
+    }
+#else
+    if (model_file == NULL || model_file[0] == '\0') {
+        fprintf(stderr, "rade_open: no weight file, pass model_file or set RADE_WEIGHTS\n");
+    }
+#endif
+    if (ret != 0) {
+        fprintf(stderr, "rade_open: failed to initialize receiver\n");
+        rade_weights_close(ctx->weights);
+        free(ctx);
+        return NULL;
+    }
+
+    /* Quantized decoder, a weight file without float weights is int8 anyway */
+    if (flags & RADE_INT8) {
+        rade_select_int8_weights(&ctx->tab.dec_model);
+    }
+
+    /* Equalizer de-rotates by unit phasors rather than atan2 then sincos */
+    if (flags & RADE_FAST_MATH) {
+        ctx->tab.ofdm.fast_math = 1;
+    }
+
+    return ctx;
+}
+
+void rade_context_close(struct rade_context *ctx) {
+    if (ctx != NULL) {
+        rade_context_unref(ctx);
+    }
+}
+
+struct rade *rade_open_context(struct rade_context *ctx, int flags) {
+    assert(ctx != NULL);
+
     struct rade *r = (struct rade *)malloc(sizeof(struct rade));
     if (r == NULL) {
         fprintf(stderr, "rade_open: failed to allocate memory\n");
@@ -79,15 +183,16 @@ struct rade *rade_open(char model_file[], int flags) {
     memset(r, 0, sizeof(struct rade));
 
     r->flags = flags;
-    r->auxdata = 1;
-    r->bottleneck = 3;
 
-    (void)model_file;  /* weights are compiled in via rade_dec_data.c */
+    pthread_mutex_lock(&context_lock);
+    ctx->refcount++;
+    pthread_mutex_unlock(&context_lock);
+    r->ctx = ctx;
 
-    /* Initialize receiver */
-    if (rade_rx_init(&r->rx, NULL, r->bottleneck, r->auxdata, 1) != 0) {
-        fprintf(stderr, "rade_open: failed to initialize receiver\n");
-        free(r);
+    pthread_mutex_init(&r->uw_lock, NULL);
+    if (rade_rx_init(&r->rx, &ctx->tab, 1) != 0) {
+        fprintf(stderr, "rade_open: failed to allocate memory\n");
+        rade_close(r);
         return NULL;
     }
 
@@ -96,11 +201,32 @@ struct rade *rade_open(char model_file[], int flags) {
         r->rx.verbose = 0;
     }
 
+    /* Pilot search on a decimated grid, then full resolution at its peaks.
+       A context opened with the flag gives it to all its receivers */
+    if ((flags | ctx->flags) & RADE_ACQ_COARSE) {
+        rade_acq_set_coarse(&r->rx.acq, 1);
+    }
+
+    return r;
+}
+
+struct rade *rade_open(char model_file[], int flags) {
+    struct rade_context *ctx = rade_context_open(model_file, flags);
+    if (ctx == NULL) {
+        return NULL;
+    }
+
+    /* The receiver holds the only reference once ours is dropped */
+    struct rade *r = rade_open_context(ctx, flags);
+    rade_context_close(ctx);
     return r;
 }
 
 void rade_close(struct rade *r) {
     if (r != NULL) {
+        rade_rx_close(&r->rx);
+        pthread_mutex_destroy(&r->uw_lock);
+        rade_context_unref(r->ctx);
         free(r);
     }
 }
@@ -137,13 +263,8 @@ int rade_n_eoo_bits(struct rade *r) {
                         RECEPTION
 \*---------------------------------------------------------------------------*/
 
-int rade_rx(struct rade *r, float features_out[], int *has_eoo_out, float eoo_out[], RADE_COMP rx_in[]) {
-    assert(r != NULL);
-    assert(features_out != NULL);
-    assert(rx_in != NULL);
-
-    int ret = rade_rx_process(&r->rx, features_out, eoo_out, rx_in);
-
+/* rade_rx() and rade_rx_real() outputs from the receiver's flags */
+static int rx_features_out(struct rade *r, int ret, int *has_eoo_out) {
     int valid_out = ret & 0x1;
     int endofover = ret & 0x2;
 
@@ -156,6 +277,136 @@ int rade_rx(struct rade *r, float features_out[], int *has_eoo_out, float eoo_ou
     }
 }
 
+int rade_rx(struct rade *r, float features_out[], int *has_eoo_out, float eoo_out[], RADE_COMP rx_in[]) {
+    assert(r != NULL);
+    assert(features_out != NULL);
+    assert(rx_in != NULL);
+
+    return rx_features_out(r, rade_rx_process(&r->rx, features_out, eoo_out, rx_in), has_eoo_out);
+}
+
+int rade_rx_real(struct rade *r, float features_out[], int *has_eoo_out, float eoo_out[],
+                 const float rx_in[]) {
+    assert(r != NULL);
+    assert(features_out != NULL);
+    assert(rx_in != NULL);
+
+    return rx_features_out(r, rade_rx_process_real(&r->rx, features_out, eoo_out, rx_in), has_eoo_out);
+}
+
+void rade_rx_multi(struct rade *r[], int n, int n_out[], float *features_out[],
+                   int has_eoo_out[], float *eoo_out[], RADE_COMP *rx_in[]) {
+    assert(r != NULL || n == 0);
+
+    /* Demodulate every receiver */
+    for (int i = 0; i < n; i++) {
+        assert(r[i] != NULL && features_out[i] != NULL && rx_in[i] != NULL);
+        int ret = rade_rx_demod(&r[i]->rx, r[i]->z_hat, eoo_out[i], rx_in[i]);
+        r[i]->decode_pending = ret & 0x1;
+        if (ret & 0x4) {
+            rade_rx_reset_decoder(&r[i]->rx);
+        }
+        has_eoo_out[i] = (ret & 0x2) ? 1 : 0;
+        n_out[i] = r[i]->decode_pending ? rade_rx_n_features_out(&r[i]->rx) : 0;
+    }
+
+    /* Decode the receivers with valid latents, grouped by decoder */
+    for (int i = 0; i < n; i++) {
+        if (!r[i]->decode_pending) continue;
+
+        rade_rx_state *rx[RADE_DEC_MAX_BATCH];
+        float *features[RADE_DEC_MAX_BATCH];
+        const float *z_hat[RADE_DEC_MAX_BATCH];
+        int uw_errors[RADE_DEC_MAX_BATCH];
+        int nb = 0;
+
+        for (int j = i; j < n; j++) {
+            if (!r[j]->decode_pending || !rade_rx_same_decoder(&r[i]->rx, &r[j]->rx)) continue;
+            rx[nb] = &r[j]->rx;
+            features[nb] = features_out[j];
+            z_hat[nb] = r[j]->z_hat;
+            r[j]->decode_pending = 0;
+            if (++nb == RADE_DEC_MAX_BATCH) {
+                rade_rx_decode_batch(rx, features, z_hat, uw_errors, nb);
+                for (int s = 0; s < nb; s++) {
+                    rade_rx_sum_uw_errors(rx[s], uw_errors[s]);
+                }
+                nb = 0;
+            }
+        }
+        if (nb > 0) {
+            rade_rx_decode_batch(rx, features, z_hat, uw_errors, nb);
+            for (int s = 0; s < nb; s++) {
+                rade_rx_sum_uw_errors(rx[s], uw_errors[s]);
+            }
+        }
+    }
+}
+
+int rade_n_latent_frame(struct rade *r) {
+    assert(r != NULL);
+    return RADE_NZMF * RADE_LATENT_DIM + 1;
+}
+
+/* Pass on the unique word errors decoded since the last demodulated frame */
+static void rx_collect_uw_errors(struct rade *r) {
+    pthread_mutex_lock(&r->uw_lock);
+    int uw_errors = r->uw_errors;
+    r->uw_errors = 0;
+    pthread_mutex_unlock(&r->uw_lock);
+    rade_rx_sum_uw_errors(&r->rx, uw_errors);
+}
+
+/* rade_rx_demod_frame() and rade_rx_demod_frame_real() outputs from the
+   receiver's flags */
+static int rx_latent_frame_out(float latent_frame_out[], int ret, int *has_eoo_out) {
+    *has_eoo_out = (ret & 0x2) ? 1 : 0;
+
+    /* The frame ends with the decoder reset flag */
+    latent_frame_out[RADE_NZMF * RADE_LATENT_DIM] = (ret & 0x4) ? 1.0f : 0.0f;
+
+    return ret & 0x1;
+}
+
+int rade_rx_demod_frame(struct rade *r, float latent_frame_out[], int *has_eoo_out, float eoo_out[],
+                        RADE_COMP rx_in[]) {
+    assert(r != NULL);
+    assert(latent_frame_out != NULL);
+    assert(rx_in != NULL);
+
+    rx_collect_uw_errors(r);
+    int ret = rade_rx_demod(&r->rx, latent_frame_out, eoo_out, rx_in);
+    return rx_latent_frame_out(latent_frame_out, ret, has_eoo_out);
+}
+
+int rade_rx_demod_frame_real(struct rade *r, float latent_frame_out[], int *has_eoo_out,
+                             float eoo_out[], const float rx_in[]) {
+    assert(r != NULL);
+    assert(latent_frame_out != NULL);
+    assert(rx_in != NULL);
+
+    rx_collect_uw_errors(r);
+    int ret = rade_rx_demod_real(&r->rx, latent_frame_out, eoo_out, rx_in);
+    return rx_latent_frame_out(latent_frame_out, ret, has_eoo_out);
+}
+
+int rade_rx_decode_frame(struct rade *r, float features_out[], const float latent_frame_in[]) {
+    assert(r != NULL);
+    assert(features_out != NULL);
+    assert(latent_frame_in != NULL);
+
+    if (latent_frame_in[RADE_NZMF * RADE_LATENT_DIM] != 0.0f) {
+        rade_rx_reset_decoder(&r->rx);
+    }
+    int uw_errors = rade_rx_decode(&r->rx, features_out, latent_frame_in);
+
+    pthread_mutex_lock(&r->uw_lock);
+    r->uw_errors += uw_errors;
+    pthread_mutex_unlock(&r->uw_lock);
+
+    return rade_rx_n_features_out(&r->rx);
+}
+
 int rade_sync(struct rade *r) {
     assert(r != NULL);
     return rade_rx_sync(&r->rx);
@@ -171,7 +422,48 @@ int rade_snrdB_3k_est(struct rade *r) {
     return (int)rade_rx_snrdB_3k_est(&r->rx);
 }
 
+int rade_frame_grid(struct rade *r) {
+    assert(r != NULL);
+    return RADE_NMF;
+}
+
+int rade_restart_point(struct rade *r) {
+    assert(r != NULL);
+    return rade_rx_restart_point(&r->rx);
+}
+
 void rade_set_disable_unsync(struct rade *r, float seconds) {
     assert(r != NULL);
     r->rx.disable_unsync = seconds;
 }
+
+int rade_arch(struct rade *r) {
+    assert(r != NULL);
+    return r->rx.arch;
+}
+
+void rade_set_arch(struct rade *r, int arch) {
+    assert(r != NULL);
+    r->rx.arch = rade_arch_clamp(arch);
+}
+
+/*---------------------------------------------------------------------------*\
+                        WORKER POOL
+\*---------------------------------------------------------------------------*/
+
+struct rade_pool *rade_pool_open(int nworkers) {
+    rade_pool *pool = rade_pool_create(nworkers);
+    if (pool == NULL) {
+        fprintf(stderr, "rade_pool_open: failed to start %d workers\n", nworkers);
+    }
+    return pool;
+}
+
+void rade_pool_close(struct rade_pool *pool) {
+    rade_pool_destroy(pool);
+}
+
+void rade_set_worker_pool(struct rade *r, struct rade_pool *pool) {
+    assert(r != NULL);
+    rade_acq_set_pool(&r->rx.acq, pool);
+}
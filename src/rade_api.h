@@ -74,6 +74,10 @@ extern "C" {
 // init rade_open() flags
 #define RADE_FOFF_TEST     0x4                // test mode used only by developers
 #define RADE_VERBOSE_0     0x8                // reduce verbosity to "quiet"
+#define RADE_INT8          0x10               // int8 decoder weights (faster, approximate)
+#define RADE_FAST_MATH     0x20               // equalizer without libm transcendentals (faster, approximate)
+#define RADE_ACQ_COARSE    0x40               // coarse-to-fine pilot search (faster acquisition)
+#define RADE_ACQ_WIDE      0x80               // +/-1 kHz pilot search rather than +/-50 Hz
 
 // Must be called BEFORE any other RADE functions as this
 // initializes internal library state.
@@ -82,10 +86,28 @@ RADE_EXPORT void rade_initialize(void);
 // Should be called when done with RADE.
 RADE_EXPORT void rade_finalize(void);
 
-// Receive-only build for FreeDV Monitor
+// Receive-only build for FreeDV Monitor. model_file is an optional decoder
+// weight file (see write_rade_weights), mapped read only and shared between
+// processes. NULL or "" uses $RADE_WEIGHTS if set, else the built-in weights.
+// A file that can't be loaded falls back to the built-in weights, or fails
+// the open when built with USE_WEIGHTS_FILE (no built-in weights).
 RADE_EXPORT struct rade *rade_open(char model_file[], int flags);
 RADE_EXPORT void rade_close(struct rade *r);
 
+// Shared context for many receivers in one process: the OFDM, acquisition
+// and filter tables and the decoder weights, read only once opened.
+// rade_context_open() takes model_file, RADE_INT8, RADE_FAST_MATH and
+// RADE_ACQ_WIDE as rade_open() does, rade_open_context() then opens receivers
+// that hold only their own mutable state and a reference to ctx. Those three
+// flags set up the shared tables, so they apply to every receiver on ctx and
+// are ignored by rade_open_context(). RADE_VERBOSE_0 is per receiver, and
+// RADE_ACQ_COARSE may be given to either. The context is freed once
+// rade_context_close() and the rade_close() of all its receivers have been
+// called, in any order. rade_open() is a context with a single receiver.
+RADE_EXPORT struct rade_context *rade_context_open(char model_file[], int flags);
+RADE_EXPORT void rade_context_close(struct rade_context *ctx);
+RADE_EXPORT struct rade *rade_open_context(struct rade_context *ctx, int flags);
+
 // Allows API users to determine if the API has changed
 RADE_EXPORT int rade_version(void);
 
@@ -103,6 +125,37 @@ RADE_EXPORT int rade_nin(struct rade *r);
 // from QPSK symbols in ..IQIQI... order
 RADE_EXPORT int rade_rx(struct rade *r, float features_out[], int *has_eoo_out, float eoo_out[], RADE_COMP rx_in[]);
 
+// rade_rx() and rade_rx_demod_frame() on real samples, e.g. audio from a
+// receiver: no Hilbert transformer needed, a single band-pass filter makes
+// the analytic signal at well under half the cost. Pick one input type per
+// r, or rade_close() and reopen to change.
+RADE_EXPORT int rade_rx_real(struct rade *r, float features_out[], int *has_eoo_out, float eoo_out[],
+                             const float rx_in[]);
+RADE_EXPORT int rade_rx_demod_frame_real(struct rade *r, float latent_frame_out[], int *has_eoo_out,
+                                         float eoo_out[], const float rx_in[]);
+
+// rade_rx() for n receivers at once, e.g. the channels of a multi-channel
+// monitor. rx_in[i] holds rade_nin(r[i]) samples, and n_out[i],
+// features_out[i], has_eoo_out[i] and eoo_out[i] are as for rade_rx() on
+// r[i]. The receivers that decode speech in this call and use the same
+// weights run the neural decoder together, which costs much less per
+// receiver than separate rade_rx() calls. Not thread safe for a given r[i].
+RADE_EXPORT void rade_rx_multi(struct rade *r[], int n, int n_out[], float *features_out[],
+                               int has_eoo_out[], float *eoo_out[], RADE_COMP *rx_in[]);
+
+// rade_rx() in two halves, so the modem and the neural decoder can run on
+// different threads. rade_rx_demod_frame() takes rade_nin() samples like
+// rade_rx() and returns 1 when it has written a latent frame of
+// rade_n_latent_frame() floats (the latents and decoder state flags, pass
+// it on unchanged). Each latent frame must then be given, in order, to
+// rade_rx_decode_frame(), which writes and returns rade_n_features_in_out()
+// features. One thread may demodulate while another decodes for the same
+// r; each half must only be called from one thread at a time.
+RADE_EXPORT int rade_n_latent_frame(struct rade *r);
+RADE_EXPORT int rade_rx_demod_frame(struct rade *r, float latent_frame_out[], int *has_eoo_out,
+                                    float eoo_out[], RADE_COMP rx_in[]);
+RADE_EXPORT int rade_rx_decode_frame(struct rade *r, float features_out[], const float latent_frame_in[]);
+
 // returns non-zero if Rx is currently in sync
 RADE_EXPORT int rade_sync(struct rade *r);
 
@@ -112,9 +165,31 @@ RADE_EXPORT float rade_freq_offset(struct rade *r);
 // returns the current SNR estimate (in dB) of the Rx signal ( when rade_sync()!=0 )
 RADE_EXPORT int rade_snrdB_3k_est(struct rade *r);
 
+// Splitting one recording across receivers, e.g. to decode it on several
+// cores. rade_restart_point() returns non-zero between modem frames where
+// the receiver has been searching long enough to hold no state from
+// earlier input. Two receivers opened a multiple of rade_frame_grid()
+// samples apart in the same rx_in stream, that are both at a restart point
+// after the same sample, give identical output from there on.
+RADE_EXPORT int rade_frame_grid(struct rade *r);
+RADE_EXPORT int rade_restart_point(struct rade *r);
+
 // test mode: disable unsync after this many seconds (0 = disabled)
 RADE_EXPORT void rade_set_disable_unsync(struct rade *r, float seconds);
 
+// CPU feature level used by the neural decoder, detected at rade_open() or
+// taken from the RADE_ARCH environment variable. 0 forces the generic C
+// kernels, values above what the CPU supports are clamped. Pass the same
+// value to FARGAN (FARGANState.arch) so speech synthesis matches.
+RADE_EXPORT int rade_arch(struct rade *r);
+RADE_EXPORT void rade_set_arch(struct rade *r, int arch);
+
+// optional worker pool for the acquisition search, one pool may be shared
+// by several receivers. Results are identical to the single thread path.
+RADE_EXPORT struct rade_pool *rade_pool_open(int nworkers);
+RADE_EXPORT void rade_pool_close(struct rade_pool *pool);
+RADE_EXPORT void rade_set_worker_pool(struct rade *r, struct rade_pool *pool);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,77 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_arch.c
+
+  CPU feature level for the Opus dnn kernels used by RADAE.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Built with HAVE_CONFIG_H so cpu_support.h sees the same run time CPU
+   detection settings (OPUS_HAVE_RTCD etc.) as the Opus library itself.
+   Without them opus_select_arch() is a stub that returns 0. */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "rade_arch.h"
+#include "cpu_support.h"
+#include <stdlib.h>
+
+/*---------------------------------------------------------------------------*\
+                              DETECTION
+\*---------------------------------------------------------------------------*/
+
+int rade_arch_detect(void) {
+    /* CPUID is cheap but not free, every receiver shares one answer. Racing
+       first callers compute the same value, so no lock is needed. */
+    static volatile int arch = -1;
+
+    if (arch < 0) {
+        arch = opus_select_arch() & OPUS_ARCHMASK;
+    }
+    return arch;
+}
+
+int rade_arch_clamp(int arch) {
+    int max_arch = rade_arch_detect();
+
+    if (arch < 0) return 0;
+    if (arch > max_arch) return max_arch;
+    return arch;
+}
+
+int rade_arch_default(void) {
+    const char *env = getenv("RADE_ARCH");
+
+    if (env != NULL && *env != '\0') {
+        return rade_arch_clamp(atoi(env));
+    }
+    return rade_arch_detect();
+}
@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_arch.h
+
+  CPU feature level for the Opus dnn kernels used by RADAE.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_ARCH__
+#define __RADE_ARCH__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The arch value selects the kernels the Opus dnn layer (and so the RADE
+   decoder and FARGAN) dispatch to, 0 is generic C. Higher values are
+   platform specific, as returned by opus_select_arch(). */
+
+/* Highest arch this CPU supports, detected once and cached */
+int rade_arch_detect(void);
+
+/* Limit arch to 0..rade_arch_detect(), a level above what the CPU supports
+   would execute illegal instructions */
+int rade_arch_clamp(int arch);
+
+/* Default arch for a new receiver: the detected level, or the RADE_ARCH
+   environment variable (clamped) when set, for A/B benchmarking */
+int rade_arch_default(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_ARCH__ */
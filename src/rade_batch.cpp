@@ -0,0 +1,922 @@
+/* ── rade_batch ────────────────────────────────────────────────────────────
+ *
+ *  Headless RADAE decoder for recordings: no GUI and no audio server, and
+ *  no pacing, so it runs as fast as the CPU allows.
+ *
+ *    rade_batch [options] input.wav output.wav
+ *
+ *  Writes the decoded speech as 16 kHz 16-bit mono WAV, optionally a
+ *  per-modem-frame metrics log (CSV), and reports the real-time factor.
+ *
+ *  With -j N the recording is cut into N segments decoded on their own
+ *  threads, each with its own reader, receiver and FARGAN.  A segment
+ *  starts a few frames early to warm up, and hands over to the next one
+ *  at the first sample past its end where both receivers are at a restart
+ *  point (searching, with nothing left from earlier input), so the
+ *  stitched output is the same as a serial decode.  A restart point needs
+ *  a gap between overs: a segment inside one long over runs on until it
+ *  ends.
+ *
+ *    rade_batch [options] -s summary.csv [-o DIR] inputs...
+ *
+ *  Decodes many recordings (files, directories searched for .wav, or a
+ *  list with -l) on a pool of workers, one receiver and FARGAN each, that
+ *  take the next file as they finish one.  A line per file goes to the
+ *  summary as it completes, and files already decoded in it are skipped,
+ *  so an interrupted run picks up where it stopped and retries failures.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "speech_synth.h"
+#include "wav_io.h"
+
+extern "C" {
+#include "rade_api.h"
+#include "rade_dsp.h"
+}
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static void usage()
+{
+    fprintf(stderr,
+        "usage: rade_batch [options] input output.wav\n"
+        "       rade_batch [options] -s summary.csv [-o DIR] input...\n"
+        "\n"
+        "  input is a WAV file at any sample rate, or with --raw headerless\n"
+        "  signed 16-bit 8 kHz mono (the GUI's raw recording); with -s also a\n"
+        "  directory, searched for .wav (or .raw) files\n"
+        "\n"
+        "  -m, --metrics FILE   per-frame sync/SNR/frequency log (CSV)\n"
+        "  -s, --summary FILE   decode many files, one CSV line each; files\n"
+        "                       already decoded ok in FILE are skipped\n"
+        "  -o, --out-dir DIR    with -s, write the speech to DIR (default none)\n"
+        "  -l, --list FILE      with -s, also decode the files listed in FILE\n"
+        "  -w, --weights FILE   decoder weight file (see write_rade_weights)\n"
+        "      --int8           int8 decoder weights (faster, approximate)\n"
+        "      --fast-math      equalizer without libm transcendentals (faster,\n"
+        "                       approximate)\n"
+        "      --acq-coarse     coarse-to-fine pilot search (faster acquisition)\n"
+        "      --acq-wide       search +/-1 kHz for the signal rather than +/-50 Hz\n"
+        "      --raw            input is raw 16-bit 8 kHz mono\n"
+        "  -j, --jobs N         decode N segments of the input in parallel, or\n"
+        "                       with -s N files at a time (default one per core)\n"
+        "  -q, --quiet          only print errors\n");
+}
+
+/* ── input ───────────────────────────────────────────────────────────── */
+
+static bool open_input(WavReader& reader, const std::string& path, bool raw)
+{
+    if (reader.open(path, RADE_FS, raw, RADE_FS)) return true;
+    fprintf(stderr, "%s\n", reader.error().c_str());
+    return false;
+}
+
+/* ── receiver and vocoder ────────────────────────────────────────────── */
+
+struct FrameOut {
+    int   nin;             // input samples consumed
+    int   n_features;      // rade_rx_real() output, 0 when none
+    int   n_pcm;           // speech samples in Receiver::pcm()
+    bool  synced;
+    bool  eoo;
+    float snr_dB;          // 0 unless synced
+    float freq_offset_Hz;
+};
+
+class Receiver {
+public:
+    /* speech = false skips FARGAN, for runs that only want the metrics */
+    Receiver(struct rade_context* ctx, bool speech) : speech_(speech)
+    {
+        r_ = rade_open_context(ctx, RADE_VERBOSE_0);
+        if (!r_) return;
+        synth_.reset(rade_arch(r_));
+
+        int n_features = rade_n_features_in_out(r_);
+        feat_buf_.resize(static_cast<size_t>(n_features));
+        eoo_buf_.resize(static_cast<size_t>(rade_n_eoo_bits(r_)));
+        pcm_.resize(static_cast<size_t>(n_features / SpeechSynth::NB_TOTAL_FEAT *
+                                        SpeechSynth::FRAME_SAMPLES));
+    }
+    ~Receiver() { if (r_) rade_close(r_); }
+    Receiver(const Receiver&)            = delete;
+    Receiver& operator=(const Receiver&) = delete;
+
+    bool ok() const { return r_ != nullptr; }
+    int  nin() const { return rade_nin(r_); }
+    int  nin_max() const { return rade_nin_max(r_); }
+    bool restart_point() const { return rade_restart_point(r_) != 0; }
+    const float* pcm() const { return pcm_.data(); }
+
+    /* the next modem frame from in[0, avail), false when avail is too short */
+    bool frame(const float* in, size_t avail, FrameOut& f)
+    {
+        int nin = rade_nin(r_);
+        if (avail < static_cast<size_t>(nin)) return false;
+        int has_eoo = 0;
+        int n_out = rade_rx_real(r_, feat_buf_.data(), &has_eoo, eoo_buf_.data(), in);
+
+        f.nin            = nin;
+        f.n_features     = n_out;
+        f.n_pcm          = 0;
+        f.synced         = (rade_sync(r_) != 0);
+        f.eoo            = (has_eoo != 0);
+        f.snr_dB         = f.synced ? static_cast<float>(rade_snrdB_3k_est(r_)) : 0.0f;
+        f.freq_offset_Hz = f.synced ? rade_freq_offset(r_) : 0.0f;
+
+        if (n_out > 0 && speech_)
+            f.n_pcm = synth_.synthesize(feat_buf_.data(), n_out, pcm_.data());
+
+        /* lost sync — fresh FARGAN for the next, after the last features of
+           this over, so every search starts from the same vocoder state */
+        if (was_synced_ && !f.synced)
+            synth_.reset(rade_arch(r_));
+        was_synced_ = f.synced;
+        return true;
+    }
+
+private:
+    struct rade*           r_ = nullptr;
+    bool                   speech_;
+    bool                   was_synced_ = false;
+    SpeechSynth            synth_;
+    std::vector<float>     feat_buf_;
+    std::vector<float>     eoo_buf_;
+    std::vector<float>     pcm_;
+};
+
+/* ── segments ──────────────────────────────────────────────────────── */
+
+static constexpr int    WARMUP_FRAMES   = 4;           // > BPF + rx buffer
+static constexpr size_t MIN_SEGMENT     = 60 * RADE_FS;
+static constexpr size_t FROM_UNKNOWN    = SIZE_MAX;
+static constexpr size_t FROM_SKIPPED    = SIZE_MAX - 1;
+
+struct FrameLog {
+    size_t end;            // input position after the frame
+    size_t pcm_end;        // speech samples the segment had written after it
+    float  snr_dB;
+    float  freq_offset_Hz;
+    int    n_features;
+    bool   synced;
+    bool   restart;        // rade_restart_point(), past the segment's warm-up
+};
+
+struct Segment {
+    WavReader reader;      // the input, from begin
+    size_t begin = 0;      // first sample decoded, warm-up included
+    size_t warm  = 0;      // first sample a restart point counts from
+    size_t end   = 0;      // nominal end, where the next segment is meant to take over
+
+    /* the output is the frames ending in (from, to]: from is set by the
+       segment before at its handoff, to by this segment's own thread */
+    std::atomic<size_t> from {FROM_UNKNOWN};
+    size_t              to = 0;
+
+    std::atomic<size_t> progress {0};      // end of the last logged frame
+    std::atomic<bool>   done {false};
+    std::mutex            log_mutex;       // log is read by the segment before
+    std::vector<FrameLog> log;
+    FILE* pcm = nullptr;                   // decoded speech, float, temporary
+    bool  pcm_ok = true;
+
+    bool restart_at(size_t pos)
+    {
+        std::lock_guard<std::mutex> lock(log_mutex);
+        auto it = std::lower_bound(log.begin(), log.end(), pos,
+                                   [](const FrameLog& f, size_t p) { return f.end < p; });
+        return it != log.end() && it->end == pos && it->restart;
+    }
+};
+
+/* true when seg can stop, with the next segment taking over after seg.to;
+   cand is the first frame of seg's own log not yet tried as a handoff */
+static bool hand_off(Segment& seg, Segment* next, size_t& cand)
+{
+    size_t from = seg.from.load(std::memory_order_acquire);
+    if (from == FROM_SKIPPED) {             // the segment before ran to the end
+        seg.to = FROM_SKIPPED;
+        if (next) next->from.store(FROM_SKIPPED, std::memory_order_release);
+        return true;
+    }
+    if (!next || from == FROM_UNKNOWN) return false;
+
+    for (; cand < seg.log.size(); cand++) {
+        const FrameLog& f = seg.log[cand];
+        if (!f.restart || f.end < seg.end || f.end < from) continue;
+        bool next_done = next->done.load(std::memory_order_acquire);
+        if (next->progress.load(std::memory_order_acquire) < f.end) {
+            if (!next_done) return false;   // not there yet, keep decoding
+            continue;
+        }
+        if (next->restart_at(f.end)) {
+            seg.to = f.end;
+            next->from.store(f.end, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void decode_segment(struct rade_context* ctx,
+                           std::vector<std::unique_ptr<Segment>>& segs, size_t k)
+{
+    Segment& seg  = *segs[k];
+    Segment* next = (k + 1 < segs.size()) ? segs[k + 1].get() : nullptr;
+
+    Receiver rx(ctx, true);
+    size_t pos = seg.begin, pcm_end = 0, cand = 0;
+    bool   handed_off = false;
+    std::vector<float> in(rx.ok() ? static_cast<size_t>(rx.nin_max()) : 0);
+    bool   at_begin = seg.reader.skip(seg.begin);
+    FrameOut out;
+    while (at_begin && rx.ok()) {
+        size_t nin = static_cast<size_t>(rx.nin());
+        size_t got = seg.reader.read(in.data(), nin);
+        if (!rx.frame(in.data(), got, out)) break;
+        pos += static_cast<size_t>(out.nin);
+        if (out.n_pcm > 0) {
+            if (std::fwrite(rx.pcm(), sizeof(float), static_cast<size_t>(out.n_pcm), seg.pcm) !=
+                static_cast<size_t>(out.n_pcm))
+                seg.pcm_ok = false;
+            pcm_end += static_cast<size_t>(out.n_pcm);
+        }
+
+        FrameLog f{};
+        f.end            = pos;
+        f.pcm_end        = pcm_end;
+        f.synced         = out.synced;
+        f.snr_dB         = out.snr_dB;
+        f.freq_offset_Hz = out.freq_offset_Hz;
+        f.n_features     = out.n_features;
+        f.restart        = rx.restart_point() && pos >= seg.warm;
+        {
+            std::lock_guard<std::mutex> lock(seg.log_mutex);
+            seg.log.push_back(f);
+        }
+        seg.progress.store(pos, std::memory_order_release);
+
+        if (hand_off(seg, next, cand)) {
+            handed_off = true;
+            break;
+        }
+    }
+    if (!rx.ok() || !at_begin) seg.pcm_ok = false;
+
+    if (!handed_off) {                      /* ran to the end of the input */
+        seg.to = pos;
+        if (next) next->from.store(FROM_SKIPPED, std::memory_order_release);
+    }
+    seg.done.store(true, std::memory_order_release);
+}
+
+/* one line of the metrics log */
+static void write_metrics(FILE* metrics, long frame, const FrameLog& f)
+{
+    fprintf(metrics, "%ld,%.3f,%d,%.1f,%.1f,%d\n", frame,
+            static_cast<double>(f.end) / RADE_FS, f.synced ? 1 : 0,
+            static_cast<double>(f.snr_dB), static_cast<double>(f.freq_offset_Hz),
+            f.n_features);
+}
+
+/* append a segment's share of speech and metrics to the output */
+static bool stitch_segment(Segment& seg, size_t from, WavWriter& out, FILE* metrics,
+                           long& frame, long& synced_frames)
+{
+    size_t pcm_begin = 0, pcm_end = 0;
+    for (const FrameLog& f : seg.log) {
+        if (f.end <= from) {
+            pcm_begin = pcm_end = f.pcm_end;
+            continue;
+        }
+        if (f.end > seg.to) break;
+        pcm_end = f.pcm_end;
+        synced_frames += f.synced;
+        if (metrics) write_metrics(metrics, frame, f);
+        frame++;
+    }
+
+    if (!seg.pcm_ok || std::fflush(seg.pcm) != 0) return false;
+    std::rewind(seg.pcm);
+    for (size_t skip = pcm_begin * sizeof(float); skip > 0; ) {     /* long may be 32 bit */
+        size_t step = std::min<size_t>(skip, 1u << 30);
+        if (std::fseek(seg.pcm, static_cast<long>(step), SEEK_CUR) != 0) return false;
+        skip -= step;
+    }
+    float buf[4096];
+    for (size_t n = pcm_begin; n < pcm_end; ) {
+        size_t chunk = std::min(sizeof(buf) / sizeof(buf[0]), pcm_end - n);
+        if (std::fread(buf, sizeof(float), chunk, seg.pcm) != chunk) return false;
+        out.write(buf, chunk);
+        n += chunk;
+    }
+    return true;
+}
+
+/* ── one recording ───────────────────────────────────────────────────── */
+
+struct RecordingStats {
+    long   frames        = 0;
+    long   synced_frames = 0;
+    size_t n_in          = 0;      // input samples at 8 kHz
+    size_t n_segs        = 1;
+    size_t n_used        = 1;      // segments the output came from
+};
+
+/* one receiver a modem frame at a time straight from the reader, as
+   decode_file() does, so memory doesn't grow with the recording */
+static bool decode_stream(struct rade_context* ctx, WavReader& reader, WavWriter& out,
+                          FILE* metrics, RecordingStats& st)
+{
+    Receiver rx(ctx, true);
+    if (!rx.ok()) return false;
+
+    std::vector<float> in(static_cast<size_t>(rx.nin_max()));
+    size_t pos = 0;
+    FrameOut out_f;
+    for (;;) {
+        size_t nin = static_cast<size_t>(rx.nin());
+        size_t got = reader.read(in.data(), nin);
+        st.n_in += got;
+        if (got < nin || !rx.frame(in.data(), nin, out_f)) break;
+        pos += nin;
+        if (out_f.n_pcm > 0) out.write(rx.pcm(), static_cast<size_t>(out_f.n_pcm));
+
+        FrameLog f{};
+        f.end            = pos;
+        f.synced         = out_f.synced;
+        f.snr_dB         = out_f.snr_dB;
+        f.freq_offset_Hz = out_f.freq_offset_Hz;
+        f.n_features     = out_f.n_features;
+        st.synced_frames += f.synced;
+        if (metrics) write_metrics(metrics, st.frames, f);
+        st.frames++;
+    }
+    return true;
+}
+
+/* the input cut into segments, one reader, receiver and vocoder each.
+   A segment's reader starts at its begin sample: a seek for 8 kHz input,
+   otherwise the samples before are resampled and dropped, so segment k
+   converts about k/N of the file twice but memory stays a few blocks */
+static bool decode_segments(struct rade_context* ctx, const std::string& in_path, bool raw,
+                            size_t n_in, int jobs, WavWriter& out, FILE* metrics,
+                            RecordingStats& st)
+{
+
+    size_t grid   = static_cast<size_t>(RADE_NMF);
+    size_t n_segs = std::max<size_t>(1, std::min(static_cast<size_t>(jobs),
+                                                 n_in / MIN_SEGMENT));
+    std::vector<std::unique_ptr<Segment>> segs;
+    bool ok = true;
+    for (size_t k = 0; k < n_segs && ok; k++) {
+        auto seg = std::make_unique<Segment>();
+        size_t start = n_in * k / n_segs / grid * grid;
+        seg->begin = (k == 0) ? 0 : start - WARMUP_FRAMES * grid;
+        seg->warm  = (k == 0) ? 0 : start;
+        seg->end   = n_in * (k + 1) / n_segs / grid * grid;
+        seg->pcm   = std::tmpfile();
+        if (!seg->pcm) {
+            fprintf(stderr, "can't create a temporary file\n");
+            ok = false;
+        } else {
+            segs.push_back(std::move(seg));
+            ok = open_input(segs.back()->reader, in_path, raw);
+        }
+    }
+    if (!ok) {
+        for (auto& seg : segs) std::fclose(seg->pcm);
+        return false;
+    }
+    segs[0]->from.store(0);
+
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < n_segs; k++)
+        threads.emplace_back(decode_segment, ctx, std::ref(segs), k);
+    decode_segment(ctx, segs, 0);
+    for (auto& t : threads) t.join();
+
+    for (auto& seg : segs) {
+        if (seg->reader.error().empty()) continue;
+        fprintf(stderr, "%s: %s\n", in_path.c_str(), seg->reader.error().c_str());
+        ok = false;
+    }
+
+    st.n_in   = n_in;
+    st.n_segs = n_segs;
+    st.n_used = 0;
+    for (auto& seg : segs) {
+        size_t from = seg->from.load();
+        if (from == FROM_SKIPPED) break;
+        ok = stitch_segment(*seg, from, out, metrics, st.frames, st.synced_frames) && ok;
+        st.n_used++;
+    }
+    for (auto& seg : segs) std::fclose(seg->pcm);
+    return ok;
+}
+
+static int decode_recording(struct rade_context* ctx, const std::string& in_path,
+                            const std::string& out_path, const std::string& metrics_path,
+                            bool raw, int jobs, bool quiet)
+{
+    /* one job streams the input from here, segments open it once each */
+    WavReader reader;
+    if (!open_input(reader, in_path, raw)) return 1;
+    size_t n_in = static_cast<size_t>(reader.length());
+    if (jobs > 1) reader.close();
+
+    /* metrics first, so a failure there doesn't leave an empty WAV */
+    FILE* metrics = nullptr;
+    if (!metrics_path.empty()) {
+        metrics = std::fopen(metrics_path.c_str(), "w");
+        if (!metrics) {
+            fprintf(stderr, "can't create %s\n", metrics_path.c_str());
+            return 1;
+        }
+        fprintf(metrics, "frame,time_s,sync,snr_dB,freq_offset_Hz,features\n");
+    }
+
+    WavWriter out;
+    if (!out.open(out_path, RADE_FS_SPEECH)) {
+        fprintf(stderr, "can't create %s\n", out_path.c_str());
+        if (metrics) std::fclose(metrics);
+        return 1;
+    }
+
+    /* ── decode ─────────────────────────────────────────────────────── */
+    auto t0 = std::chrono::steady_clock::now();
+
+    RecordingStats st;
+    bool ok = (jobs > 1) ? decode_segments(ctx, in_path, raw, n_in, jobs, out, metrics, st)
+                         : decode_stream(ctx, reader, out, metrics, st);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    double duration = static_cast<double>(st.n_in) / RADE_FS;
+
+    ok = out.close() && ok;
+    if (metrics && std::fclose(metrics) != 0) ok = false;
+
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s: %s\n", in_path.c_str(), reader.error().c_str());
+        return 1;
+    }
+    if (!ok) {
+        fprintf(stderr, "error writing output\n");
+        return 1;
+    }
+    if (!quiet) {
+        fprintf(stderr, "%s: %.1f s, %ld modem frames, %.1f%% in sync, %.1f s of speech\n",
+                in_path.c_str(), duration, st.frames,
+                st.frames ? 100.0 * st.synced_frames / st.frames : 0.0,
+                static_cast<double>(out.samples_written()) / RADE_FS_SPEECH);
+        if (st.n_segs > 1)
+            fprintf(stderr, "output from %zu of %zu segments\n", st.n_used, st.n_segs);
+        if (duration > 0.0)
+            fprintf(stderr, "decoded in %.2f s, RTF %.4f (%.1fx real time)\n",
+                    elapsed, elapsed / duration, duration / (elapsed + 1E-12));
+    }
+    return 0;
+}
+
+/* ── many recordings ─────────────────────────────────────────────────────
+ *
+ *  Each worker owns one Receiver at a time, reads the recording a modem
+ *  frame at a time and streams its speech to disk, so its memory is the
+ *  decoder state and a few blocks of audio whatever the file length.
+ *  Files are handed out longest first from a shared counter: the jobs are
+ *  independent, so an idle worker just takes the next, and the long ones
+ *  don't end up last on a single core.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+namespace fs = std::filesystem;
+
+struct FileJob {
+    std::string path;
+    std::string out_name;      // speech file, relative to the output directory
+    uintmax_t   size;
+};
+
+struct FileSummary {
+    bool   ok           = false;
+    double duration_s   = 0.0;
+    double synced_s     = 0.0;
+    double snr_sum      = 0.0;     // over synced frames
+    double foff_sum     = 0.0;
+    long   synced_frames = 0;
+    long   eoo          = 0;
+    double speech_s     = 0.0;
+    double decode_s     = 0.0;
+};
+
+static const char* SUMMARY_HEADER =
+    "file,status,duration_s,synced_s,snr_dB,freq_offset_Hz,eoo,speech_s,decode_s,rtf\n";
+
+static bool has_ext(const fs::path& p, const char* ext)
+{
+    std::string e = p.extension().string();
+    std::transform(e.begin(), e.end(), e.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return e == ext;
+}
+
+/* output names compared as a case-insensitive filesystem would */
+static std::string name_key(const std::string& name)
+{
+    std::string k = name;
+    std::transform(k.begin(), k.end(), k.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return k;
+}
+
+/* two inputs named alike (a/x.wav and b/x.wav) would write one output:
+   those keep the input's own path under the output directory, without
+   its root or any "..", and anything still alike gets a number */
+static void unique_out_names(std::vector<FileJob>& jobs)
+{
+    std::map<std::string, int> uses;
+    for (const FileJob& j : jobs) uses[name_key(j.out_name)]++;
+
+    for (FileJob& j : jobs) {
+        if (uses[name_key(j.out_name)] < 2) continue;
+        fs::path rel;
+        for (const fs::path& part : fs::path(j.path).lexically_normal().relative_path())
+            if (part != ".." && part != ".") rel /= part;
+        j.out_name = rel.replace_extension(".wav").string();
+    }
+
+    std::set<std::string> used;
+    for (FileJob& j : jobs) {
+        fs::path name(j.out_name);
+        for (int n = 2; !used.insert(name_key(j.out_name)).second; n++)
+            j.out_name = (name.parent_path() / (name.stem().string() + "-" + std::to_string(n) +
+                                                 ".wav")).string();
+    }
+}
+
+/* expand directories (recursively) and list files into jobs, each file
+   once and each with its own output name */
+static bool collect_jobs(const std::vector<std::string>& inputs, const std::string& list_path,
+                         bool raw, std::vector<FileJob>& jobs)
+{
+    const char* ext = raw ? ".raw" : ".wav";
+    std::error_code ec;
+
+    auto add = [&](const fs::path& p, const fs::path& rel) {
+        FileJob j;
+        j.path     = p.string();
+        j.out_name = fs::path(rel).replace_extension(".wav").string();
+        j.size     = fs::file_size(p, ec);
+        if (ec) j.size = 0;
+        jobs.push_back(j);
+    };
+
+    std::vector<std::string> paths = inputs;
+    if (!list_path.empty()) {
+        FILE* f = std::fopen(list_path.c_str(), "r");
+        if (!f) {
+            fprintf(stderr, "can't open %s\n", list_path.c_str());
+            return false;
+        }
+        char line[4096];
+        while (std::fgets(line, sizeof(line), f)) {
+            std::string s(line);
+            while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) s.pop_back();
+            if (!s.empty() && s[0] != '#') paths.push_back(s);
+        }
+        std::fclose(f);
+    }
+
+    for (const std::string& in : paths) {
+        fs::path p(in);
+        if (fs::is_directory(p, ec)) {
+            std::vector<fs::path> found;
+            for (fs::recursive_directory_iterator it(p, ec), end; !ec && it != end; it.increment(ec))
+                if (it->is_regular_file(ec) && has_ext(it->path(), ext))
+                    found.push_back(it->path());
+            if (ec) {
+                fprintf(stderr, "can't read directory %s\n", in.c_str());
+                return false;
+            }
+            std::sort(found.begin(), found.end());
+            for (const fs::path& f : found) add(f, fs::relative(f, p, ec));
+        } else if (fs::is_regular_file(p, ec)) {
+            add(p, p.filename());
+        } else {
+            fprintf(stderr, "%s: no such file or directory\n", in.c_str());
+            return false;
+        }
+    }
+
+    /* the same file given twice, or by two routes */
+    std::set<fs::path> seen;
+    jobs.erase(std::remove_if(jobs.begin(), jobs.end(),
+                              [&](const FileJob& j) {
+                                  fs::path c = fs::weakly_canonical(j.path, ec);
+                                  return !seen.insert(ec ? fs::path(j.path) : c).second;
+                              }),
+               jobs.end());
+    unique_out_names(jobs);
+    return true;
+}
+
+/* field of a summary line from pos, unquoted; pos moves past its comma */
+static std::string csv_field(const std::string& line, size_t& pos)
+{
+    std::string field;
+    if (pos < line.size() && line[pos] == '"') {
+        for (pos++; pos < line.size(); pos++) {
+            if (line[pos] == '"') {
+                if (pos + 1 < line.size() && line[pos + 1] == '"') { field += '"'; pos++; }
+                else { pos++; break; }
+            } else {
+                field += line[pos];
+            }
+        }
+    }
+    size_t comma = line.find(',', pos);
+    if (comma == std::string::npos) comma = line.size();
+    field += line.substr(pos, comma - pos);
+    pos = comma + 1;
+    return field;
+}
+
+static std::string csv_quote(const std::string& s)
+{
+    if (s.find_first_of(",\"\n") == std::string::npos) return s;
+    std::string q = "\"";
+    for (char c : s) {
+        if (c == '"') q += '"';
+        q += c;
+    }
+    return q + "\"";
+}
+
+/* files already decoded in the summary, which is truncated to its last
+   complete line (an interrupted run can leave half a line) and opened for
+   append. Failed files are not done: the failure may have been the disk or
+   a mount, so they are tried again and their new line follows the old */
+static FILE* open_summary(const std::string& path, std::set<std::string>& done)
+{
+    std::error_code ec;
+    uintmax_t keep = 0;
+    if (FILE* f = std::fopen(path.c_str(), "rb")) {
+        std::string line;
+        uintmax_t pos = 0;
+        int c;
+        while ((c = std::fgetc(f)) != EOF) {
+            pos++;
+            if (c != '\n') {
+                line += static_cast<char>(c);
+                continue;
+            }
+            if (keep > 0 && !line.empty()) {
+                size_t field = 0;
+                std::string file = csv_field(line, field);
+                if (csv_field(line, field) == "ok") done.insert(file);
+            }
+            keep = pos;             /* the header is line one */
+            line.clear();
+        }
+        std::fclose(f);
+        if (pos != keep) fs::resize_file(path, keep, ec);
+    }
+
+    FILE* f = std::fopen(path.c_str(), "a");
+    if (f && keep == 0) std::fputs(SUMMARY_HEADER, f);
+    return f;
+}
+
+static FileSummary decode_file(struct rade_context* ctx, const FileJob& job,
+                               const std::string& out_dir, bool raw)
+{
+    FileSummary sum;
+    auto t0 = std::chrono::steady_clock::now();
+
+    WavReader reader;
+    if (!open_input(reader, job.path, raw)) return sum;
+
+    WavWriter out;
+    bool speech = !out_dir.empty();
+    if (speech) {
+        fs::path out_path = fs::path(out_dir) / job.out_name;
+        std::error_code ec;
+        fs::create_directories(out_path.parent_path(), ec);
+        if (fs::equivalent(out_path, job.path, ec)) {
+            fprintf(stderr, "%s: output would overwrite the input\n", job.path.c_str());
+            return sum;
+        }
+        if (!out.open(out_path.string(), RADE_FS_SPEECH)) {
+            fprintf(stderr, "can't create %s\n", out_path.string().c_str());
+            return sum;
+        }
+    }
+
+    Receiver rx(ctx, speech);
+    if (!rx.ok()) return sum;
+
+    /* one modem frame at a time straight from the reader */
+    std::vector<float> in(static_cast<size_t>(rx.nin_max()));
+    size_t n_in = 0;
+    FrameOut f;
+    for (;;) {
+        size_t nin = static_cast<size_t>(rx.nin());
+        size_t got = reader.read(in.data(), nin);
+        n_in += got;
+        if (got < nin || !rx.frame(in.data(), nin, f)) break;
+        if (f.synced) {
+            sum.synced_frames++;
+            sum.synced_s += static_cast<double>(f.nin) / RADE_FS;
+            sum.snr_sum  += f.snr_dB;
+            sum.foff_sum += f.freq_offset_Hz;
+        }
+        sum.eoo += f.eoo;
+        if (f.n_pcm > 0) out.write(rx.pcm(), static_cast<size_t>(f.n_pcm));
+    }
+
+    sum.duration_s = static_cast<double>(n_in) / RADE_FS;
+    sum.speech_s   = static_cast<double>(out.samples_written()) / RADE_FS_SPEECH;
+    sum.ok = speech ? out.close() : true;
+    if (!sum.ok) fprintf(stderr, "%s: error writing output\n", job.path.c_str());
+    if (!reader.error().empty()) {
+        fprintf(stderr, "%s: %s\n", job.path.c_str(), reader.error().c_str());
+        sum.ok = false;
+    }
+    sum.decode_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return sum;
+}
+
+static int decode_many(struct rade_context* ctx, const std::vector<std::string>& inputs,
+                       const std::string& list_path, const std::string& summary_path,
+                       const std::string& out_dir, bool raw, int jobs, bool quiet)
+{
+    std::vector<FileJob> all;
+    if (!collect_jobs(inputs, list_path, raw, all)) return 1;
+
+    std::set<std::string> done;
+    FILE* summary = open_summary(summary_path, done);
+    if (!summary) {
+        fprintf(stderr, "can't open %s\n", summary_path.c_str());
+        return 1;
+    }
+
+    std::vector<FileJob> todo;
+    for (FileJob& j : all)
+        if (done.insert(j.path).second) todo.push_back(std::move(j));   /* once each */
+    std::stable_sort(todo.begin(), todo.end(),
+                     [](const FileJob& a, const FileJob& b) { return a.size > b.size; });
+    if (!quiet)
+        fprintf(stderr, "%zu files, %zu already in %s\n",
+                all.size(), all.size() - todo.size(), summary_path.c_str());
+
+    std::atomic<size_t> next {0};
+    std::mutex summary_mutex;
+    size_t n_done = 0, n_failed = 0;
+    double audio_s = 0.0;
+    bool   write_ok = true;
+
+    auto worker = [&]() {
+        size_t i;
+        while ((i = next.fetch_add(1)) < todo.size()) {
+            const FileJob& job = todo[i];
+            FileSummary s = decode_file(ctx, job, out_dir, raw);
+
+            std::lock_guard<std::mutex> lock(summary_mutex);
+            long n = s.synced_frames;
+            if (s.ok) {
+                fprintf(summary, "%s,ok,%.3f,%.3f,%.1f,%.1f,%ld,%.3f,%.3f,%.4f\n",
+                        csv_quote(job.path).c_str(), s.duration_s, s.synced_s,
+                        n ? s.snr_sum / n : 0.0, n ? s.foff_sum / n : 0.0, s.eoo,
+                        s.speech_s, s.decode_s,
+                        s.duration_s > 0.0 ? s.decode_s / s.duration_s : 0.0);
+            } else {
+                fprintf(summary, "%s,error,,,,,,,,\n", csv_quote(job.path).c_str());
+                n_failed++;
+            }
+            if (std::fflush(summary) != 0) write_ok = false;
+            audio_s += s.duration_s;
+            n_done++;
+            if (!quiet)
+                fprintf(stderr, "[%zu/%zu] %s: %s%.1f s, %.1f s in sync, RTF %.4f\n",
+                        n_done, todo.size(), job.path.c_str(), s.ok ? "" : "FAILED, ",
+                        s.duration_s, s.synced_s,
+                        s.duration_s > 0.0 ? s.decode_s / s.duration_s : 0.0);
+        }
+    };
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t n_workers = std::min(static_cast<size_t>(jobs), todo.size());
+    std::vector<std::thread> threads;
+    for (size_t k = 1; k < n_workers; k++) threads.emplace_back(worker);
+    if (n_workers > 0) worker();
+    for (auto& t : threads) t.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    if (std::fclose(summary) != 0) write_ok = false;
+    if (!write_ok) {
+        fprintf(stderr, "error writing %s\n", summary_path.c_str());
+        return 1;
+    }
+    if (!quiet && n_done > 0)
+        fprintf(stderr, "decoded %.1f h of audio in %.1f s on %zu workers (%.1fx real time)\n",
+                audio_s / 3600.0, elapsed, n_workers, audio_s / (elapsed + 1E-12));
+    if (n_failed > 0) {
+        fprintf(stderr, "%zu files failed\n", n_failed);
+        return 1;
+    }
+    return 0;
+}
+
+/* ── main ────────────────────────────────────────────────────────────── */
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> inputs;
+    std::string metrics_path, weights_path, summary_path, out_dir, list_path;
+    bool raw = false, quiet = false;
+    int  flags = RADE_VERBOSE_0;
+    int  jobs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "-m" || arg == "--metrics") && i + 1 < argc) {
+            metrics_path = argv[++i];
+        } else if ((arg == "-s" || arg == "--summary") && i + 1 < argc) {
+            summary_path = argv[++i];
+        } else if ((arg == "-o" || arg == "--out-dir") && i + 1 < argc) {
+            out_dir = argv[++i];
+        } else if ((arg == "-l" || arg == "--list") && i + 1 < argc) {
+            list_path = argv[++i];
+        } else if ((arg == "-w" || arg == "--weights") && i + 1 < argc) {
+            weights_path = argv[++i];
+        } else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+            jobs = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--int8") {
+            flags |= RADE_INT8;
+        } else if (arg == "--fast-math") {
+            flags |= RADE_FAST_MATH;
+        } else if (arg == "--acq-coarse") {
+            flags |= RADE_ACQ_COARSE;
+        } else if (arg == "--acq-wide") {
+            flags |= RADE_ACQ_WIDE;
+        } else if (arg == "--raw") {
+            raw = true;
+        } else if (arg == "-q" || arg == "--quiet") {
+            quiet = true;
+        } else if (arg == "-h" || arg == "--help") {
+            usage();
+            return 0;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            fprintf(stderr, "unknown option %s\n", arg.c_str());
+            usage();
+            return 1;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    bool many = !summary_path.empty();
+    if (many ? (inputs.empty() && list_path.empty()) || !metrics_path.empty()
+             : inputs.size() != 2 || !out_dir.empty() || !list_path.empty()) {
+        usage();
+        return 1;
+    }
+    if (jobs == 0)
+        jobs = many ? std::max(1, static_cast<int>(std::thread::hardware_concurrency())) : 1;
+
+    rade_initialize();
+    std::vector<char> model(weights_path.begin(), weights_path.end());
+    model.push_back('\0');
+    struct rade_context* ctx = rade_context_open(model.data(), flags);
+    if (!ctx) {
+        fprintf(stderr, "rade_context_open failed\n");
+        return 1;
+    }
+
+    int ret = many ? decode_many(ctx, inputs, list_path, summary_path, out_dir, raw, jobs, quiet)
+                   : decode_recording(ctx, inputs[0], inputs[1], metrics_path, raw, jobs, quiet);
+
+    rade_context_close(ctx);
+    rade_finalize();
+    return ret;
+}
@@ -34,6 +34,8 @@
 */
 
 #include "rade_bpf.h"
+#include "rade_nco.h"
+#include "rade_vec.h"
 #include <string.h>
 #include <assert.h>
 
@@ -41,14 +43,17 @@
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-void rade_bpf_init(rade_bpf *bpf, int ntap, float Fs_Hz, float bandwidth_Hz,
-                   float centre_freq_Hz, int max_len) {
+void rade_bpf_taps_init(rade_bpf_taps *taps, int ntap, float Fs_Hz, float bandwidth_Hz,
+                        float centre_freq_Hz) {
     assert(ntap <= RADE_BPF_NTAP);
     assert(ntap % 2 == 1);  /* ntap should be odd for symmetric filter */
 
-    bpf->ntap = ntap;
-    bpf->alpha = 2.0f * M_PI * centre_freq_Hz / Fs_Hz;
-    bpf->max_len = max_len;
+    taps->ntap = ntap;
+
+    /* Centre rounded to a whole number of cycles per RADE_BPF_NCO_LEN
+       samples, so the mixer is a table that repeats exactly rather than a
+       recursive phasor, and the filter output depends only on the input */
+    int cycles = (int)lrintf(centre_freq_Hz * RADE_BPF_NCO_LEN / Fs_Hz);
 
     /* Generate lowpass filter coefficients using sinc function
        Bandwidth B = bandwidth_Hz / Fs_Hz (normalized)
@@ -58,22 +63,44 @@ void rade_bpf_init(rade_bpf *bpf, int ntap, float Fs_Hz, float bandwidth_Hz,
 
     for (int i = 0; i < ntap; i++) {
         float n = (float)(i - centre);
-        bpf->h[i] = B * rade_sinc(n * B);
+        taps->h[i] = B * rade_sinc(n * B);
     }
 
-    /* Initialize state */
-    rade_bpf_reset(bpf);
+    /* Mixer phasors from the exact NCO table, the down mixer the conjugate.
+       A period then a block more, so a block starting anywhere in the
+       period reads them contiguously */
+    rade_nco_table(taps->nco_up, cycles, RADE_BPF_NCO_LEN, RADE_BPF_NCO_LEN + RADE_BPF_BLOCK);
+    for (int n = 0; n < RADE_BPF_NCO_LEN + RADE_BPF_BLOCK; n++) {
+        taps->nco[n] = rade_cconj(taps->nco_up[n]);
+    }
+
+    /* rade_bpf_process() works out to the complex FIR h[k]*exp(j*alpha*k).
+       Applied to real x it gives half the output it would on the analytic
+       signal x + j*H{x}, plus x's negative frequencies, which sit in its
+       stopband. So doubled, it does the Hilbert transformer's job too.
+       Rotated by exp(-j*alpha*centre), a constant phase the receiver takes
+       out with the rest, the real part is symmetric and the imag part
+       antisymmetric, so both fold */
+    for (int k = 0; k < ntap; k++) {
+        double theta = 2.0 * M_PI * (double)((long)cycles * (centre - k) % RADE_BPF_NCO_LEN) / RADE_BPF_NCO_LEN;
+        taps->hc_re[k] = 2.0f * taps->h[k] * (float)cos(theta);
+        taps->hc_im[k] = 2.0f * taps->h[k] * (float)sin(theta);
+    }
+}
 
-    /* Pre-compute phase increment */
-    bpf->phase_inc = rade_cexp(-bpf->alpha);
+void rade_bpf_init(rade_bpf *bpf, const rade_bpf_taps *taps, int max_len) {
+    bpf->taps = taps;
+    bpf->max_len = max_len;
+    rade_bpf_reset(bpf);
 }
 
 void rade_bpf_reset(rade_bpf *bpf) {
     /* Clear filter memory */
-    memset(bpf->mem, 0, sizeof(RADE_COMP) * bpf->ntap);
+    memset(bpf->mem_re, 0, sizeof(bpf->mem_re));
+    memset(bpf->mem_im, 0, sizeof(bpf->mem_im));
 
-    /* Reset mixer phase */
-    bpf->phase = rade_cone();
+    /* Reset mixer phase, the first sample is mixed with exp(-j*alpha) */
+    bpf->nco_pos = 1;
 }
 
 /*---------------------------------------------------------------------------*\
@@ -83,37 +110,55 @@ void rade_bpf_reset(rade_bpf *bpf) {
 void rade_bpf_process(rade_bpf *bpf, RADE_COMP *y, const RADE_COMP *x, int n) {
     assert(n <= bpf->max_len);
 
-    int ntap = bpf->ntap;
-    RADE_COMP phase = bpf->phase;
-    RADE_COMP phase_inc = bpf->phase_inc;
+    const rade_bpf_taps *taps = bpf->taps;
+    int ntap = taps->ntap;
+    int nmem = ntap - 1;
+    int nco_pos = bpf->nco_pos;
+    RADE_COMP x_bb[RADE_BPF_BLOCK];
+    float y_re[RADE_BPF_BLOCK], y_im[RADE_BPF_BLOCK];
+
+    /* The delay line holds the last ntap-1 baseband samples followed by the
+       current block, so the whole block is filtered in one pass */
+    for (int i0 = 0; i0 < n; i0 += RADE_BPF_BLOCK) {
+        int nb = (n - i0 < RADE_BPF_BLOCK) ? (n - i0) : RADE_BPF_BLOCK;
 
-    /* Process each sample */
-    for (int i = 0; i < n; i++) {
         /* Mix down to baseband: x_bb = x * exp(-j*alpha*(i+1)) */
-        phase = rade_cmul(phase, phase_inc);
-        RADE_COMP x_bb = rade_cmul(x[i], phase);
-
-        /* Shift filter memory and add new sample */
-        for (int j = ntap - 1; j > 0; j--) {
-            bpf->mem[j] = bpf->mem[j - 1];
-        }
-        bpf->mem[0] = x_bb;
-
-        /* FIR filter: y_bb = sum(h[k] * mem[k])
-           Since h is real and symmetric, we can optimize but keep simple for now */
-        RADE_COMP y_bb = rade_czero();
-        for (int k = 0; k < ntap; k++) {
-            y_bb.real += bpf->h[k] * bpf->mem[k].real;
-            y_bb.imag += bpf->h[k] * bpf->mem[k].imag;
-        }
+        rade_vec_cmul(x_bb, &x[i0], &taps->nco[nco_pos], nb);
+        rade_vec_split(&bpf->mem_re[nmem], &bpf->mem_im[nmem], x_bb, nb);
+
+        /* FIR filter: y_bb[i] = sum(h[k] * x_bb[i-k]) */
+        rade_vec_fir_sym(y_re, taps->h, bpf->mem_re, ntap, nb);
+        rade_vec_fir_sym(y_im, taps->h, bpf->mem_im, ntap, nb);
+        rade_vec_join(&y[i0], y_re, y_im, nb);
 
         /* Mix back up to centre frequency: y = y_bb * conj(phase) */
-        y[i] = rade_cmul(y_bb, rade_cconj(phase));
+        rade_vec_cmul(&y[i0], &y[i0], &taps->nco_up[nco_pos], nb);
+
+        memmove(bpf->mem_re, &bpf->mem_re[nb], sizeof(float) * nmem);
+        memmove(bpf->mem_im, &bpf->mem_im[nb], sizeof(float) * nmem);
+        nco_pos = (nco_pos + nb) % RADE_BPF_NCO_LEN;
     }
 
-    /* Save phase state for next call
-       Normalize to prevent drift */
-    float phase_mag = rade_cabs(phase);
-    bpf->phase.real = phase.real / phase_mag;
-    bpf->phase.imag = phase.imag / phase_mag;
+    bpf->nco_pos = nco_pos;
+}
+
+void rade_bpf_process_real(rade_bpf *bpf, RADE_COMP *y, const float *x, int n) {
+    assert(n <= bpf->max_len);
+
+    const rade_bpf_taps *taps = bpf->taps;
+    int ntap = taps->ntap;
+    int nmem = ntap - 1;
+    float y_re[RADE_BPF_BLOCK], y_im[RADE_BPF_BLOCK];
+
+    /* Real history in mem_re, the real and imag taps each run over it */
+    for (int i0 = 0; i0 < n; i0 += RADE_BPF_BLOCK) {
+        int nb = (n - i0 < RADE_BPF_BLOCK) ? (n - i0) : RADE_BPF_BLOCK;
+
+        memcpy(&bpf->mem_re[nmem], &x[i0], sizeof(float) * nb);
+        rade_vec_fir_sym(y_re, taps->hc_re, bpf->mem_re, ntap, nb);
+        rade_vec_fir_antisym(y_im, taps->hc_im, bpf->mem_re, ntap, nb);
+        rade_vec_join(&y[i0], y_re, y_im, nb);
+
+        memmove(bpf->mem_re, &bpf->mem_re[nb], sizeof(float) * nmem);
+    }
 }
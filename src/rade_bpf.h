@@ -47,13 +47,26 @@ extern "C" {
                               BPF STATE
 \*---------------------------------------------------------------------------*/
 
+/* Filter design, read only after rade_bpf_taps_init() so it can be shared */
 typedef struct {
     int ntap;                               /* Number of filter taps */
-    float alpha;                            /* 2*pi*centre_freq/Fs (rad/sample) */
     float h[RADE_BPF_NTAP];                /* Filter coefficients (real, symmetric) */
-    RADE_COMP mem[RADE_BPF_NTAP];          /* Filter memory/state */
-    RADE_COMP phase;                        /* Mixer phase state */
-    RADE_COMP phase_inc;                    /* Phase increment per sample */
+    /* alpha below is the centre frequency in rad/sample, rounded to whole
+       cycles per RADE_BPF_NCO_LEN samples */
+    RADE_COMP nco[RADE_BPF_NCO_LEN + RADE_BPF_BLOCK];     /* Mixer phasors exp(-j*alpha*n), */
+    RADE_COMP nco_up[RADE_BPF_NCO_LEN + RADE_BPF_BLOCK];  /* and their conjugates: a period
+                                                              then a block more, so any block's
+                                                              phasors are contiguous */
+    float hc_re[RADE_BPF_NTAP];             /* Analytic band-pass for real input, time */
+    float hc_im[RADE_BPF_NTAP];             /* order, 2*h[k]*exp(j*alpha*(centre-k)) split */
+} rade_bpf_taps;
+
+typedef struct {
+    const rade_bpf_taps *taps;              /* Shared filter design (not owned) */
+    float mem_re[RADE_BPF_NTAP - 1 + RADE_BPF_BLOCK];  /* Baseband history then current */
+    float mem_im[RADE_BPF_NTAP - 1 + RADE_BPF_BLOCK];  /* block, split real/imag; real
+                                                           input uses mem_re alone */
+    int nco_pos;                            /* Mixer phasor of the next sample */
     int max_len;                            /* Maximum input length */
 } rade_bpf;
 
@@ -61,14 +74,17 @@ typedef struct {
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-/* Initialize BPF with specified parameters
+/* Design the filter
    ntap: number of filter taps (should be odd, typically 101)
    Fs_Hz: sample rate in Hz
    bandwidth_Hz: filter bandwidth in Hz
-   centre_freq_Hz: centre frequency in Hz
+   centre_freq_Hz: centre frequency in Hz */
+void rade_bpf_taps_init(rade_bpf_taps *taps, int ntap, float Fs_Hz, float bandwidth_Hz,
+                        float centre_freq_Hz);
+
+/* Initialize BPF state, taps must outlive bpf
    max_len: maximum input block length */
-void rade_bpf_init(rade_bpf *bpf, int ntap, float Fs_Hz, float bandwidth_Hz,
-                   float centre_freq_Hz, int max_len);
+void rade_bpf_init(rade_bpf *bpf, const rade_bpf_taps *taps, int max_len);
 
 /* Reset BPF state (clear memory and phase) */
 void rade_bpf_reset(rade_bpf *bpf);
@@ -84,13 +100,28 @@ void rade_bpf_reset(rade_bpf *bpf);
 
    The filter:
    1. Mixes input down to baseband
-   2. Applies lowpass FIR filter
+   2. Applies lowpass FIR filter, folded about its centre tap
    3. Mixes result back up to centre frequency
 
+   A receiver's nin is a single block, one pass of each step.
+
    This effectively creates a bandpass filter centered at centre_freq_Hz
    with bandwidth bandwidth_Hz. The negative frequency image is suppressed. */
 void rade_bpf_process(rade_bpf *bpf, RADE_COMP *y, const RADE_COMP *x, int n);
 
+/* Process real samples straight to the band-limited analytic signal
+   x: input samples (real, e.g. audio)
+   y: output samples (complex)
+   n: number of samples to process (must be <= max_len)
+
+   One complex FIR with the band-pass taps shifted up to centre_freq_Hz,
+   in place of a Hilbert transformer followed by rade_bpf_process(). The
+   passband matches rade_bpf_process() on the analytic signal, at the
+   filter delay alone and a constant phase; the negative frequency image
+   is left to the filter stopband. Shares memory with rade_bpf_process(),
+   so reset between the two. */
+void rade_bpf_process_real(rade_bpf *bpf, RADE_COMP *y, const float *x, int n);
+
 #ifdef __cplusplus
 }
 #endif
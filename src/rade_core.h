@@ -39,6 +39,15 @@ typedef struct RADEDecStruct RADEDecState;
 
 void rade_init_decoder(RADEDecState *dec_state);
 void rade_core_decoder(RADEDecState *dec_state, const RADEDec *model, float *features, const float *z_hat, int arch);
+int rade_select_int8_weights(RADEDec *model);
+
+/* Streams decoded together by rade_core_decoder_batch() per pass, larger
+   batches are split. Bounds the per pass stack use (~70 kB). */
+#define RADE_DEC_MAX_BATCH 8
+
+/* Decode one latent vector for each of nb streams that share model.
+   Equivalent to rade_core_decoder() per stream up to float rounding. */
+void rade_core_decoder_batch(RADEDecState *dec_states[], const RADEDec *model, float *features[], const float *latents[], int nb, int arch);
 
 extern const WeightArray radedec_arrays[];
 
@@ -32,6 +32,8 @@
 #include "rade_dec.h"
 #include "rade_constants.h"
 #include "os_support.h"
+#include "rade_vec.h"
+#include <assert.h>
 
 void rade_init_decoder(RADEDecState *dec_state)
 {
@@ -100,3 +102,204 @@ void rade_core_decoder(
 
     compute_generic_dense(&model->dec_output, features, buffer, ACTIVATION_LINEAR, arch);
 }
+
+/* Drop the float weights of every layer that also has int8 weights, so
+   compute_linear() takes the quantized int8 weight / float activation path.
+   Returns the number of layers switched. */
+int rade_select_int8_weights(RADEDec *model)
+{
+    LinearLayer *layers[] = {
+        &model->dec_glu1, &model->dec_glu2, &model->dec_glu3, &model->dec_glu4, &model->dec_glu5,
+        &model->dec_gru1_input, &model->dec_gru1_recurrent, &model->dec_gru2_input, &model->dec_gru2_recurrent,
+        &model->dec_gru3_input, &model->dec_gru3_recurrent, &model->dec_gru4_input, &model->dec_gru4_recurrent,
+        &model->dec_gru5_input, &model->dec_gru5_recurrent,
+        &model->dec_conv1, &model->dec_conv2, &model->dec_conv3, &model->dec_conv4, &model->dec_conv5
+    };
+    int i, n = 0;
+
+    /* dec_dense1 and dec_output are float only */
+    for (i=0;i<(int)(sizeof(layers)/sizeof(layers[0]));i++) {
+        if (layers[i]->weights != NULL) {
+            layers[i]->float_weights = NULL;
+            n++;
+        }
+    }
+    return n;
+}
+
+/* Batched decoder: the same layers as rade_core_decoder() run for several
+   streams at once. Each float weight is loaded once for up to four streams
+   (rade_vec_sgemm), turning the memory bound matrix-vector products into
+   matrix-matrix products. Recurrent state stays per stream. */
+
+#define DEC_BUFFER_SIZE (DEC_DENSE1_OUT_SIZE + DEC_GRU1_OUT_SIZE + DEC_GRU2_OUT_SIZE + DEC_GRU3_OUT_SIZE + DEC_GRU4_OUT_SIZE + DEC_GRU5_OUT_SIZE \
+                         + DEC_CONV1_OUT_SIZE + DEC_CONV2_OUT_SIZE + DEC_CONV3_OUT_SIZE + DEC_CONV4_OUT_SIZE + DEC_CONV5_OUT_SIZE)
+#define DEC_MAX_GRU_OUT (3*DEC_GRU1_STATE_SIZE)
+#define DEC_MAX_CONV_INPUTS (DEC_CONV5_IN_SIZE + DEC_CONV5_STATE_SIZE)
+
+static void batch_linear(const LinearLayer *linear, float *out[], const float *in[], int nb, int arch)
+{
+    int i, s;
+    int M = linear->nb_inputs;
+    int N = linear->nb_outputs;
+    const float *bias = linear->bias;
+
+    if (linear->float_weights == NULL) {
+        /* int8 weights, their activation quantisation is arch specific so
+           use the Opus kernels stream by stream */
+        for (s=0;s<nb;s++) compute_linear(linear, out[s], in[s], arch);
+        return;
+    }
+
+    if (linear->weights_idx != NULL) {
+        rade_vec_sgemm_sparse8x4(out, linear->float_weights, linear->weights_idx, N, in, nb);
+    } else {
+        rade_vec_sgemm(out, linear->float_weights, N, M, in, nb);
+    }
+
+    for (s=0;s<nb;s++) {
+        float *y = out[s];
+        if (bias != NULL) {
+            for (i=0;i<N;i++) y[i] += bias[i];
+        }
+        if (linear->diag) {
+            const float *x = in[s];
+            for (i=0;i<M;i++) {
+                y[i] += linear->diag[i]*x[i];
+                y[i+M] += linear->diag[i+M]*x[i];
+                y[i+2*M] += linear->diag[i+2*M]*x[i];
+            }
+        }
+    }
+}
+
+static void batch_dense(const LinearLayer *layer, float *output[], const float *input[], int nb, int activation, int arch)
+{
+    int s;
+    batch_linear(layer, output, input, nb, arch);
+    for (s=0;s<nb;s++) compute_activation(output[s], output[s], layer->nb_outputs, activation, arch);
+}
+
+static void batch_gru(const LinearLayer *input_weights, const LinearLayer *recurrent_weights, float *state[], const float *in[], int nb, int arch)
+{
+    int i, s;
+    int N = recurrent_weights->nb_inputs;
+    float zrh_buf[RADE_DEC_MAX_BATCH][DEC_MAX_GRU_OUT];
+    float recur_buf[RADE_DEC_MAX_BATCH][DEC_MAX_GRU_OUT];
+    float *zrh[RADE_DEC_MAX_BATCH], *recur[RADE_DEC_MAX_BATCH];
+
+    assert(recurrent_weights->nb_outputs <= DEC_MAX_GRU_OUT);
+    for (s=0;s<nb;s++) {
+        zrh[s] = zrh_buf[s];
+        recur[s] = recur_buf[s];
+    }
+    batch_linear(input_weights, zrh, in, nb, arch);
+    batch_linear(recurrent_weights, recur, (const float **)state, nb, arch);
+
+    for (s=0;s<nb;s++) {
+        float *z = zrh[s];
+        float *r = &zrh[s][N];
+        float *h = &zrh[s][2*N];
+        for (i=0;i<2*N;i++) zrh[s][i] += recur[s][i];
+        compute_activation(zrh[s], zrh[s], 2*N, ACTIVATION_SIGMOID, arch);
+        for (i=0;i<N;i++) h[i] += recur[s][2*N+i]*r[i];
+        compute_activation(h, h, N, ACTIVATION_TANH, arch);
+        for (i=0;i<N;i++) state[s][i] = z[i]*state[s][i] + (1-z[i])*h[i];
+    }
+}
+
+static void batch_glu(const LinearLayer *layer, float *output[], const float *input[], int nb, int arch)
+{
+    int i, s;
+    float act_buf[RADE_DEC_MAX_BATCH][DEC_MAX_GRU_OUT];
+    float *act[RADE_DEC_MAX_BATCH];
+
+    assert(layer->nb_outputs <= DEC_MAX_GRU_OUT);
+    for (s=0;s<nb;s++) act[s] = act_buf[s];
+    batch_linear(layer, act, input, nb, arch);
+    for (s=0;s<nb;s++) {
+        compute_activation(act[s], act[s], layer->nb_outputs, ACTIVATION_SIGMOID, arch);
+        for (i=0;i<layer->nb_outputs;i++) output[s][i] = input[s][i]*act[s][i];
+    }
+}
+
+static void batch_conv1d(const LinearLayer *layer, float *output[], float *mem[], const float *input[], int input_size, int activation, int nb, int arch)
+{
+    int s;
+    int nmem = layer->nb_inputs - input_size;
+    float tmp_buf[RADE_DEC_MAX_BATCH][DEC_MAX_CONV_INPUTS];
+    const float *tmp[RADE_DEC_MAX_BATCH];
+
+    assert(layer->nb_inputs <= DEC_MAX_CONV_INPUTS);
+    for (s=0;s<nb;s++) {
+        OPUS_COPY(tmp_buf[s], mem[s], nmem);
+        OPUS_COPY(&tmp_buf[s][nmem], input[s], input_size);
+        tmp[s] = tmp_buf[s];
+    }
+    batch_dense(layer, output, tmp, nb, activation, arch);
+    for (s=0;s<nb;s++) OPUS_COPY(mem[s], &tmp_buf[s][input_size], nmem);
+}
+
+/* One GRU -> GLU -> conv1d stage for every stream, appends GRU_OUT +
+   CONV_OUT values at output_index of each buffer */
+#define BATCH_STAGE(k) do { \
+    for (s=0;s<nb;s++) { \
+        state[s] = dec_states[s]->gru##k##_state; \
+        in[s] = buffer[s]; \
+        out[s] = &buffer[s][output_index]; \
+    } \
+    batch_gru(&model->dec_gru##k##_input, &model->dec_gru##k##_recurrent, state, in, nb, arch); \
+    for (s=0;s<nb;s++) in[s] = state[s]; \
+    batch_glu(&model->dec_glu##k, out, in, nb, arch); \
+    output_index += DEC_GRU##k##_OUT_SIZE; \
+    for (s=0;s<nb;s++) { \
+        conv1_cond_init(dec_states[s]->conv##k##_state, output_index, 1, &dec_states[s]->initialized); \
+        state[s] = dec_states[s]->conv##k##_state; \
+        in[s] = buffer[s]; \
+        out[s] = &buffer[s][output_index]; \
+    } \
+    batch_conv1d(&model->dec_conv##k, out, state, in, output_index, ACTIVATION_TANH, nb, arch); \
+    output_index += DEC_CONV##k##_OUT_SIZE; \
+} while (0)
+
+void rade_core_decoder_batch(
+    RADEDecState  *dec_states[],
+    const RADEDec *model,
+    float         *features[],
+    const float   *latents[],
+    int nb,
+    int arch
+    )
+{
+    int s;
+
+    /* Larger batches run in chunks, the stack buffers are per chunk */
+    while (nb > RADE_DEC_MAX_BATCH) {
+        rade_core_decoder_batch(dec_states, model, features, latents, RADE_DEC_MAX_BATCH, arch);
+        dec_states += RADE_DEC_MAX_BATCH;
+        features += RADE_DEC_MAX_BATCH;
+        latents += RADE_DEC_MAX_BATCH;
+        nb -= RADE_DEC_MAX_BATCH;
+    }
+    if (nb <= 0) return;
+
+    {
+        float buffer[RADE_DEC_MAX_BATCH][DEC_BUFFER_SIZE];
+        float *state[RADE_DEC_MAX_BATCH], *out[RADE_DEC_MAX_BATCH];
+        const float *in[RADE_DEC_MAX_BATCH];
+        int output_index = 0;
+
+        for (s=0;s<nb;s++) out[s] = buffer[s];
+        batch_dense(&model->dec_dense1, out, latents, nb, ACTIVATION_TANH, arch);
+        output_index += DEC_DENSE1_OUT_SIZE;
+
+        BATCH_STAGE(1);
+        BATCH_STAGE(2);
+        BATCH_STAGE(3);
+        BATCH_STAGE(4);
+        BATCH_STAGE(5);
+
+        for (s=0;s<nb;s++) in[s] = buffer[s];
+        batch_dense(&model->dec_output, features, in, nb, ACTIVATION_LINEAR, arch);
+    }
+}
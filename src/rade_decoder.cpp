@@ -1,4 +1,5 @@
 #include "rade_decoder.h"
+#include "wav_io.h"
 
 #include <cmath>
 #include <cstring>
@@ -11,8 +12,6 @@
 extern "C" {
 #include "rade_api.h"
 #include "rade_dsp.h"
-#include "fargan.h"
-#include "lpcnet.h"
 }
 
 #ifndef M_PI
@@ -24,142 +23,39 @@ extern "C" {
 RadaeDecoder::RadaeDecoder()  = default;
 RadaeDecoder::~RadaeDecoder() { stop(); close(); }
 
-/* ── Hilbert coefficient initialisation (matches rade_demod.c) ───────── */
-
-static void init_hilbert_coeffs(float coeffs[], int ntaps) {
-    int center = (ntaps - 1) / 2;
-    for (int i = 0; i < ntaps; i++) {
-        int n = i - center;
-        if (n == 0 || (n & 1) == 0) {
-            coeffs[i] = 0.0f;
-        } else {
-            float h = 2.0f / (static_cast<float>(M_PI) * n);
-            float w = 0.54f - 0.46f * std::cos(2.0f * static_cast<float>(M_PI) * i / (ntaps - 1));
-            coeffs[i] = h * w;
-        }
-    }
-}
-
-/* ── WAV file I/O (adapted from rade_demod.c) ────────────────────────── */
-
-#define WAV_FMT_PCM   1
-#define WAV_FMT_FLOAT 3
-
-struct wav_info {
-    int      sample_rate;
-    int      num_channels;
-    int      bits_per_sample;
-    bool     is_float;
-    long     data_offset;
-    uint32_t data_size;
-};
+/* ── shared acquisition worker pool ──────────────────────────────────
+ *
+ *  One pool per process, sized by the first decoder that asks for it and
+ *  shared by every receiver after that.  Lives until process exit.
+ * ──────────────────────────────────────────────────────────────────── */
 
-static bool wav_read_header(FILE* f, wav_info& info)
+static struct rade_pool* shared_worker_pool(int nworkers)
 {
-    char     tag[4];
-    uint32_t riff_size;
-
-    if (std::fread(tag, 1, 4, f) != 4 || std::memcmp(tag, "RIFF", 4)) return false;
-    if (std::fread(&riff_size, 4, 1, f) != 1) return false;
-    if (std::fread(tag, 1, 4, f) != 4 || std::memcmp(tag, "WAVE", 4)) return false;
-
-    info.data_offset = -1;
-
-    while (true) {
-        char     chunk_id[4];
-        uint32_t chunk_size;
-        if (std::fread(chunk_id, 1, 4, f) != 4) break;
-        if (std::fread(&chunk_size, 4, 1, f) != 1) break;
-
-        if (std::memcmp(chunk_id, "fmt ", 4) == 0) {
-            if (chunk_size < 16) return false;
-            uint8_t buf[16];
-            if (std::fread(buf, 1, 16, f) != 16) return false;
-
-            uint16_t audio_fmt, nch, bps;
-            uint32_t sr;
-            std::memcpy(&audio_fmt, buf + 0,  2);
-            std::memcpy(&nch,       buf + 2,  2);
-            std::memcpy(&sr,        buf + 4,  4);
-            std::memcpy(&bps,       buf + 14, 2);
-
-            info.sample_rate     = static_cast<int>(sr);
-            info.num_channels    = static_cast<int>(nch);
-            info.bits_per_sample = static_cast<int>(bps);
-            info.is_float        = (audio_fmt == WAV_FMT_FLOAT);
-
-            if (chunk_size > 16)
-                std::fseek(f, static_cast<long>(chunk_size - 16), SEEK_CUR);
-
-        } else if (std::memcmp(chunk_id, "data", 4) == 0) {
-            info.data_offset = std::ftell(f);
-            info.data_size   = chunk_size;
-            break;
-        } else {
-            std::fseek(f, static_cast<long>((chunk_size + 1) & ~1u), SEEK_CUR);
-        }
-    }
-    return (info.data_offset >= 0);
-}
+    static std::mutex        pool_mutex;
+    static struct rade_pool* pool = nullptr;
 
-static std::vector<float> wav_read_mono_float(FILE* f, const wav_info& info)
-{
-    int  bps  = info.bits_per_sample;
-    int  nch  = info.num_channels;
-    long total = static_cast<long>(info.data_size) / (bps / 8);
-    long mono  = total / nch;
-
-    std::vector<float> buf(static_cast<size_t>(mono));
-
-    for (long i = 0; i < mono; i++) {
-        float sum = 0.0f;
-        for (int ch = 0; ch < nch; ch++) {
-            float v = 0.0f;
-            if (info.is_float && bps == 32) {
-                float tmp; if (std::fread(&tmp, 4, 1, f) == 1) v = tmp;
-            } else if (info.is_float && bps == 64) {
-                double tmp; if (std::fread(&tmp, 8, 1, f) == 1) v = static_cast<float>(tmp);
-            } else if (bps == 16) {
-                int16_t tmp; if (std::fread(&tmp, 2, 1, f) == 1) v = tmp / 32768.0f;
-            } else if (bps == 24) {
-                uint8_t b[3]; if (std::fread(b, 1, 3, f) == 3) {
-                    int32_t raw = (static_cast<int32_t>(b[2]) << 16) | (b[1] << 8) | b[0];
-                    if (raw & 0x800000) raw |= static_cast<int32_t>(0xFF000000);
-                    v = raw / 8388608.0f;
-                }
-            } else if (bps == 32) {
-                int32_t tmp; if (std::fread(&tmp, 4, 1, f) == 1) v = tmp / 2147483648.0f;
-            } else {
-                return {};
-            }
-            sum += v;
-        }
-        buf[static_cast<size_t>(i)] = sum / nch;
-    }
-    return buf;
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!pool && nworkers > 0)
+        pool = rade_pool_open(nworkers);
+    return pool;
 }
 
-static std::vector<float> resample_batch(const std::vector<float>& in,
-                                         int in_rate, int out_rate)
+/* ── shared receiver context ─────────────────────────────────────────
+ *
+ *  Tables and decoder weights, built by the first decoder that opens and
+ *  shared by every receiver after that, so reopening (device changes, file
+ *  playback) only allocates per-stream state.  Lives until process exit.
+ * ──────────────────────────────────────────────────────────────────── */
+
+static struct rade_context* shared_context()
 {
-    if (in_rate == out_rate) return in;
-
-    auto n_in = static_cast<long>(in.size());
-    if (n_in < 2) return {};
-
-    long n_out = static_cast<long>(static_cast<double>(n_in) * out_rate / in_rate);
-    std::vector<float> out(static_cast<size_t>(n_out));
-
-    double step = static_cast<double>(in_rate) / static_cast<double>(out_rate);
-    for (long i = 0; i < n_out; i++) {
-        double pos  = i * step;
-        long   idx  = static_cast<long>(pos);
-        float  frac = static_cast<float>(pos - idx);
-        if (idx + 1 >= n_in) { idx = n_in - 2; frac = 1.0f; }
-        out[static_cast<size_t>(i)] = in[static_cast<size_t>(idx)]
-            + frac * (in[static_cast<size_t>(idx + 1)] - in[static_cast<size_t>(idx)]);
-    }
-    return out;
+    static std::mutex           ctx_mutex;
+    static struct rade_context* ctx = nullptr;
+
+    std::lock_guard<std::mutex> lock(ctx_mutex);
+    if (!ctx)
+        ctx = rade_context_open(nullptr, 0);
+    return ctx;
 }
 
 /* ── radix-2 Cooley-Tukey FFT (in-place, N must be power of 2) ────────── */
@@ -244,25 +140,18 @@ bool RadaeDecoder::open(const std::string& device_name)
 
     /* ── RADE receiver ──────────────────────────────────────────────── */
     rade_initialize();
-    rade_ = rade_open(nullptr, 0);
+    struct rade_context* ctx = shared_context();
+    rade_ = ctx ? rade_open_context(ctx, 0) : nullptr;
     if (!rade_) {
         audio_in_->close();  audio_in_.reset();
         audio_out_->close(); audio_out_.reset();
         return false;
     }
+    if (worker_threads_ > 0)
+        rade_set_worker_pool(rade_, shared_worker_pool(worker_threads_));
 
     /* ── FARGAN vocoder ─────────────────────────────────────────────── */
-    fargan_ = new FARGANState;
-    fargan_init(static_cast<FARGANState*>(fargan_));
-    fargan_ready_ = false;
-    warmup_count_ = 0;
-
-    /* ── Hilbert coefficients ───────────────────────────────────────── */
-    init_hilbert_coeffs(hilbert_coeffs_, HILBERT_NTAPS);
-    std::memset(hilbert_hist_, 0, sizeof(hilbert_hist_));
-    hilbert_pos_ = 0;
-    std::memset(delay_buf_, 0, sizeof(delay_buf_));
-    delay_pos_ = 0;
+    synth_.reset(rade_arch(rade_));
 
     /* ── Hanning window for FFT ─────────────────────────────────────── */
     for (int i = 0; i < FFT_SIZE; i++)
@@ -276,28 +165,8 @@ bool RadaeDecoder::open_file(const std::string& wav_path)
 {
     close();
 
-    /* ── Read and parse WAV file ────────────────────────────────── */
-    FILE* f = std::fopen(wav_path.c_str(), "rb");
-    if (!f) return false;
-
-    wav_info wav{};
-    if (!wav_read_header(f, wav)) {
-        std::fclose(f);
-        return false;
-    }
-
-    auto mono = wav_read_mono_float(f, wav);
-    std::fclose(f);
-    if (mono.empty()) return false;
-
-    /* ── Resample to 8 kHz ──────────────────────────────────────── */
-    if (wav.sample_rate != RADE_FS) {
-        file_audio_8k_ = resample_batch(mono, wav.sample_rate, RADE_FS);
-    } else {
-        file_audio_8k_ = std::move(mono);
-    }
-    if (file_audio_8k_.empty()) return false;
-    file_pos_ = 0;
+    /* ── WAV file, streamed at 8 kHz as it is decoded ──────────── */
+    if (!file_reader_.open(wav_path, RADE_FS)) return false;
 
     /* ── Open audio playback at 16 kHz mono float32 ─────────────── */
     audio_out_ = audio_create_playback();
@@ -308,24 +177,17 @@ bool RadaeDecoder::open_file(const std::string& wav_path)
 
     /* ── RADE receiver ──────────────────────────────────────────── */
     rade_initialize();
-    rade_ = rade_open(nullptr, 0);
+    struct rade_context* ctx = shared_context();
+    rade_ = ctx ? rade_open_context(ctx, 0) : nullptr;
     if (!rade_) {
         audio_out_->close(); audio_out_.reset();
         return false;
     }
+    if (worker_threads_ > 0)
+        rade_set_worker_pool(rade_, shared_worker_pool(worker_threads_));
 
     /* ── FARGAN vocoder ─────────────────────────────────────────── */
-    fargan_ = new FARGANState;
-    fargan_init(static_cast<FARGANState*>(fargan_));
-    fargan_ready_ = false;
-    warmup_count_ = 0;
-
-    /* ── Hilbert coefficients ───────────────────────────────────── */
-    init_hilbert_coeffs(hilbert_coeffs_, HILBERT_NTAPS);
-    std::memset(hilbert_hist_, 0, sizeof(hilbert_hist_));
-    hilbert_pos_ = 0;
-    std::memset(delay_buf_, 0, sizeof(delay_buf_));
-    delay_pos_ = 0;
+    synth_.reset(rade_arch(rade_));
 
     /* ── Hanning window for FFT ─────────────────────────────────── */
     for (int i = 0; i < FFT_SIZE; i++)
@@ -343,14 +205,11 @@ void RadaeDecoder::close()
     stop_recording();
 
     if (rade_) { rade_close(rade_); rade_ = nullptr; }
-    if (fargan_) { delete static_cast<FARGANState*>(fargan_); fargan_ = nullptr; }
 
     if (audio_in_)  { audio_in_->close();  audio_in_.reset(); }
     if (audio_out_) { audio_out_->close(); audio_out_.reset(); }
 
-    file_audio_8k_.clear();
-    file_audio_8k_.shrink_to_fit();
-    file_pos_  = 0;
+    file_reader_.close();
     file_mode_ = false;
 
     synced_       = false;
@@ -366,16 +225,42 @@ void RadaeDecoder::start()
 {
     if ((!audio_in_ && !file_mode_) || !audio_out_ || !rade_ || running_) return;
 
+    /* the stage frames are sized at compile time */
+    if (rade_n_latent_frame(rade_) != LATENT_FRAME_FLOATS ||
+        rade_n_features_in_out(rade_) != FEATURE_FLOATS) {
+        fprintf(stderr, "RADE frame sizes don't match the decoder pipeline\n");
+        return;
+    }
+
+    capture_ring_.reset(RING_SAMPLES);
+    latent_q_.reset(QUEUE_FRAMES);
+    feature_q_.reset(QUEUE_FRAMES);
+    speech_ring_.reset(SPEECH_SAMPLES);
+    speech_done_ = false;
+
     running_ = true;
-    thread_  = std::thread(&RadaeDecoder::processing_loop, this);
+    if (!file_mode_)
+        capture_thread_ = std::thread(&RadaeDecoder::capture_loop, this);
+    thread_          = std::thread(&RadaeDecoder::modem_loop, this);
+    decode_thread_   = std::thread(&RadaeDecoder::decode_loop, this);
+    synth_thread_    = std::thread(&RadaeDecoder::synth_loop, this);
+    playback_thread_ = std::thread(&RadaeDecoder::playback_loop, this);
 }
 
 void RadaeDecoder::stop()
 {
-    if (!running_) return;
+    if (!running_ && !thread_.joinable() && !capture_thread_.joinable() &&
+        !decode_thread_.joinable() && !synth_thread_.joinable() &&
+        !playback_thread_.joinable()) return;
     running_ = false;
+    wake_all();
 
-    if (thread_.joinable()) thread_.join();
+    for (std::thread* t : {&capture_thread_, &thread_, &decode_thread_,
+                           &synth_thread_, &playback_thread_})
+        if (t->joinable()) t->join();
+
+    if (capture_ring_.dropped() > 0)
+        fprintf(stderr, "Capture overrun: %zu samples dropped\n", capture_ring_.dropped());
 
     /* Flush any remaining playback data */
     if (audio_out_) audio_out_->flush();
@@ -385,111 +270,146 @@ void RadaeDecoder::stop()
     synced_       = false;
 }
 
-/* ── streaming Hilbert transform ─────────────────────────────────────
+/* ── queue depths ────────────────────────────────────────────────────── */
+
+size_t RadaeDecoder::queue_depth(PipelineQueue q) const
+{
+    switch (q) {
+    case QUEUE_CAPTURE:  return capture_ring_.available();
+    case QUEUE_LATENTS:  return latent_q_.size();
+    case QUEUE_FEATURES: return feature_q_.size();
+    case QUEUE_SPEECH:   return speech_ring_.available();
+    default:             return 0;
+    }
+}
+
+size_t RadaeDecoder::queue_high_water(PipelineQueue q) const
+{
+    switch (q) {
+    case QUEUE_CAPTURE:  return capture_ring_.high_water();
+    case QUEUE_LATENTS:  return latent_q_.high_water();
+    case QUEUE_FEATURES: return feature_q_.high_water();
+    case QUEUE_SPEECH:   return speech_ring_.high_water();
+    default:             return 0;
+    }
+}
+
+/* ── stage hand-off ──────────────────────────────────────────────────
  *
- *  For each input sample at 8 kHz, produce one RADE_COMP:
- *    .real = sample delayed by HILBERT_DELAY (63 samples)
- *    .imag = Hilbert-filtered sample
+ *  The queues themselves are lock-free; a gate's mutex is only for
+ *  sleeping.  A waiter tests ready() under the mutex, and wake() takes the
+ *  same mutex after the queue has moved, so the change is either seen by
+ *  that test or the notify comes after the waiter is asleep: no wake-up
+ *  is lost and nothing needs a timeout.  Every ready() also returns true
+ *  once running_ drops, which wake_all() signals on every gate.
  * ──────────────────────────────────────────────────────────────────── */
 
-static void hilbert_process(const float* in, RADE_COMP* out, int n,
-                            const float coeffs[], float hist[], int& pos,
-                            float delay[], int& dpos, int ntaps, int delay_n)
+template <typename Ready>
+void RadaeDecoder::wait(Gate& gate, Ready ready)
 {
-    for (int i = 0; i < n; i++) {
-        float sample = in[i];
-
-        /* store in history ring buffer */
-        hist[pos] = sample;
-
-        /* FIR convolution for imaginary part */
-        float imag = 0.0f;
-        for (int k = 0; k < ntaps; k++) {
-            int idx = pos - k;
-            if (idx < 0) idx += ntaps;
-            imag += coeffs[k] * hist[idx];
-        }
+    std::unique_lock<std::mutex> lock(gate.mutex);
+    gate.cv.wait(lock, [&] {
+        return !running_.load(std::memory_order_relaxed) || ready();
+    });
+}
+
+void RadaeDecoder::wake(Gate& gate)
+{
+    { std::lock_guard<std::mutex> lock(gate.mutex); }
+    gate.cv.notify_all();
+}
+
+void RadaeDecoder::wake_all()
+{
+    for (Gate* g : {&capture_gate_, &latent_gate_, &feature_gate_, &speech_gate_})
+        wake(*g);
+}
 
-        /* delayed real part */
-        delay[dpos] = sample;
-        int read_pos = dpos - delay_n;
-        if (read_pos < 0) read_pos += ntaps;
-        out[i].real = delay[read_pos];
-        out[i].imag = imag;
+/* ── capture stage (dedicated thread) ────────────────────────────────
+ *
+ *  Only reads the device and fills capture_ring_, so it is back in read()
+ *  straight away whatever the later stages are doing.
+ * ──────────────────────────────────────────────────────────────────── */
 
-        pos = (pos + 1) % ntaps;
-        dpos = (dpos + 1) % ntaps;
+void RadaeDecoder::capture_loop()
+{
+    /* capture read buffer (the backend resamples to 8 kHz) */
+    constexpr int READ_FRAMES = 512;
+    std::vector<float> capture_buf(READ_FRAMES);
+
+    while (running_.load(std::memory_order_relaxed)) {
+        int ret = audio_in_->read(capture_buf.data(), READ_FRAMES);
+        if (ret < 0) {
+            if (running_.load(std::memory_order_relaxed))
+                fprintf(stderr, "Audio capture read error\n");
+            running_ = false;
+            wake_all();
+            break;
+        }
+
+        capture_ring_.write(capture_buf.data(), READ_FRAMES);
+        wake(capture_gate_);
     }
 }
 
-/* ── processing loop (dedicated thread) ──────────────────────────────── */
+/* ── modem stage (dedicated thread) ──────────────────────────────────
+ *
+ *  Input gain, spectrum, level and the RADE demodulator.  Pushes
+ *  one LatentFrame per modem frame, with or without latents, so the later
+ *  stages see sync loss and keep their level meters moving.
+ * ──────────────────────────────────────────────────────────────────── */
 
-void RadaeDecoder::processing_loop()
+void RadaeDecoder::modem_loop()
 {
-    int nin_max        = rade_nin_max(rade_);
-    int n_features_out = rade_n_features_in_out(rade_);
-    int n_eoo_bits     = rade_n_eoo_bits(rade_);
+    int nin_max    = rade_nin_max(rade_);
+    int n_eoo_bits = rade_n_eoo_bits(rade_);
 
     /* allocate working buffers */
-    std::vector<RADE_COMP> rx_buf(static_cast<size_t>(nin_max));
-    std::vector<float>     feat_buf(static_cast<size_t>(n_features_out));
-    std::vector<float>     eoo_buf(static_cast<size_t>(n_eoo_bits));
-
-    /* accumulation buffer for 8 kHz mono float samples */
-    std::vector<float> acc_8k;
-    acc_8k.reserve(static_cast<size_t>(nin_max * 2));
+    std::vector<float> eoo_buf(static_cast<size_t>(n_eoo_bits));
 
-    /* capture read buffer (already at 8 kHz from PulseAudio) */
-    constexpr int READ_FRAMES = 512;
-    std::vector<float> capture_buf(READ_FRAMES);
+    /* one modem frame of 8 kHz input: ring wrap-around copy, then gain */
+    std::vector<float> frame_8k(static_cast<size_t>(nin_max));
+    std::vector<float> wrap_8k(static_cast<size_t>(nin_max));
 
     bool was_synced = false;
-    bool output_primed = false;
 
     while (running_.load(std::memory_order_relaxed)) {
 
-        int nin = rade_nin(rade_);
+        /* ── a free slot for this frame's output (backpressure) ──────── */
+        LatentFrame* out = latent_q_.claim();
+        if (!out) {
+            wait(latent_gate_, [this] { return latent_q_.claim() != nullptr; });
+            continue;
+        }
 
-        /* ── accumulate enough 8 kHz samples ─────────────────────────── */
-        while (static_cast<int>(acc_8k.size()) < nin &&
-               running_.load(std::memory_order_relaxed))
-        {
-            if (file_mode_) {
-                /* ── file mode: copy from pre-loaded buffer ───────── */
-                size_t remaining = file_audio_8k_.size() - file_pos_;
-                if (remaining == 0) {
-                    running_ = false;
-                    break;
-                }
-                size_t need  = static_cast<size_t>(nin) - acc_8k.size();
-                size_t chunk = std::min(need, remaining);
-                acc_8k.insert(acc_8k.end(),
-                              file_audio_8k_.begin() + static_cast<ptrdiff_t>(file_pos_),
-                              file_audio_8k_.begin() + static_cast<ptrdiff_t>(file_pos_ + chunk));
-                file_pos_ += chunk;
-            } else {
-                /* ── live mode: read from audio capture ───────────── */
-                int ret = audio_in_->read(capture_buf.data(), READ_FRAMES);
-                if (ret < 0) {
-                    if (!running_.load(std::memory_order_relaxed)) break;
-                    fprintf(stderr, "Audio capture read error\n");
-                    running_ = false;
-                    break;
-                }
-
-                /* Already at 8 kHz float32 — append directly */
-                acc_8k.insert(acc_8k.end(), capture_buf.begin(),
-                              capture_buf.begin() + READ_FRAMES);
+        int nin = rade_nin(rade_);
+        const float* in_8k;
+
+        /* ── next nin samples at 8 kHz ───────────────────────────────── */
+        if (file_mode_) {
+            /* ── file mode: the next block from the reader ────────── */
+            if (file_reader_.read(wrap_8k.data(), static_cast<size_t>(nin)) <
+                static_cast<size_t>(nin)) {
+                out->flags = FRAME_END;
+                latent_q_.publish();
+                wake(latent_gate_);
+                break;
             }
+            in_8k = wrap_8k.data();
+        } else {
+            /* ── live mode: wait for the capture thread ───────────── */
+            wait(capture_gate_, [&] {
+                return capture_ring_.available() >= static_cast<size_t>(nin);
+            });
+            if (!running_.load(std::memory_order_relaxed)) break;
+            in_8k = capture_ring_.peek(static_cast<size_t>(nin), wrap_8k.data());
         }
 
-        if (!running_.load(std::memory_order_relaxed)) break;
-
         /* ── record 8 kHz samples before gain ─────────────────────────── */
         if (recording_.load(std::memory_order_relaxed)) {
             std::vector<int16_t> rec_i16(static_cast<size_t>(nin));
             for (int i = 0; i < nin; i++) {
-                float s = acc_8k[static_cast<size_t>(i)] * 32768.0f;
+                float s = in_8k[i] * 32768.0f;
                 if (s > 32767.0f) s = 32767.0f;
                 if (s < -32768.0f) s = -32768.0f;
                 rec_i16[static_cast<size_t>(i)] = static_cast<int16_t>(s);
@@ -505,16 +425,17 @@ void RadaeDecoder::processing_loop()
             float gain = input_gain_.load(std::memory_order_relaxed);
             if (gain != 1.0f) {
                 for (int i = 0; i < nin; i++)
-                    acc_8k[static_cast<size_t>(i)] *= gain;
+                    frame_8k[static_cast<size_t>(i)] = in_8k[i] * gain;
+                in_8k = frame_8k.data();
             }
         }
 
-        /* ── FFT spectrum of input 8 kHz audio ───────────────────────── */
-        if (static_cast<int>(acc_8k.size()) >= FFT_SIZE) {
+        /* ── FFT spectrum of the newest input 8 kHz audio ────────────── */
+        if (nin >= FFT_SIZE) {
             std::complex<float> fft_buf[FFT_SIZE];
-            int offset = static_cast<int>(acc_8k.size()) - FFT_SIZE;
+            int offset = nin - FFT_SIZE;
             for (int i = 0; i < FFT_SIZE; i++)
-                fft_buf[i] = acc_8k[static_cast<size_t>(offset + i)] * fft_window_[i];
+                fft_buf[i] = in_8k[offset + i] * fft_window_[i];
 
             fft_radix2(fft_buf, FFT_SIZE);
 
@@ -535,24 +456,19 @@ void RadaeDecoder::processing_loop()
         {
             double sum2 = 0.0;
             for (int i = 0; i < nin; i++)
-                sum2 += static_cast<double>(acc_8k[static_cast<size_t>(i)])
-                      * static_cast<double>(acc_8k[static_cast<size_t>(i)]);
+                sum2 += static_cast<double>(in_8k[i]) * static_cast<double>(in_8k[i]);
             input_level_.store(std::sqrt(static_cast<float>(sum2 / nin)),
                                std::memory_order_relaxed);
         }
 
-        /* ── Hilbert transform: real 8 kHz → complex IQ ──────────────── */
-        hilbert_process(acc_8k.data(), rx_buf.data(), nin,
-                        hilbert_coeffs_, hilbert_hist_, hilbert_pos_,
-                        delay_buf_, delay_pos_, HILBERT_NTAPS, HILBERT_DELAY);
-
-        /* consume nin samples from accumulator */
-        acc_8k.erase(acc_8k.begin(), acc_8k.begin() + nin);
-
-        /* ── RADE Rx ─────────────────────────────────────────────────── */
+        /* ── RADE demodulator, straight from real 8 kHz audio ─────────── */
         int has_eoo = 0;
-        int n_out = rade_rx(rade_, feat_buf.data(), &has_eoo,
-                            eoo_buf.data(), rx_buf.data());
+        int valid = rade_rx_demod_frame_real(rade_, out->latents, &has_eoo,
+                                             eoo_buf.data(), in_8k);
+
+        /* release the nin input samples */
+        if (!file_mode_)
+            capture_ring_.consume(static_cast<size_t>(nin));
 
         /* update sync status */
         bool now_synced = (rade_sync(rade_) != 0);
@@ -565,81 +481,148 @@ void RadaeDecoder::processing_loop()
                                std::memory_order_relaxed);
         }
 
-        /* handle sync transitions */
-        if (was_synced && !now_synced) {
-            /* lost sync — reset FARGAN for next sync */
-            fargan_init(static_cast<FARGANState*>(fargan_));
-            fargan_ready_ = false;
-            warmup_count_ = 0;
-            output_primed = false;
-        }
+        out->flags = (valid ? FRAME_LATENTS : 0) |
+                     ((was_synced && !now_synced) ? FRAME_SYNC_LOST : 0);
         was_synced = now_synced;
 
-        /* ── synthesise decoded speech ───────────────────────────────── */
-        if (n_out > 0) {
-            int n_frames = n_out / RADE_NB_TOTAL_FEATURES;
-            double rms_sum = 0.0;
-            int    rms_n   = 0;
-
-            for (int fi = 0; fi < n_frames; fi++) {
-                float* feat = &feat_buf[static_cast<size_t>(fi * RADE_NB_TOTAL_FEATURES)];
-
-                /* ── FARGAN warmup: buffer first 5 frames ─────────────── */
-                if (!fargan_ready_) {
-                    std::memcpy(&warmup_buf_[warmup_count_ * NB_TOTAL_FEAT],
-                                feat,
-                                static_cast<size_t>(NB_TOTAL_FEAT) * sizeof(float));
-
-                    if (++warmup_count_ >= 5) {
-                        /* pack to NB_FEATURES stride for fargan_cont */
-                        float packed[5 * NB_FEATURES];
-                        for (int i = 0; i < 5; i++)
-                            std::memcpy(&packed[i * NB_FEATURES],
-                                        &warmup_buf_[i * NB_TOTAL_FEAT],
-                                        static_cast<size_t>(NB_FEATURES) * sizeof(float));
-
-                        float zeros[FARGAN_CONT_SAMPLES] = {};
-                        fargan_cont(static_cast<FARGANState*>(fargan_),
-                                    zeros, packed);
-                        fargan_ready_ = true;
-
-                        /* pre-fill output buffer with silence so it has
-                           enough headroom for the bursty write pattern */
-                        if (!output_primed) {
-                            int prefill = 2 * 12 * LPCNET_FRAME_SIZE;
-                            std::vector<float> silence(static_cast<size_t>(prefill), 0.0f);
-                            audio_out_->write(silence.data(), prefill);
-                            output_primed = true;
-                        }
-                    }
-                    continue;   /* warmup frames not synthesised */
-                }
-
-                /* ── synthesise one 10-ms speech frame ────────────────── */
-                float fpcm[LPCNET_FRAME_SIZE];
-                fargan_synthesize(static_cast<FARGANState*>(fargan_),
-                                  fpcm, feat);
-
-                /* accumulate RMS of output */
-                for (int s = 0; s < LPCNET_FRAME_SIZE; s++)
-                    rms_sum += static_cast<double>(fpcm[s]) * fpcm[s];
-                rms_n += LPCNET_FRAME_SIZE;
-
-                /* ── write 16 kHz speech to audio output ────────────────── */
-                if (running_.load(std::memory_order_relaxed)) {
-                    audio_out_->write(fpcm, LPCNET_FRAME_SIZE);
-                }
+        latent_q_.publish();
+        wake(latent_gate_);
+    }
+}
+
+/* ── neural decode stage (dedicated thread) ──────────────────────────── */
+
+void RadaeDecoder::decode_loop()
+{
+    while (running_.load(std::memory_order_relaxed)) {
+        /* this stage alone pops latent_q_ and claims from feature_q_, so
+           each condition holds once seen */
+        LatentFrame* in = latent_q_.front();
+        if (!in) {
+            wait(latent_gate_, [this] { return latent_q_.front() != nullptr; });
+            continue;
+        }
+        FeatureFrame* out = feature_q_.claim();
+        if (!out) {
+            wait(feature_gate_, [this] { return feature_q_.claim() != nullptr; });
+            continue;
+        }
+
+        out->flags      = in->flags;
+        out->n_features = (in->flags & FRAME_LATENTS)
+                        ? rade_rx_decode_frame(rade_, out->features, in->latents)
+                        : 0;
+        latent_q_.pop();
+        feature_q_.publish();
+        wake(latent_gate_);
+        wake(feature_gate_);
+
+        if (out->flags & FRAME_END) break;
+    }
+}
+
+/* ── FARGAN stage (dedicated thread) ─────────────────────────────────── */
+
+void RadaeDecoder::synth_loop()
+{
+    constexpr size_t PREFILL_SAMPLES = 2 * 12 * SpeechSynth::FRAME_SAMPLES;
+    std::vector<float> pcm(FEATURE_FLOATS / SpeechSynth::NB_TOTAL_FEAT * SpeechSynth::FRAME_SAMPLES);
+    output_primed_ = false;
+
+    /* waits for room rather than drop synthesised speech */
+    auto write_speech = [this](const float* in, size_t n) {
+        wait(speech_gate_, [&] { return speech_ring_.room() >= n; });
+        if (!running_.load(std::memory_order_relaxed)) return;
+        speech_ring_.write(in, n);
+        wake(speech_gate_);
+    };
+
+    while (running_.load(std::memory_order_relaxed)) {
+        FeatureFrame* in = feature_q_.front();
+        if (!in) {
+            wait(feature_gate_, [this] { return feature_q_.front() != nullptr; });
+            continue;
+        }
+
+        if (in->flags & FRAME_END) {
+            feature_q_.pop();
+            wake(feature_gate_);
+            speech_done_ = true;
+            wake(speech_gate_);
+            break;
+        }
+
+        if (in->n_features > 0) {
+            /* FARGAN warmup yields no speech for the first frames after a
+               reset; pre-fill the output with silence when it ends so
+               playback has headroom for the bursty write pattern */
+            bool was_ready = synth_.ready();
+            int  n_pcm     = synth_.synthesize(in->features, in->n_features, pcm.data());
+            if (!was_ready && synth_.ready() && !output_primed_) {
+                std::vector<float> silence(PREFILL_SAMPLES, 0.0f);
+                write_speech(silence.data(), silence.size());
+                output_primed_ = true;
             }
 
-            /* update output level */
-            if (rms_n > 0)
-                output_level_.store(
-                    static_cast<float>(std::sqrt(rms_sum / rms_n)),
-                    std::memory_order_relaxed);
+            /* ── hand 16 kHz speech to the playback stage ─────────────── */
+            if (n_pcm > 0) {
+                write_speech(pcm.data(), static_cast<size_t>(n_pcm));
+
+                /* update output level */
+                double rms_sum = 0.0;
+                for (int i = 0; i < n_pcm; i++)
+                    rms_sum += static_cast<double>(pcm[static_cast<size_t>(i)]) * pcm[static_cast<size_t>(i)];
+                output_level_.store(static_cast<float>(std::sqrt(rms_sum / n_pcm)),
+                                    std::memory_order_relaxed);
+            }
         } else {
             /* no decoded output this frame — decay level toward zero */
             float lvl = output_level_.load(std::memory_order_relaxed);
             output_level_.store(lvl * 0.9f, std::memory_order_relaxed);
         }
+
+        /* lost sync — this frame's features still belong to the over just
+           ended, so reset FARGAN after them, fresh for the next sync */
+        if (in->flags & FRAME_SYNC_LOST) {
+            synth_.reset(rade_arch(rade_));
+            output_primed_ = false;
+        }
+
+        feature_q_.pop();
+        wake(feature_gate_);
+    }
+}
+
+/* ── playback stage (dedicated thread) ───────────────────────────────
+ *
+ *  Blocks in the device write, so in file mode this is what paces the
+ *  whole pipeline: once the queues fill, every earlier stage waits on it.
+ * ──────────────────────────────────────────────────────────────────── */
+
+void RadaeDecoder::playback_loop()
+{
+    constexpr size_t WRITE_FRAMES = SpeechSynth::FRAME_SAMPLES;
+    float scratch[WRITE_FRAMES];
+
+    while (running_.load(std::memory_order_relaxed)) {
+        size_t n = std::min(speech_ring_.available(), WRITE_FRAMES);
+        if (n == 0) {
+            /* end of file once the synth stage is done and we've drained */
+            if (speech_done_.load(std::memory_order_acquire) &&
+                speech_ring_.available() == 0) {
+                running_ = false;
+                wake_all();
+                break;
+            }
+            wait(speech_gate_, [this] {
+                return speech_ring_.available() > 0 ||
+                       speech_done_.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+
+        audio_out_->write(speech_ring_.peek(n, scratch), static_cast<int>(n));
+        speech_ring_.consume(n);
+        wake(speech_gate_);
     }
 }
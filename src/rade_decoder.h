@@ -5,18 +5,32 @@
 #include <atomic>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
 #include "audio_backend.h"
+#include "sample_ring.h"
+#include "spsc_queue.h"
+#include "speech_synth.h"
+#include "wav_io.h"
 
 /* Forward declaration — avoids exposing RADE/FARGAN C headers in this header */
 struct rade;
 
 /* ── RadaeDecoder ──────────────────────────────────────────────────────────
  *
- *  Real-time RADAE decoder pipeline:
- *    PulseAudio capture → Hilbert → RADE Rx → FARGAN → PulseAudio playback
+ *  Real-time RADAE decoder pipeline, one thread per stage:
  *
- *  PulseAudio handles resampling (capture at 8 kHz, playback at 16 kHz).
- *  All processing runs on a dedicated thread.  Status is exposed via atomics.
+ *    capture ─ring→ modem Rx ─queue→ neural decode ─queue→ FARGAN ─ring→ playback
+ *
+ *  The modem stage runs spectrum → rade_rx_demod_frame_real(), the
+ *  decode stage rade_rx_decode_frame(), so demodulating frame n+1 overlaps
+ *  decoding and synthesising frame n.  Stages are joined by bounded
+ *  lock-free SPSC rings and queues; a stage whose output is full waits
+ *  (backpressure), except capture, which drops and counts samples rather
+ *  than stall the device.
+ *
+ *  The audio backends open capture and playback at the device's own rate
+ *  and convert to and from 8 kHz and 16 kHz with a Resampler.
+ *  Status and queue depths are exposed via atomics.
  * ──────────────────────────────────────────────────────────────────────── */
 
 class RadaeDecoder {
@@ -41,6 +55,18 @@ public:
     float get_input_gain()        const { return input_gain_.load(std::memory_order_relaxed); }
     float get_output_level_left() const { return output_level_.load(std::memory_order_relaxed); }
     float get_output_level_right()const { return output_level_.load(std::memory_order_relaxed); } // mono
+    size_t dropped_samples()      const { return capture_ring_.dropped(); }  // capture overruns
+
+    /* pipeline queue depths (thread-safe) ----------------------------------- */
+    enum PipelineQueue {
+        QUEUE_CAPTURE,      // 8 kHz input samples waiting for the modem
+        QUEUE_LATENTS,      // modem frames waiting for the neural decoder
+        QUEUE_FEATURES,     // feature frames waiting for FARGAN
+        QUEUE_SPEECH,       // 16 kHz speech samples waiting for playback
+        QUEUE_COUNT
+    };
+    size_t queue_depth(PipelineQueue q) const;        // now
+    size_t queue_high_water(PipelineQueue q) const;   // deepest since start()
 
     /* spectrum (thread-safe via mutex) --------------------------------------- */
     static constexpr int FFT_SIZE      = 512;
@@ -50,13 +76,31 @@ public:
     int  spectrum_bins()          const { return SPECTRUM_BINS; }
     float spectrum_sample_rate()  const { return 8000.f; } // always at modem rate
 
+    /* acquisition worker threads, shared by all decoders (0 = off) ---------- */
+    void set_worker_threads(int n)      { worker_threads_ = n; }   // before open()
+    int  get_worker_threads()     const { return worker_threads_; }
+
     /* recording raw capture to disk ----------------------------------------- */
     void start_recording(const std::string& path);
     void stop_recording();
     bool is_recording() const { return recording_.load(std::memory_order_relaxed); }
 
 private:
-    void processing_loop();
+    void capture_loop();
+    void modem_loop();
+    void decode_loop();
+    void synth_loop();
+    void playback_loop();
+
+    /* sleeping on one stage queue: each has its own gate, waited on by the
+       stages at both ends (see wait() in rade_decoder.cpp) */
+    struct Gate {
+        std::mutex              mutex;
+        std::condition_variable cv;
+    };
+    template <typename Ready> void wait(Gate& gate, Ready ready);
+    void wake(Gate& gate);
+    void wake_all();
 
     /* ── Audio streams (platform-specific backend) ───────────────────────── */
     std::unique_ptr<AudioCapture>  audio_in_;
@@ -64,34 +108,52 @@ private:
 
     /* ── RADE receiver (opaque) ───────────────────────────────────────────── */
     struct rade*  rade_     = nullptr;
+    int           worker_threads_ = 0;
 
-    /* ── FARGAN vocoder (opaque void* to avoid C header in .h) ────────────── */
-    void*         fargan_   = nullptr;
-
-    /* ── Hilbert transform (127-tap FIR) ──────────────────────────────────── */
-    static constexpr int HILBERT_NTAPS = 127;
-    static constexpr int HILBERT_DELAY = (HILBERT_NTAPS - 1) / 2;  /* 63 */
-    float hilbert_coeffs_[HILBERT_NTAPS] = {};
-    float hilbert_hist_[HILBERT_NTAPS]   = {};   // history for FIR
-    int   hilbert_pos_                   = 0;    // write position in history
-
-    /* ── FARGAN warmup state ──────────────────────────────────────────────── */
-    static constexpr int NB_TOTAL_FEAT = 36;
-    bool  fargan_ready_    = false;
-    int   warmup_count_    = 0;
-    float warmup_buf_[5 * 36] = {};   // 5 frames × NB_TOTAL_FEATURES
-
-    /* ── Delay buffer for Hilbert real part ────────────────────────────────── */
-    float delay_buf_[HILBERT_NTAPS] = {};
-    int   delay_pos_                = 0;
+    /* ── FARGAN vocoder (synth stage) ──────────────────────────────────────── */
+    SpeechSynth   synth_;
+    bool          output_primed_ = false;
 
     /* ── FFT / spectrum ────────────────────────────────────────────────────── */
     float              fft_window_[FFT_SIZE]      = {};
     float              spectrum_mag_[SPECTRUM_BINS] = {};   // dB magnitudes
     mutable std::mutex spectrum_mutex_;
 
-    /* ── Thread & atomics ─────────────────────────────────────────────────── */
-    std::thread        thread_;
+    /* ── Pipeline frames (sizes checked against the RADE API at start()) ─── */
+    static constexpr int LATENT_FRAME_FLOATS = 3 * 80 + 1;            // rade_n_latent_frame()
+    static constexpr int FEATURE_FLOATS      = 3 * 4 * SpeechSynth::NB_TOTAL_FEAT; // rade_n_features_in_out()
+    enum : int { FRAME_LATENTS = 1, FRAME_SYNC_LOST = 2, FRAME_END = 4 };
+
+    struct LatentFrame {                          // one per modem frame
+        int   flags = 0;
+        float latents[LATENT_FRAME_FLOATS] = {};
+    };
+    struct FeatureFrame {
+        int   flags      = 0;
+        int   n_features = 0;
+        float features[FEATURE_FLOATS] = {};
+    };
+
+    /* ── Stage hand-off ───────────────────────────────────────────────────── */
+    static constexpr int RING_SAMPLES   = 2 * 8000;   // 2 s of capture slack at 8 kHz
+    static constexpr int QUEUE_FRAMES   = 4;          // modem frames between stages
+    static constexpr int SPEECH_SAMPLES = 8192;       // ~0.5 s of speech at 16 kHz
+    SampleRing                capture_ring_;
+    SpscQueue<LatentFrame>    latent_q_;
+    SpscQueue<FeatureFrame>   feature_q_;
+    SampleRing                speech_ring_;
+    std::atomic<bool>         speech_done_ {false};   // synth stage saw FRAME_END
+    Gate                      capture_gate_;
+    Gate                      latent_gate_;
+    Gate                      feature_gate_;
+    Gate                      speech_gate_;
+
+    /* ── Threads & atomics ────────────────────────────────────────────────── */
+    std::thread        capture_thread_;
+    std::thread        thread_;                   // modem Rx
+    std::thread        decode_thread_;
+    std::thread        synth_thread_;
+    std::thread        playback_thread_;
     std::atomic<bool>  running_     {false};
     std::atomic<bool>  synced_      {false};
     std::atomic<float> snr_dB_      {0.0f};
@@ -107,6 +169,5 @@ private:
 
     /* ── File playback mode ────────────────────────────────────────────── */
     bool                file_mode_      = false;
-    std::vector<float>  file_audio_8k_;          // pre-loaded 8 kHz mono audio
-    size_t              file_pos_       = 0;      // read position in file_audio_8k_
+    WavReader           file_reader_;            // streams the file at 8 kHz
 };
@@ -73,13 +73,34 @@ extern "C" {
 
 /* BPF parameters */
 #define RADE_BPF_NTAP           101     /* BPF filter taps */
+#define RADE_BPF_BLOCK          (RADE_NMF + RADE_M) /* BPF samples per block, the longest nin */
+#define RADE_BPF_NCO_LEN        RADE_NMF /* BPF mixer period, centre rounded to Fs/RADE_BPF_NCO_LEN */
+
+/* NCO (recursive phasor shared by the mixers) */
+#define RADE_NCO_LANES          8       /* Phasors advanced together by one rotation */
+#define RADE_NCO_RESEED         256     /* Max samples between exact reseeds from the phase */
+
+/* Hilbert transform (real input to complex) */
+#define RADE_HILBERT_NTAP       127     /* FIR taps, only odd offsets from the centre are non-zero */
+#define RADE_HILBERT_DELAY      ((RADE_HILBERT_NTAP-1)/2)  /* Real part delay = 63 samples */
+#define RADE_HILBERT_NZ         ((RADE_HILBERT_NTAP+1)/2)  /* Non-zero taps = 64 */
 
 /* Acquisition parameters */
 #define RADE_ACQ_FRANGE         100.0f  /* Frequency search range (Hz) */
 #define RADE_ACQ_FSTEP          2.5f    /* Frequency search step (Hz) */
-#define RADE_ACQ_NFREQ          40      /* Number of frequency search steps */
+#define RADE_ACQ_FRANGE_WIDE    2000.0f /* Wide frequency search range (Hz), RADE_ACQ_WIDE */
+#define RADE_ACQ_FSTEP_WIDE     12.5f   /* Wide search step (Hz), a quarter of the pilots' Fs/M */
+#define RADE_ACQ_NFREQ          160     /* Max frequency search steps, the larger of
+                                           FRANGE/FSTEP and FRANGE_WIDE/FSTEP_WIDE */
+#define RADE_ACQ_NFFT           1600    /* Acquisition correlation FFT size, Fs/(2*FSTEP) so each
+                                           search frequency is a whole or half bin */
 #define RADE_ACQ_PACQ_ERR1      0.00001f /* Acquisition error probability 1 */
+#define RADE_ACQ_PACQ_FRANGE    100.0f  /* Search range ERR1 is set for (Hz), scaled for wider */
 #define RADE_ACQ_PACQ_ERR2      0.0001f  /* Acquisition error probability 2 */
+#define RADE_ACQ_SEED           1       /* Grid refresh generator seed, any non zero value */
+#define RADE_ACQ_TDEC           4       /* Coarse search timing step (samples), divides Nmf and NFFT */
+#define RADE_ACQ_FDEC           4       /* Coarse search frequency step (in RADE_ACQ_FSTEPs, 10 Hz) */
+#define RADE_ACQ_NCAND          4       /* Coarse peaks searched again at full resolution */
 
 /* Receiver state machine */
 #define RADE_STATE_SEARCH       0
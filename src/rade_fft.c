@@ -0,0 +1,275 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_fft.c
+
+  Mixed radix complex FFT for RADAE C implementation. The factoring,
+  recursive work function and butterflies follow KISS FFT by Mark
+  Borgerding, whose license is below.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/*
+  KISS FFT, Copyright (c) 2003-2010, Mark Borgerding
+
+  All rights reserved.
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  - Neither the author nor the names of any contributors may be used to
+  endorse or promote products derived from this software without
+  specific prior written permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "rade_fft.h"
+#include <assert.h>
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+/* Factor n into radix 4 stages first, then 2, 3, 5 and any remaining odd
+   primes. Each stage stores (radix, remaining length). */
+static void fft_factor(int n, int *factors) {
+    int p = 4;
+    int nfactors = 0;
+    double floor_sqrt = floor(sqrt((double)n));
+
+    do {
+        while (n % p) {
+            switch (p) {
+                case 4: p = 2; break;
+                case 2: p = 3; break;
+                default: p += 2; break;
+            }
+            if (p > floor_sqrt) {
+                p = n;
+            }
+        }
+        n /= p;
+        assert(nfactors < RADE_FFT_MAXFACTORS);
+        factors[2 * nfactors] = p;
+        factors[2 * nfactors + 1] = n;
+        nfactors++;
+    } while (n > 1);
+}
+
+void rade_fft_init(rade_fft *fft, RADE_COMP *twiddles, int n) {
+    assert(n > 0);
+
+    fft->n = n;
+    for (int k = 0; k < n; k++) {
+        /* double precision angle so large transforms keep accurate twiddles */
+        double phase = -2.0 * M_PI * (double)k / (double)n;
+        twiddles[k] = rade_cmplx((float)cos(phase), (float)sin(phase));
+    }
+    fft->twiddles = twiddles;
+
+    fft_factor(n, fft->factors);
+}
+
+/*---------------------------------------------------------------------------*\
+                              BUTTERFLIES
+\*---------------------------------------------------------------------------*/
+
+/* Twiddle lookup, conjugated for the inverse transform */
+static inline RADE_COMP fft_tw(const rade_fft *fft, int k, int inverse) {
+    RADE_COMP t = fft->twiddles[k];
+    if (inverse) t.imag = -t.imag;
+    return t;
+}
+
+static void fft_bfly2(RADE_COMP *Fout, int fstride, const rade_fft *fft, int m, int inverse) {
+    RADE_COMP *Fout2 = Fout + m;
+
+    for (int k = 0; k < m; k++) {
+        RADE_COMP t = rade_cmul(Fout2[k], fft_tw(fft, k * fstride, inverse));
+        Fout2[k] = rade_csub(Fout[k], t);
+        Fout[k] = rade_cadd(Fout[k], t);
+    }
+}
+
+static void fft_bfly3(RADE_COMP *Fout, int fstride, const rade_fft *fft, int m, int inverse) {
+    float epi3 = fft_tw(fft, fstride * m, inverse).imag;
+
+    for (int k = 0; k < m; k++) {
+        RADE_COMP s1 = rade_cmul(Fout[k + m], fft_tw(fft, k * fstride, inverse));
+        RADE_COMP s2 = rade_cmul(Fout[k + 2 * m], fft_tw(fft, 2 * k * fstride, inverse));
+        RADE_COMP s3 = rade_cadd(s1, s2);
+        RADE_COMP s0 = rade_cscale(rade_csub(s1, s2), epi3);
+
+        RADE_COMP half = rade_csub(Fout[k], rade_cscale(s3, 0.5f));
+        Fout[k] = rade_cadd(Fout[k], s3);
+        Fout[k + 2 * m] = rade_cmplx(half.real + s0.imag, half.imag - s0.real);
+        Fout[k + m] = rade_cmplx(half.real - s0.imag, half.imag + s0.real);
+    }
+}
+
+static void fft_bfly4(RADE_COMP *Fout, int fstride, const rade_fft *fft, int m, int inverse) {
+    for (int k = 0; k < m; k++) {
+        RADE_COMP s0 = rade_cmul(Fout[k + m], fft_tw(fft, k * fstride, inverse));
+        RADE_COMP s1 = rade_cmul(Fout[k + 2 * m], fft_tw(fft, 2 * k * fstride, inverse));
+        RADE_COMP s2 = rade_cmul(Fout[k + 3 * m], fft_tw(fft, 3 * k * fstride, inverse));
+
+        RADE_COMP s5 = rade_csub(Fout[k], s1);
+        RADE_COMP f0 = rade_cadd(Fout[k], s1);
+        RADE_COMP s3 = rade_cadd(s0, s2);
+        RADE_COMP s4 = rade_csub(s0, s2);
+
+        Fout[k + 2 * m] = rade_csub(f0, s3);
+        Fout[k] = rade_cadd(f0, s3);
+
+        if (inverse) {
+            Fout[k + m] = rade_cmplx(s5.real - s4.imag, s5.imag + s4.real);
+            Fout[k + 3 * m] = rade_cmplx(s5.real + s4.imag, s5.imag - s4.real);
+        } else {
+            Fout[k + m] = rade_cmplx(s5.real + s4.imag, s5.imag - s4.real);
+            Fout[k + 3 * m] = rade_cmplx(s5.real - s4.imag, s5.imag + s4.real);
+        }
+    }
+}
+
+static void fft_bfly5(RADE_COMP *Fout, int fstride, const rade_fft *fft, int m, int inverse) {
+    RADE_COMP ya = fft_tw(fft, fstride * m, inverse);
+    RADE_COMP yb = fft_tw(fft, 2 * fstride * m, inverse);
+
+    for (int k = 0; k < m; k++) {
+        RADE_COMP s0 = Fout[k];
+        RADE_COMP s1 = rade_cmul(Fout[k + m], fft_tw(fft, k * fstride, inverse));
+        RADE_COMP s2 = rade_cmul(Fout[k + 2 * m], fft_tw(fft, 2 * k * fstride, inverse));
+        RADE_COMP s3 = rade_cmul(Fout[k + 3 * m], fft_tw(fft, 3 * k * fstride, inverse));
+        RADE_COMP s4 = rade_cmul(Fout[k + 4 * m], fft_tw(fft, 4 * k * fstride, inverse));
+
+        RADE_COMP s7 = rade_cadd(s1, s4);
+        RADE_COMP s10 = rade_csub(s1, s4);
+        RADE_COMP s8 = rade_cadd(s2, s3);
+        RADE_COMP s9 = rade_csub(s2, s3);
+
+        Fout[k] = rade_cadd(s0, rade_cadd(s7, s8));
+
+        RADE_COMP s5 = rade_cmplx(s0.real + s7.real * ya.real + s8.real * yb.real,
+                                  s0.imag + s7.imag * ya.real + s8.imag * yb.real);
+        RADE_COMP s6 = rade_cmplx(s10.imag * ya.imag + s9.imag * yb.imag,
+                                  -s10.real * ya.imag - s9.real * yb.imag);
+        Fout[k + m] = rade_csub(s5, s6);
+        Fout[k + 4 * m] = rade_cadd(s5, s6);
+
+        RADE_COMP s11 = rade_cmplx(s0.real + s7.real * yb.real + s8.real * ya.real,
+                                   s0.imag + s7.imag * yb.real + s8.imag * ya.real);
+        RADE_COMP s12 = rade_cmplx(-s10.imag * yb.imag + s9.imag * ya.imag,
+                                   s10.real * yb.imag - s9.real * ya.imag);
+        Fout[k + 2 * m] = rade_cadd(s11, s12);
+        Fout[k + 3 * m] = rade_csub(s11, s12);
+    }
+}
+
+/* Direct DFT butterfly for odd prime radix p */
+static void fft_bfly_generic(RADE_COMP *Fout, int fstride, const rade_fft *fft, int m, int p,
+                             int inverse) {
+    int n = fft->n;
+    RADE_COMP scratch[RADE_FFT_MAXRADIX];
+
+    assert(p <= RADE_FFT_MAXRADIX);
+
+    for (int u = 0; u < m; u++) {
+        for (int q1 = 0, k = u; q1 < p; q1++, k += m) {
+            scratch[q1] = Fout[k];
+        }
+
+        for (int q1 = 0, k = u; q1 < p; q1++, k += m) {
+            int twidx = 0;
+            Fout[k] = scratch[0];
+            for (int q = 1; q < p; q++) {
+                twidx += fstride * k;
+                if (twidx >= n) twidx -= n;
+                Fout[k] = rade_cadd(Fout[k], rade_cmul(scratch[q], fft_tw(fft, twidx, inverse)));
+            }
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                              PROCESSING
+\*---------------------------------------------------------------------------*/
+
+static void fft_work(RADE_COMP *Fout, const RADE_COMP *f, int fstride,
+                     const int *factors, const rade_fft *fft, int inverse) {
+    int p = factors[0];     /* radix of this stage */
+    int m = factors[1];     /* length of each sub-transform */
+
+    if (m == 1) {
+        for (int i = 0; i < p; i++) {
+            Fout[i] = f[i * fstride];
+        }
+    } else {
+        for (int i = 0; i < p; i++) {
+            fft_work(Fout + i * m, f + i * fstride, fstride * p, factors + 2, fft, inverse);
+        }
+    }
+
+    switch (p) {
+        case 2: fft_bfly2(Fout, fstride, fft, m, inverse); break;
+        case 3: fft_bfly3(Fout, fstride, fft, m, inverse); break;
+        case 4: fft_bfly4(Fout, fstride, fft, m, inverse); break;
+        case 5: fft_bfly5(Fout, fstride, fft, m, inverse); break;
+        default: fft_bfly_generic(Fout, fstride, fft, m, p, inverse); break;
+    }
+}
+
+void rade_fft_forward(const rade_fft *fft, RADE_COMP *out, const RADE_COMP *in) {
+    assert(out != in);
+    fft_work(out, in, 1, fft->factors, fft, 0);
+}
+
+void rade_fft_inverse(const rade_fft *fft, RADE_COMP *out, const RADE_COMP *in) {
+    assert(out != in);
+    fft_work(out, in, 1, fft->factors, fft, 1);
+}
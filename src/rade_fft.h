@@ -0,0 +1,86 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_fft.h
+
+  Mixed radix complex FFT for RADAE C implementation, after KISS FFT
+  (see rade_fft.c for its license).
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_FFT__
+#define __RADE_FFT__
+
+#include "rade_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RADE_FFT_MAXFACTORS     32      /* Max number of radix stages */
+#define RADE_FFT_MAXRADIX       32      /* Max prime factor for generic butterfly */
+
+/*---------------------------------------------------------------------------*\
+                              FFT STATE
+\*---------------------------------------------------------------------------*/
+
+/* Decimation in time FFT, radix 4, 2, 3, 5 and generic odd radix butterflies.
+   Twiddle table storage (n entries) is owned by the caller so the FFT can be
+   embedded in fixed size state structs without allocation. */
+typedef struct {
+    int n;                                      /* Transform length */
+    int factors[2 * RADE_FFT_MAXFACTORS];       /* (radix, stage length) pairs */
+    const RADE_COMP *twiddles;                  /* exp(-j*2*pi*k/n), k = 0..n-1 */
+} rade_fft;
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+/* Initialize FFT of length n
+   twiddles: caller provided storage for n complex values, filled here */
+void rade_fft_init(rade_fft *fft, RADE_COMP *twiddles, int n);
+
+/*---------------------------------------------------------------------------*\
+                              PROCESSING
+\*---------------------------------------------------------------------------*/
+
+/* Forward transform: out[k] = sum(in[n] * exp(-j*2*pi*k*n/N))
+   in and out must not overlap */
+void rade_fft_forward(const rade_fft *fft, RADE_COMP *out, const RADE_COMP *in);
+
+/* Inverse transform: out[n] = sum(in[k] * exp(j*2*pi*k*n/N))
+   Unscaled, caller applies 1/N if required. in and out must not overlap */
+void rade_fft_inverse(const rade_fft *fft, RADE_COMP *out, const RADE_COMP *in);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_FFT__ */
@@ -0,0 +1,88 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_hilbert.c
+
+  Hilbert transformer for RADAE.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "rade_hilbert.h"
+#include "rade_vec.h"
+#include <string.h>
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+void rade_hilbert_init(rade_hilbert *h) {
+    /* Tap i of the full filter is 2/(pi*n) times a Hamming window, n = i -
+       centre, and zero for even n; the non-zero ones are the even i.  Tap
+       2j applies to the sample 2j back, stored reversed for the dot */
+    for (int j = 0; j < RADE_HILBERT_NZ; j++) {
+        int i = 2 * j;
+        int n = i - RADE_HILBERT_DELAY;
+        float w = 0.54f - 0.46f * cosf(2.0f * M_PI * i / (RADE_HILBERT_NTAP - 1));
+        h->h_rev[RADE_HILBERT_NZ - 1 - j] = 2.0f / (M_PI * n) * w;
+    }
+    rade_hilbert_reset(h);
+}
+
+void rade_hilbert_reset(rade_hilbert *h) {
+    memset(h->mem, 0, sizeof(h->mem));
+    h->pos[0] = h->pos[1] = 0;
+    h->phase = 0;
+}
+
+/*---------------------------------------------------------------------------*\
+                              PROCESSING
+\*---------------------------------------------------------------------------*/
+
+void rade_hilbert_process(rade_hilbert *h, RADE_COMP *y, const float *x, int n) {
+    int p = h->phase;
+
+    for (int i = 0; i < n; i++) {
+        /* Newest sample in at both copies, the window then starts one on */
+        float *mem = h->mem[p];
+        int pos = h->pos[p];
+        mem[pos] = mem[pos + RADE_HILBERT_NZ] = x[i];
+        if (++pos == RADE_HILBERT_NZ) pos = 0;
+        h->pos[p] = pos;
+
+        y[i].imag = rade_vec_dot(h->h_rev, &mem[pos], RADE_HILBERT_NZ);
+
+        /* The other stream's newest sample is x[i-1], so the sample
+           RADE_HILBERT_DELAY back is (RADE_HILBERT_DELAY-1)/2 before that,
+           half way along its window */
+        y[i].real = h->mem[p ^ 1][h->pos[p ^ 1] + RADE_HILBERT_NZ / 2];
+
+        p ^= 1;
+    }
+    h->phase = p;
+}
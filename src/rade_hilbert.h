@@ -0,0 +1,87 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_hilbert.h
+
+  Hilbert transformer for RADAE: real modem input to the complex signal
+  the receiver expects.  Half-band form, only the non-zero taps are run.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_HILBERT__
+#define __RADE_HILBERT__
+
+#include "rade_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*\
+                            HILBERT STATE
+\*---------------------------------------------------------------------------*/
+
+/* The RADE_HILBERT_NTAP tap FIR is zero at every even offset from its
+   centre, so each output only uses input samples of its own parity.  The
+   history is kept as two streams, even and odd samples, each stored twice
+   so the last RADE_HILBERT_NZ samples of a stream are always contiguous
+   for one vector dot.  The real part, the input delayed by
+   RADE_HILBERT_DELAY (odd), is read straight from the other stream. */
+typedef struct {
+    float h_rev[RADE_HILBERT_NZ];           /* Non-zero taps, oldest sample first */
+    float mem[2][2 * RADE_HILBERT_NZ];      /* Sample history by parity, mirrored */
+    int pos[2];                             /* Oldest sample of each stream */
+    int phase;                              /* Stream the next sample goes to */
+} rade_hilbert;
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+/* Design the filter (Hamming windowed) and clear the history */
+void rade_hilbert_init(rade_hilbert *h);
+
+/* Clear the history only */
+void rade_hilbert_reset(rade_hilbert *h);
+
+/*---------------------------------------------------------------------------*\
+                              PROCESSING
+\*---------------------------------------------------------------------------*/
+
+/* Real samples to complex
+   y: n output samples, .real the input delayed by RADE_HILBERT_DELAY and
+      .imag the Hilbert transform lined up with it
+   x: n input samples */
+void rade_hilbert_process(rade_hilbert *h, RADE_COMP *y, const float *x, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_HILBERT__ */
@@ -0,0 +1,113 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_nco.c
+
+  Numerically controlled oscillator for RADAE.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "rade_nco.h"
+#include "rade_vec.h"
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+void rade_nco_init(rade_nco *nco, float w) {
+    nco->phase = 0.0;
+    rade_nco_set_freq(nco, w);
+}
+
+void rade_nco_set_freq(rade_nco *nco, float w) {
+    nco->w = w;
+
+    /* Lanes from one double rotation, each rounded to float once */
+    double c1 = cos(nco->w), s1 = sin(nco->w);
+    double re = 1.0, im = 0.0;
+    for (int k = 0; k < RADE_NCO_LANES; k++) {
+        nco->lane_re[k] = (float)re;
+        nco->lane_im[k] = (float)im;
+        double t = re * c1 - im * s1;
+        im = re * s1 + im * c1;
+        re = t;
+    }
+    nco->step = rade_cmplx((float)re, (float)im);
+}
+
+void rade_nco_set_phase(rade_nco *nco, double phase) {
+    nco->phase = remainder(phase, 2.0 * M_PI);
+}
+
+/*---------------------------------------------------------------------------*\
+                              GENERATION
+\*---------------------------------------------------------------------------*/
+
+void rade_nco_gen(rade_nco *nco, RADE_COMP *y, int n) {
+    float y_re[RADE_NCO_RESEED + RADE_NCO_LANES];
+    float y_im[RADE_NCO_RESEED + RADE_NCO_LANES];
+
+    for (int i0 = 0; i0 < n; i0 += RADE_NCO_RESEED) {
+        int nb = (n - i0 < RADE_NCO_RESEED) ? n - i0 : RADE_NCO_RESEED;
+        float p_re = (float)cos(nco->phase);
+        float p_im = (float)sin(nco->phase);
+
+        /* Whole rotations, split so the lanes vectorise, the last one may
+           run past nb into the spare lanes */
+        for (int i = 0; i < nb; i += RADE_NCO_LANES) {
+            for (int k = 0; k < RADE_NCO_LANES; k++) {
+                y_re[i + k] = p_re * nco->lane_re[k] - p_im * nco->lane_im[k];
+                y_im[i + k] = p_re * nco->lane_im[k] + p_im * nco->lane_re[k];
+            }
+            float t = p_re * nco->step.real - p_im * nco->step.imag;
+            p_im = p_re * nco->step.imag + p_im * nco->step.real;
+            p_re = t;
+        }
+        rade_vec_join(&y[i0], y_re, y_im, nb);
+
+        nco->phase = remainder(nco->phase + nb * nco->w, 2.0 * M_PI);
+    }
+}
+
+void rade_nco_mix(rade_nco *nco, RADE_COMP *y, const RADE_COMP *x, int n) {
+    RADE_COMP phasors[RADE_NCO_RESEED];
+
+    for (int i0 = 0; i0 < n; i0 += RADE_NCO_RESEED) {
+        int nb = (n - i0 < RADE_NCO_RESEED) ? n - i0 : RADE_NCO_RESEED;
+        rade_nco_gen(nco, phasors, nb);
+        rade_vec_cmul(&y[i0], &x[i0], phasors, nb);
+    }
+}
+
+void rade_nco_table(RADE_COMP *y, int cycles, int period, int n) {
+    for (int k = 0; k < n; k++) {
+        double theta = 2.0 * M_PI * (double)((long)cycles * k % period) / period;
+        y[k] = rade_cmplx((float)cos(theta), (float)sin(theta));
+    }
+}
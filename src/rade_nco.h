@@ -0,0 +1,91 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_nco.h
+
+  Numerically controlled oscillator for RADAE: the phasors used by the
+  frequency corrector, the acquisition correlators and the BPF mixer.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_NCO__
+#define __RADE_NCO__
+
+#include "rade_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*\
+                              NCO STATE
+\*---------------------------------------------------------------------------*/
+
+/* The phase is kept in double and only read once per RADE_NCO_RESEED
+   samples, to seed a float recursion: RADE_NCO_LANES phasors exp(j*w*k)
+   rotated together by exp(j*w*RADE_NCO_LANES).  The recursion error never
+   grows past one reseed interval and the double phase doesn't drift, so
+   the output holds its accuracy however long the oscillator runs. */
+typedef struct {
+    double phase;                           /* Phase of the next sample, radians */
+    double w;                               /* Frequency, radians per sample */
+    float lane_re[RADE_NCO_LANES];          /* exp(j*w*k), k < RADE_NCO_LANES */
+    float lane_im[RADE_NCO_LANES];
+    RADE_COMP step;                         /* exp(j*w*RADE_NCO_LANES) */
+} rade_nco;
+
+/*---------------------------------------------------------------------------*\
+                              FUNCTIONS
+\*---------------------------------------------------------------------------*/
+
+/* Start at phase 0, w radians per sample */
+void rade_nco_init(rade_nco *nco, float w);
+
+/* Change frequency, the phase carries on from where it is */
+void rade_nco_set_freq(rade_nco *nco, float w);
+
+/* Phase of the next sample, radians */
+void rade_nco_set_phase(rade_nco *nco, double phase);
+
+/* y[k] = exp(j*(phase + w*k)) for k < n, then advance the phase by n */
+void rade_nco_gen(rade_nco *nco, RADE_COMP *y, int n);
+
+/* y = x times the next n phasors, y may be x */
+void rade_nco_mix(rade_nco *nco, RADE_COMP *y, const RADE_COMP *x, int n);
+
+/* Table of an exactly periodic oscillator, y[k] = exp(j*2*pi*cycles*k/period)
+   for k < n, each angle reduced in integers so every entry is exact to float
+   precision and the table repeats exactly every period samples */
+void rade_nco_table(RADE_COMP *y, int cycles, int period, int n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_NCO__ */
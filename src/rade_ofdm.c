@@ -34,6 +34,7 @@
 */
 
 #include "rade_ofdm.h"
+#include "rade_vec.h"
 #include <string.h>
 #include <assert.h>
 
@@ -75,12 +76,14 @@ void rade_ofdm_init(rade_ofdm *ofdm, int bottleneck) {
         }
     }
 
-    /* Compute DFT matrix (Rx): Wfwd[n][c] = exp(-j*w[c]*n)
-       time_in[M] * Wfwd[M][Nc] -> freq_out[Nc] */
-    for (int n = 0; n < M; n++) {
-        for (int c = 0; c < Nc; c++) {
+    /* Compute DFT matrix (Rx): Wfwd[c][n] = exp(-j*w[c]*n)
+       Wfwd[Nc][M] . time_in[M] -> freq_out[Nc] */
+    for (int c = 0; c < Nc; c++) {
+        for (int n = 0; n < M; n++) {
             float theta = -ofdm->w[c] * n;
-            ofdm->Wfwd[n][c] = rade_cexp(theta);
+            RADE_COMP W = rade_cexp(theta);
+            ofdm->Wfwd_re[c][n] = W.real;
+            ofdm->Wfwd_im[c][n] = W.imag;
         }
     }
 
@@ -201,6 +204,17 @@ void rade_ofdm_init(rade_ofdm *ofdm, int bottleneck) {
                 }
             }
         }
+
+        /* The fit's delay term at this carrier */
+        ofdm->est_rot[c] = rade_cexp(-ofdm->w[c] * a);
+    }
+
+    /* Fast math is off unless the caller selects it, the reciprocals are
+       there either way */
+    ofdm->fast_math = 0;
+    for (int c = 0; c < Nc; c++) {
+        ofdm->P_inv[c] = rade_cdiv(rade_cone(), ofdm->P[c]);
+        ofdm->Pend_inv[c] = rade_cdiv(rade_cone(), ofdm->Pend[c]);
     }
 }
 
@@ -328,14 +342,35 @@ void rade_ofdm_dft(const rade_ofdm *ofdm, RADE_COMP *freq_out, const RADE_COMP *
     int M = ofdm->m;
     int Nc = ofdm->nc;
 
+    float x_re[RADE_M], x_im[RADE_M];
+    rade_vec_split(x_re, x_im, time_in, M);
+
     for (int c = 0; c < Nc; c++) {
-        freq_out[c] = rade_czero();
-        for (int n = 0; n < M; n++) {
-            freq_out[c] = rade_cadd(freq_out[c], rade_cmul(time_in[n], ofdm->Wfwd[n][c]));
-        }
+        freq_out[c] = rade_vec_cdot(x_re, x_im, ofdm->Wfwd_re[c], ofdm->Wfwd_im[c], M);
     }
 }
 
+/* DFT of every symbol in a modem frame as one matrix product:
+   rx_sym[Ns+2][Nc] = time[Ns+2][M] * Wfwd[Nc][M]^T */
+void rade_ofdm_dft_frame(const rade_ofdm *ofdm, RADE_COMP *rx_sym, const RADE_COMP *rx_in,
+                         int time_offset) {
+    int M = ofdm->m;
+    int Ncp = ofdm->ncp;
+    int Nsym = ofdm->ns + 2;
+
+    float x_re[(RADE_NS + 2) * RADE_M];
+    float x_im[(RADE_NS + 2) * RADE_M];
+
+    /* Remove the cyclic prefix of each symbol while splitting */
+    for (int s = 0; s < Nsym; s++) {
+        int sample_offset = s * (M + Ncp) + Ncp + time_offset;
+        rade_vec_split(&x_re[s * M], &x_im[s * M], &rx_in[sample_offset], M);
+    }
+
+    rade_vec_cmatmul(rx_sym, x_re, x_im, Nsym,
+                     &ofdm->Wfwd_re[0][0], &ofdm->Wfwd_im[0][0], ofdm->nc, M);
+}
+
 /* Remove cyclic prefix with time offset adjustment */
 void rade_ofdm_remove_cp(const rade_ofdm *ofdm, RADE_COMP *time_out, const RADE_COMP *time_in, int time_offset) {
     int M = ofdm->m;
@@ -351,8 +386,6 @@ void rade_ofdm_remove_cp(const rade_ofdm *ofdm, RADE_COMP *time_out, const RADE_
 void rade_ofdm_est_pilots(const rade_ofdm *ofdm, RADE_COMP *pilot_est,
                           const RADE_COMP *rx_pilots, int num_pilots) {
     int Nc = ofdm->nc;
-    float Fs = (float)RADE_FS;
-    float a = ofdm->local_path_delay_s * Fs;
 
     for (int p = 0; p < num_pilots; p++) {
         const RADE_COMP *rx_p = &rx_pilots[p * Nc];
@@ -366,7 +399,11 @@ void rade_ofdm_est_pilots(const rade_ofdm *ofdm, RADE_COMP *pilot_est,
             /* h = rx_p / P (element-wise for 3 neighboring carriers) */
             RADE_COMP h[3];
             for (int i = 0; i < 3; i++) {
-                h[i] = rade_cdiv(rx_p[c_mid - 1 + i], ofdm->P[c_mid - 1 + i]);
+                if (ofdm->fast_math) {
+                    h[i] = rade_cmul(rx_p[c_mid - 1 + i], ofdm->P_inv[c_mid - 1 + i]);
+                } else {
+                    h[i] = rade_cdiv(rx_p[c_mid - 1 + i], ofdm->P[c_mid - 1 + i]);
+                }
             }
 
             /* g = Pmat * h (2x3 * 3x1 = 2x1) */
@@ -379,7 +416,7 @@ void rade_ofdm_est_pilots(const rade_ofdm *ofdm, RADE_COMP *pilot_est,
             }
 
             /* Channel estimate at carrier c: h_c = g[0] + g[1]*exp(-j*w[c]*a) */
-            est_p[c] = rade_cadd(g[0], rade_cmul(g[1], rade_cexp(-ofdm->w[c] * a)));
+            est_p[c] = rade_cadd(g[0], rade_cmul(g[1], ofdm->est_rot[c]));
         }
     }
 }
@@ -399,6 +436,10 @@ float rade_ofdm_pilot_eq(const rade_ofdm *ofdm, RADE_COMP *rx_sym,
        S1 = signal power from received pilot symbols
        S2 = noise power from phase-corrected received pilots */
     float S1 = 0.0f, S2 = 0.0f;
+    RADE_COMP Rcn_hat[RADE_NC];
+    if (ofdm->fast_math) {
+        rade_vec_derotate(Rcn_hat, rx_pilots_start, pilot_est_start, Nc);
+    }
     for (int c = 0; c < Nc; c++) {
         /* S1: signal power from received pilot symbols (not channel estimate!) */
         float mag2 = rade_cabs2(rx_pilots_start[c]);
@@ -406,9 +447,11 @@ float rade_ofdm_pilot_eq(const rade_ofdm *ofdm, RADE_COMP *rx_sym,
 
         /* S2: noise estimate from phase-corrected received pilots
            Use phase from channel estimate to correct received pilots */
-        float rx_phase = rade_cangle(pilot_est_start[c]);
-        RADE_COMP Rcn_hat = rade_cmul(rx_pilots_start[c], rade_cexp(-rx_phase));
-        S2 += Rcn_hat.imag * Rcn_hat.imag;
+        if (!ofdm->fast_math) {
+            float rx_phase = rade_cangle(pilot_est_start[c]);
+            Rcn_hat[c] = rade_cmul(rx_pilots_start[c], rade_cexp(-rx_phase));
+        }
+        S2 += Rcn_hat[c].imag * Rcn_hat[c].imag;
     }
     S2 += 1e-12f;  /* Avoid division by zero */
     float snr_est = S1 / (2.0f * S2) - 1.0f;
@@ -426,19 +469,25 @@ float rade_ofdm_pilot_eq(const rade_ofdm *ofdm, RADE_COMP *rx_sym,
                      10.0f * log10f((float)(M + Ncp) / M);
 
     /* Linearly interpolate channel estimate between pilots and equalize */
+    RADE_COMP ch_est[RADE_NS * RADE_NC];
     for (int s = 0; s < Ns; s++) {
         /* Interpolation factor: pilot at 0, data at 1..Ns, pilot at Ns+1 */
         float t = (float)(s + 1) / (float)(Ns + 1);
 
         for (int c = 0; c < Nc; c++) {
             /* Interpolated channel estimate */
-            RADE_COMP ch_est = rade_clerp(pilot_est_start[c], pilot_est_end[c], t);
+            ch_est[s * Nc + c] = rade_clerp(pilot_est_start[c], pilot_est_end[c], t);
 
             /* Phase correction only */
-            float ch_angle = rade_cangle(ch_est);
-            rx_sym[s * Nc + c] = rade_cmul(rx_sym[s * Nc + c], rade_cexp(-ch_angle));
+            if (!ofdm->fast_math) {
+                float ch_angle = rade_cangle(ch_est[s * Nc + c]);
+                rx_sym[s * Nc + c] = rade_cmul(rx_sym[s * Nc + c], rade_cexp(-ch_angle));
+            }
         }
     }
+    if (ofdm->fast_math) {
+        rade_vec_derotate(rx_sym, rx_sym, ch_est, Ns * Nc);
+    }
 
     /* Coarse magnitude correction */
     if (coarse_mag) {
@@ -466,21 +515,18 @@ float rade_ofdm_pilot_eq(const rade_ofdm *ofdm, RADE_COMP *rx_sym,
 /* Demodulate one modem frame */
 int rade_ofdm_demod_frame(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_in,
                           int time_offset, int endofover, int coarse_mag, float *snr_est) {
-    int Nc = ofdm->nc;
-    int M = ofdm->m;
-    int Ncp = ofdm->ncp;
-    int Ns = ofdm->ns;
-
     /* Buffer for received symbols: pilot + Ns data + pilot = Ns+2 symbols */
-    RADE_COMP rx_sym[(RADE_NS + 2)][RADE_NC];
-    RADE_COMP time_buf[RADE_M];
+    RADE_COMP rx_sym[(RADE_NS + 2) * RADE_NC];
 
-    /* Demodulate all symbols in frame */
-    for (int s = 0; s < Ns + 2; s++) {
-        int sample_offset = s * (M + Ncp);
-        rade_ofdm_remove_cp(ofdm, time_buf, &rx_in[sample_offset], time_offset);
-        rade_ofdm_dft(ofdm, rx_sym[s], time_buf);
-    }
+    rade_ofdm_dft_frame(ofdm, rx_sym, rx_in, time_offset);
+    return rade_ofdm_demod_frame_spectra(ofdm, z_hat, rx_sym, endofover, coarse_mag, snr_est);
+}
+
+/* Demodulate one modem frame from its symbol spectra */
+int rade_ofdm_demod_frame_spectra(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_sym,
+                                  int endofover, int coarse_mag, float *snr_est) {
+    int Nc = ofdm->nc;
+    int Ns = ofdm->ns;
 
     if (!endofover) {
         /* Normal frame: estimate pilots and equalize */
@@ -488,15 +534,15 @@ int rade_ofdm_demod_frame(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *
 
         /* First pilot at symbol 0, second at symbol Ns+1 */
         RADE_COMP rx_pilots[2 * RADE_NC];
-        memcpy(&rx_pilots[0], rx_sym[0], sizeof(RADE_COMP) * Nc);
-        memcpy(&rx_pilots[Nc], rx_sym[Ns + 1], sizeof(RADE_COMP) * Nc);
+        memcpy(&rx_pilots[0], &rx_sym[0], sizeof(RADE_COMP) * Nc);
+        memcpy(&rx_pilots[Nc], &rx_sym[(Ns + 1) * Nc], sizeof(RADE_COMP) * Nc);
 
         rade_ofdm_est_pilots(ofdm, (RADE_COMP*)pilot_est, rx_pilots, 2);
 
         /* Equalize data symbols (symbols 1 to Ns) */
         RADE_COMP rx_data[RADE_NS * RADE_NC];
         for (int s = 0; s < Ns; s++) {
-            memcpy(&rx_data[s * Nc], rx_sym[s + 1], sizeof(RADE_COMP) * Nc);
+            memcpy(&rx_data[s * Nc], &rx_sym[(s + 1) * Nc], sizeof(RADE_COMP) * Nc);
         }
 
         *snr_est = rade_ofdm_pilot_eq(ofdm, rx_data, &rx_pilots[0], pilot_est[0], pilot_est[1], coarse_mag);
@@ -513,7 +559,7 @@ int rade_ofdm_demod_frame(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *
         return out_idx;
     } else {
         /* EOO frame - use simpler equalization */
-        return rade_ofdm_demod_eoo(ofdm, z_hat, rx_in, time_offset);
+        return rade_ofdm_demod_eoo_spectra(ofdm, z_hat, rx_sym);
     }
 }
 
@@ -525,33 +571,48 @@ const RADE_COMP* rade_ofdm_get_eoo(const rade_ofdm *ofdm, int *n_out) {
 
 /* Demodulate EOO frame */
 int rade_ofdm_demod_eoo(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_in, int time_offset) {
+    /* EOO frame structure: P E 0 0 0 E
+       Demodulate all Ns+2 symbols */
+    RADE_COMP rx_sym[(RADE_NS + 2) * RADE_NC];
+
+    rade_ofdm_dft_frame(ofdm, rx_sym, rx_in, time_offset);
+    return rade_ofdm_demod_eoo_spectra(ofdm, z_hat, rx_sym);
+}
+
+/* Demodulate EOO frame from its symbol spectra */
+int rade_ofdm_demod_eoo_spectra(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_sym_in) {
     int Nc = ofdm->nc;
-    int M = ofdm->m;
-    int Ncp = ofdm->ncp;
     int Ns = ofdm->ns;
 
-    /* EOO frame structure: P E 0 0 0 E
-       Demodulate all Ns+2 symbols */
+    /* Equalized in a local copy, the spectra may be shared with other callers */
     RADE_COMP rx_sym[(RADE_NS + 2)][RADE_NC];
-    RADE_COMP time_buf[RADE_M];
-
-    for (int s = 0; s < Ns + 2; s++) {
-        int sample_offset = s * (M + Ncp);
-        rade_ofdm_remove_cp(ofdm, time_buf, &rx_in[sample_offset], time_offset);
-        rade_ofdm_dft(ofdm, rx_sym[s], time_buf);
-    }
+    memcpy(rx_sym, rx_sym_in, sizeof(rx_sym));
 
     /* Simpler EQ: average phase from P, E1, E2 pilots */
-    for (int c = 0; c < Nc; c++) {
-        RADE_COMP sum = rade_czero();
-        sum = rade_cadd(sum, rade_cdiv(rx_sym[0][c], ofdm->P[c]));
-        sum = rade_cadd(sum, rade_cdiv(rx_sym[1][c], ofdm->Pend[c]));
-        sum = rade_cadd(sum, rade_cdiv(rx_sym[Ns + 1][c], ofdm->Pend[c]));
-        float phase_offset = rade_cangle(sum);
+    if (ofdm->fast_math) {
+        RADE_COMP sum[RADE_NC];
+        for (int c = 0; c < Nc; c++) {
+            sum[c] = rade_cmul(rx_sym[0][c], ofdm->P_inv[c]);
+            sum[c] = rade_cadd(sum[c], rade_cmul(rx_sym[1][c], ofdm->Pend_inv[c]));
+            sum[c] = rade_cadd(sum[c], rade_cmul(rx_sym[Ns + 1][c], ofdm->Pend_inv[c]));
+        }
 
         /* Correct all symbols */
         for (int s = 0; s < Ns + 2; s++) {
-            rx_sym[s][c] = rade_cmul(rx_sym[s][c], rade_cexp(-phase_offset));
+            rade_vec_derotate(rx_sym[s], rx_sym[s], sum, Nc);
+        }
+    } else {
+        for (int c = 0; c < Nc; c++) {
+            RADE_COMP sum = rade_czero();
+            sum = rade_cadd(sum, rade_cdiv(rx_sym[0][c], ofdm->P[c]));
+            sum = rade_cadd(sum, rade_cdiv(rx_sym[1][c], ofdm->Pend[c]));
+            sum = rade_cadd(sum, rade_cdiv(rx_sym[Ns + 1][c], ofdm->Pend[c]));
+            float phase_offset = rade_cangle(sum);
+
+            /* Correct all symbols */
+            for (int s = 0; s < Ns + 2; s++) {
+                rx_sym[s][c] = rade_cmul(rx_sym[s][c], rade_cexp(-phase_offset));
+            }
         }
     }
 
@@ -57,7 +57,8 @@ typedef struct {
 
     /* DFT matrices - pre-computed at init */
     RADE_COMP Winv[RADE_NC][RADE_M];           /* IDFT matrix (Tx): Nc freq -> M time */
-    RADE_COMP Wfwd[RADE_M][RADE_NC];           /* DFT matrix (Rx): M time -> Nc freq */
+    float Wfwd_re[RADE_NC][RADE_M];            /* DFT matrix (Rx): M time -> Nc freq, */
+    float Wfwd_im[RADE_NC][RADE_M];            /* split real/imag, one row per carrier */
 
     /* Carrier frequencies */
     float w[RADE_NC];                           /* Angular frequency per carrier */
@@ -79,6 +80,14 @@ typedef struct {
     /* For 3-pilot least-squares fit: Pmat[c] = (A^H A)^-1 A^H */
     RADE_COMP Pmat[RADE_NC][2][3];              /* Per-carrier EQ matrices */
     float local_path_delay_s;                   /* Assumed path delay for LS EQ */
+    RADE_COMP est_rot[RADE_NC];                 /* exp(-j*w[c]*a), a the path delay in samples */
+
+    /* Fast math (RADE_FAST_MATH): channel phase removed with a unit phasor
+       rather than atan2 then sincos, pilots by multiplying by 1/P. Same
+       maths, results differ by float rounding */
+    int fast_math;
+    RADE_COMP P_inv[RADE_NC];                   /* 1/P */
+    RADE_COMP Pend_inv[RADE_NC];                /* 1/Pend */
 
 } rade_ofdm;
 
@@ -118,6 +127,12 @@ int rade_ofdm_mod_frame(const rade_ofdm *ofdm, RADE_COMP *tx_out, const float *z
    time_in[m], freq_out[nc] */
 void rade_ofdm_dft(const rade_ofdm *ofdm, RADE_COMP *freq_out, const RADE_COMP *time_in);
 
+/* DFT of all Ns+2 symbols of a modem frame in one batch, removing each
+   cyclic prefix: rx_in[nmf+m+ncp] -> rx_sym[ns+2][nc]
+   The spectra can be passed to both demodulators below */
+void rade_ofdm_dft_frame(const rade_ofdm *ofdm, RADE_COMP *rx_sym, const RADE_COMP *rx_in,
+                         int time_offset);
+
 /* Remove cyclic prefix: M+Ncp samples -> M samples
    time_in[m+ncp], time_out[m], time_offset for fine timing adjustment */
 void rade_ofdm_remove_cp(const rade_ofdm *ofdm, RADE_COMP *time_out, const RADE_COMP *time_in, int time_offset);
@@ -143,6 +158,11 @@ float rade_ofdm_pilot_eq(const rade_ofdm *ofdm, RADE_COMP *rx_sym,
 int rade_ofdm_demod_frame(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_in,
                           int time_offset, int endofover, int coarse_mag, float *snr_est);
 
+/* As rade_ofdm_demod_frame, starting from spectra from rade_ofdm_dft_frame
+   rx_sym[ns+2][nc] -> z_hat[nzmf*latent_dim] */
+int rade_ofdm_demod_frame_spectra(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_sym,
+                                  int endofover, int coarse_mag, float *snr_est);
+
 /*---------------------------------------------------------------------------*\
                            EOO HANDLING
 \*---------------------------------------------------------------------------*/
@@ -157,6 +177,10 @@ const RADE_COMP* rade_ofdm_get_eoo(const rade_ofdm *ofdm, int *n_out);
    Returns number of output floats */
 int rade_ofdm_demod_eoo(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_in, int time_offset);
 
+/* As rade_ofdm_demod_eoo, starting from spectra from rade_ofdm_dft_frame
+   rx_sym[ns+2][nc] is not modified */
+int rade_ofdm_demod_eoo_spectra(const rade_ofdm *ofdm, float *z_hat, const RADE_COMP *rx_sym);
+
 #ifdef __cplusplus
 }
 #endif
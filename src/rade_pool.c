@@ -0,0 +1,225 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_pool.c
+
+  Fork-join worker pool for RADAE C implementation.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "rade_pool.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <assert.h>
+
+/*---------------------------------------------------------------------------*\
+                              POOL STATE
+\*---------------------------------------------------------------------------*/
+
+/* One rade_pool_run() call, lives on the submitting thread's stack */
+typedef struct rade_pool_job {
+    rade_pool_fn fn;
+    void *arg;
+    int ntasks;
+    int next_task;                          /* next task to hand out */
+    int ndone;                              /* tasks completed */
+    struct rade_pool_job *next;             /* queue link */
+} rade_pool_job;
+
+struct rade_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_cond;               /* signalled when jobs are queued */
+    pthread_cond_t done_cond;               /* signalled when a job completes */
+    rade_pool_job *head;                    /* jobs with tasks still to hand out */
+    rade_pool_job *tail;
+    int shutdown;
+    int nworkers;
+    pthread_t *threads;
+};
+
+/*---------------------------------------------------------------------------*\
+                              SCHEDULING
+\*---------------------------------------------------------------------------*/
+
+/* Take the next task of job, called with lock held. The job leaves the
+   queue once all of its tasks have been handed out. */
+static int pool_claim(rade_pool *pool, rade_pool_job *job) {
+    int task = job->next_task++;
+
+    if (job->next_task == job->ntasks) {
+        rade_pool_job **link = &pool->head;
+        rade_pool_job *prev = NULL;
+        while (*link != job) {
+            prev = *link;
+            link = &(*link)->next;
+        }
+        *link = job->next;
+        if (pool->tail == job) {
+            pool->tail = prev;
+        }
+    }
+
+    return task;
+}
+
+/* Run one task with the lock released, called and returns with lock held */
+static void pool_execute(rade_pool *pool, rade_pool_job *job, int task) {
+    pthread_mutex_unlock(&pool->lock);
+    job->fn(job->arg, task);
+    pthread_mutex_lock(&pool->lock);
+
+    job->ndone++;
+    if (job->ndone == job->ntasks) {
+        pthread_cond_broadcast(&pool->done_cond);
+    }
+}
+
+static void *pool_worker(void *arg) {
+    rade_pool *pool = (rade_pool *)arg;
+
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->head == NULL && !pool->shutdown) {
+            pthread_cond_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->head == NULL) {
+            break;
+        }
+        rade_pool_job *job = pool->head;
+        int task = pool_claim(pool, job);
+        pool_execute(pool, job, task);
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+/*---------------------------------------------------------------------------*\
+                           INITIALIZATION
+\*---------------------------------------------------------------------------*/
+
+rade_pool *rade_pool_create(int nworkers) {
+    assert(nworkers >= 0);
+
+    rade_pool *pool = (rade_pool *)calloc(1, sizeof(rade_pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    if (nworkers > 0) {
+        pool->threads = (pthread_t *)calloc(nworkers, sizeof(pthread_t));
+        if (pool->threads == NULL) {
+            free(pool);
+            return NULL;
+        }
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+
+    for (int i = 0; i < nworkers; i++) {
+        if (pthread_create(&pool->threads[i], NULL, pool_worker, pool) != 0) {
+            break;
+        }
+        pool->nworkers++;
+    }
+
+    if (pool->nworkers != nworkers) {
+        rade_pool_destroy(pool);
+        return NULL;
+    }
+
+    return pool;
+}
+
+void rade_pool_destroy(rade_pool *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    assert(pool->head == NULL);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->nworkers; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done_cond);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
+
+int rade_pool_nworkers(const rade_pool *pool) {
+    return (pool != NULL) ? pool->nworkers : 0;
+}
+
+/*---------------------------------------------------------------------------*\
+                              PROCESSING
+\*---------------------------------------------------------------------------*/
+
+void rade_pool_run(rade_pool *pool, rade_pool_fn fn, void *arg, int ntasks) {
+    if (ntasks <= 0) {
+        return;
+    }
+
+    if (pool == NULL || pool->nworkers == 0 || ntasks == 1) {
+        for (int task = 0; task < ntasks; task++) {
+            fn(arg, task);
+        }
+        return;
+    }
+
+    rade_pool_job job = {fn, arg, ntasks, 0, 0, NULL};
+
+    pthread_mutex_lock(&pool->lock);
+    if (pool->tail != NULL) {
+        pool->tail->next = &job;
+    } else {
+        pool->head = &job;
+    }
+    pool->tail = &job;
+    pthread_cond_broadcast(&pool->work_cond);
+
+    /* Work on our own job until all of its tasks are handed out */
+    while (job.next_task < job.ntasks) {
+        int task = pool_claim(pool, &job);
+        pool_execute(pool, &job, task);
+    }
+
+    while (job.ndone < job.ntasks) {
+        pthread_cond_wait(&pool->done_cond, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,76 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_pool.h
+
+  Fork-join worker pool for RADAE C implementation.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_POOL__
+#define __RADE_POOL__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*\
+                              WORKER POOL
+\*---------------------------------------------------------------------------*/
+
+/* A fixed set of worker threads that run numbered tasks. Any number of
+   threads may submit jobs to the same pool concurrently; the submitting
+   thread works on its own job too, so a pool with 0 workers is valid and
+   simply runs everything on the caller. Task results must be written to
+   per-task storage and combined by the caller in task order, which keeps
+   results independent of scheduling. */
+
+typedef struct rade_pool rade_pool;
+
+/* Task body: arg is the job argument, task is in [0, ntasks) */
+typedef void (*rade_pool_fn)(void *arg, int task);
+
+/* Create a pool with nworkers threads, returns NULL on failure */
+rade_pool *rade_pool_create(int nworkers);
+
+/* Stop and join the workers, no jobs may be in progress */
+void rade_pool_destroy(rade_pool *pool);
+
+/* Number of worker threads (not counting callers) */
+int rade_pool_nworkers(const rade_pool *pool);
+
+/* Run fn(arg, task) for task = 0..ntasks-1 and return when all are done.
+   pool may be NULL, in which case the tasks run in order on the caller. */
+void rade_pool_run(rade_pool *pool, rade_pool_fn fn, void *arg, int ntasks);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_POOL__ */
@@ -34,6 +34,8 @@
 */
 
 #include "rade_rx.h"
+#include "rade_vec.h"
+#include "rade_arch.h"
 #include "rade_dec_data.h"
 #include <string.h>
 #include <stdio.h>
@@ -43,73 +45,107 @@
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-int rade_rx_init(rade_rx_state *rx, const RADEDec *dec_model, int bottleneck, int auxdata, int bpf_en) {
+int rade_rx_tables_init(rade_rx_tables *tab, const WeightArray *arrays, int bottleneck, int auxdata,
+                        int acq_wide) {
+    memset(tab, 0, sizeof(rade_rx_tables));
+
+    tab->bottleneck = bottleneck;
+    tab->auxdata = auxdata;
+
+    /* OFDM demodulator */
+    rade_ofdm_init(&tab->ofdm, bottleneck);
+
+    /* Acquisition */
+    float frange = acq_wide ? RADE_ACQ_FRANGE_WIDE : RADE_ACQ_FRANGE;
+    rade_acq_tables_init(&tab->acq, &tab->ofdm, frange, acq_wide ? RADE_ACQ_FSTEP_WIDE : RADE_ACQ_FSTEP);
+
+    /* Rx BPF, used by receivers that enable it */
+    float w_min = tab->ofdm.w[0];
+    float w_max = tab->ofdm.w[RADE_NC - 1];
+    float bandwidth = 1.2f * (w_max - w_min) * RADE_FS / (2.0f * M_PI);
+    float centre = (w_max + w_min) * RADE_FS / (2.0f * M_PI) / 2.0f;
+
+    /* A wider frequency search needs a band that passes the offsets it can
+       find, as far as a real input's 0 to Fs/2 allows */
+    float signal_bw = (w_max - w_min) * RADE_FS / (2.0f * M_PI);
+    if (frange > bandwidth - signal_bw) {
+        float f_lo = fmaxf(centre - (signal_bw + frange) / 2.0f, 0.0f);
+        float f_hi = fminf(centre + (signal_bw + frange) / 2.0f, RADE_FS / 2.0f);
+        bandwidth = f_hi - f_lo;
+        centre = (f_hi + f_lo) / 2.0f;
+    }
+    rade_bpf_taps_init(&tab->bpf, RADE_BPF_NTAP, RADE_FS, bandwidth, centre);
+
+    /* Decoder, the layers point into the weight arrays */
+    if (arrays == NULL) {
+#ifdef USE_WEIGHTS_FILE
+        return -1;
+#else
+        arrays = radedec_arrays;
+#endif
+    }
+    int output_dim = (RADE_NUM_FEATURES + (auxdata ? 1 : 0)) * RADE_FRAMES_PER_STEP;
+    if (init_radedec(&tab->dec_model, arrays, output_dim) != 0) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int rade_rx_init(rade_rx_state *rx, const rade_rx_tables *tab, int bpf_en) {
     memset(rx, 0, sizeof(rade_rx_state));
 
-    rx->bottleneck = bottleneck;
-    rx->auxdata = auxdata;
-    rx->num_features = RADE_NUM_FEATURES + (auxdata ? 1 : 0);
+    rx->tab = tab;
+    rx->bottleneck = tab->bottleneck;
+    rx->auxdata = tab->auxdata;
+    rx->num_features = RADE_NUM_FEATURES + (tab->auxdata ? 1 : 0);
     rx->bpf_en = bpf_en;
     rx->coarse_mag = 1;
     rx->time_offset = -16;  /* Default fine timing offset */
     rx->verbose = 1;
+    rx->arch = rade_arch_default();
 
-    /* Initialize OFDM demodulator */
-    rade_ofdm_init(&rx->ofdm, bottleneck);
-
-    /* Initialize acquisition */
-    rade_acq_init(&rx->acq, &rx->ofdm, RADE_ACQ_FRANGE, RADE_ACQ_FSTEP);
-
-    /* Initialize decoder if model provided */
-    if (dec_model != NULL) {
-        memcpy(&rx->dec_model, dec_model, sizeof(RADEDec));
-    } else {
-        /* Use built-in weights */
-        int output_dim = rx->num_features * RADE_FRAMES_PER_STEP;
-        if (init_radedec(&rx->dec_model, radedec_arrays, output_dim) != 0) {
-            return -1;
-        }
+    if (rade_acq_init(&rx->acq, &tab->acq) != 0) {
+        return -1;
     }
     rade_init_decoder(&rx->dec_state);
-
-    /* Initialize Rx BPF if enabled */
-    if (bpf_en) {
-        float w_min = rx->ofdm.w[0];
-        float w_max = rx->ofdm.w[RADE_NC - 1];
-        float bandwidth = 1.2f * (w_max - w_min) * RADE_FS / (2.0f * M_PI);
-        float centre = (w_max + w_min) * RADE_FS / (2.0f * M_PI) / 2.0f;
-        rade_bpf_init(&rx->bpf, RADE_BPF_NTAP, RADE_FS, bandwidth, centre, RADE_FS);
-    }
+    /* Also the real input front end, so set up whatever bpf_en says */
+    rade_bpf_init(&rx->bpf, &tab->bpf, RADE_FS);
 
     /* Initialize state machine */
     rx->state = RADE_STATE_SEARCH;
     rx->nin = RADE_NMF;
     rx->mf = 1;
-    rx->rx_phase = rade_cone();
+    rade_nco_init(&rx->rx_nco, 0.0f);
 
     /* Calculate unsync timeout (modem frames) */
     rx->Nmf_unsync = (int)(RADE_TUNSYNC * RADE_FS / RADE_NMF);
     rx->synced_count_one_sec = RADE_FS / RADE_NMF;
 
-    /* Clear receive buffer */
-    memset(rx->rx_buf, 0, sizeof(rx->rx_buf));
-
     return 0;
 }
 
+void rade_rx_close(rade_rx_state *rx) {
+    rade_acq_close(&rx->acq);
+}
+
 void rade_rx_reset(rade_rx_state *rx) {
     rx->state = RADE_STATE_SEARCH;
     rx->nin = RADE_NMF;
+    rx->grid_pos = 0;
+    rx->search_samples = 0;
     rx->valid_count = 0;
     rx->synced_count = 0;
     rx->uw_errors = 0;
-    rx->rx_phase = rade_cone();
+    rade_nco_init(&rx->rx_nco, 0.0f);
     rx->snrdB_3k_est = 0.0f;
+    rx->snr_first = 0;
     rade_init_decoder(&rx->dec_state);
-    if (rx->bpf_en) {
-        rade_bpf_reset(&rx->bpf);
-    }
-    memset(rx->rx_buf, 0, sizeof(rx->rx_buf));
+    rx->dec_reset = 0;
+    rade_acq_reset(&rx->acq);
+    rade_bpf_reset(&rx->bpf);
+    memset(rx->rx_ring, 0, sizeof(rx->rx_ring));
+    rx->rx_head = 0;
 }
 
 /*---------------------------------------------------------------------------*\
@@ -144,34 +180,51 @@ float rade_rx_freq_offset(const rade_rx_state *rx) {
     return rx->fmax;
 }
 
+int rade_rx_restart_point(const rade_rx_state *rx) {
+    /* Input still held in the receive buffer or the BPF memory */
+    int memory = RADE_RX_BUF_SIZE + ((rx->bpf_en || rx->real_in) ? RADE_BPF_NTAP : 0);
+    return rx->state == RADE_STATE_SEARCH && rx->grid_pos == 0 &&
+           rx->search_samples >= memory;
+}
+
 void rade_rx_sum_uw_errors(rade_rx_state *rx, int new_uw_errors) {
     rx->uw_errors += new_uw_errors;
 }
 
-int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, const RADE_COMP *rx_in) {
+/* Where the front end writes the next nin samples: over the oldest, the
+   run may carry on into the upper copy, which mirrors the start */
+static RADE_COMP *rx_ring_in(rade_rx_state *rx) {
+    return &rx->rx_ring[rx->rx_head];
+}
+
+/* Mirror the n samples written at rx_ring_in() and slide the window on */
+static void rx_ring_commit(rade_rx_state *rx, int n) {
+    int size = RADE_RX_BUF_SIZE;
+    int head = rx->rx_head;
+    int n_lower = (head + n <= size) ? n : size - head;
+
+    memcpy(&rx->rx_ring[head + size], &rx->rx_ring[head], sizeof(RADE_COMP) * n_lower);
+    memcpy(rx->rx_ring, &rx->rx_ring[size], sizeof(RADE_COMP) * (n - n_lower));
+    rx->rx_head = (head + n) % size;
+}
+
+/* Demodulate the nin samples the front end has put in the receive window */
+static int rx_demod_window(rade_rx_state *rx, float *z_hat, float *eoo_out) {
     int M = RADE_M;
     int Ncp = RADE_NCP;
     int Nmf = RADE_NMF;
     float Fs = (float)RADE_FS;
 
     int prev_state = rx->state;
+    int nin = rx->nin;
     int valid_output = 0;
     int endofover = 0;
     int uw_fail = 0;
 
-    /* Apply BPF if enabled */
-    RADE_COMP rx_filtered[RADE_NMF + RADE_M];
-    const RADE_COMP *rx_samples = rx_in;
-
-    if (rx->bpf_en) {
-        rade_bpf_process(&rx->bpf, rx_filtered, rx_in, rx->nin);
-        rx_samples = rx_filtered;
-    }
-
-    /* Update receive buffer: shift out old samples, add new */
-    int buf_size = RADE_RX_BUF_SIZE;
-    memmove(rx->rx_buf, &rx->rx_buf[rx->nin], sizeof(RADE_COMP) * (buf_size - rx->nin));
-    memcpy(&rx->rx_buf[buf_size - rx->nin], rx_samples, sizeof(RADE_COMP) * rx->nin);
+    /* Receive window, the newest RADE_RX_BUF_SIZE samples */
+    rx_ring_commit(rx, nin);
+    const RADE_COMP *rx_buf = &rx->rx_ring[rx->rx_head];
+    rx->grid_pos = (rx->grid_pos + nin) % Nmf;
 
     /* State machine processing */
     int candidate = 0;
@@ -179,7 +232,7 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
 
     if (rx->state == RADE_STATE_SEARCH || rx->state == RADE_STATE_CANDIDATE) {
         /* Acquisition mode: detect pilots */
-        candidate = rade_acq_detect_pilots(&rx->acq, rx->rx_buf, &rx->tmax, &rx->fmax);
+        candidate = rade_acq_detect_pilots(&rx->acq, rx_buf, &rx->tmax, &rx->fmax);
     } else {
         /* Sync mode: refine timing/freq and check pilots */
         float ffine_start = rx->fmax - 1.0f;
@@ -188,14 +241,14 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
         int tfine_end = rx->tmax + 8;
 
         float fmax_hat = rx->fmax;
-        rade_acq_refine(&rx->acq, rx->rx_buf, &rx->tmax, &fmax_hat,
+        rade_acq_refine(&rx->acq, rx_buf, &rx->tmax, &fmax_hat,
                        tfine_start, tfine_end, ffine_start, ffine_end, 0.1f);
 
         /* Low-pass filter frequency estimate */
         rx->fmax = 0.9f * rx->fmax + 0.1f * fmax_hat;
 
         /* Check pilots */
-        rade_acq_check_pilots(&rx->acq, rx->rx_buf, rx->tmax, rx->fmax, &candidate, &endofover);
+        rade_acq_check_pilots(&rx->acq, rx_buf, rx->tmax, rx->fmax, &candidate, &endofover);
 
         /* Handle timing slips */
         rx->nin = Nmf;
@@ -218,79 +271,37 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
             rx->uw_errors = 0;
         }
 
-        /* Frequency offset correction */
+        /* Frequency offset correction, the phase carries on across frames */
         float w = 2.0f * M_PI * rx->fmax / Fs;
         RADE_COMP rx_corrected[RADE_NMF + RADE_M + RADE_NCP];
 
-        for (int n = 0; n < Nmf + M + Ncp; n++) {
-            rx->rx_phase = rade_cmul(rx->rx_phase, rade_cexp(-w));
-            rx_corrected[n] = rade_cmul(rx->rx_buf[rx->tmax - Ncp + n], rx->rx_phase);
-        }
+        rade_nco_set_freq(&rx->rx_nco, -w);
+        rade_nco_mix(&rx->rx_nco, rx_corrected, &rx_buf[rx->tmax - Ncp], Nmf + M + Ncp);
 
-        /* Normalize phase to prevent drift */
-        float phase_mag = rade_cabs(rx->rx_phase);
-        rx->rx_phase = rade_cscale(rx->rx_phase, 1.0f / phase_mag);
-
-        /* Demodulate OFDM frame */
-        float z_hat[RADE_NZMF * RADE_LATENT_DIM];
+        /* Demodulate OFDM frame, the symbol spectra are shared with the
+           EOO demodulator below */
         float snr_est = 0.0f;
+        RADE_COMP rx_sym[(RADE_NS + 2) * RADE_NC];
 
-        rade_ofdm_demod_frame(&rx->ofdm, z_hat, rx_corrected,
-                              rx->time_offset, endofover, rx->coarse_mag, &snr_est);
+        rade_ofdm_dft_frame(&rx->tab->ofdm, rx_sym, rx_corrected, rx->time_offset);
+        rade_ofdm_demod_frame_spectra(&rx->tab->ofdm, z_hat, rx_sym,
+                                      endofover, rx->coarse_mag, &snr_est);
 
-        /* Update SNR estimate with moving average */
-        rx->snrdB_3k_est = 0.9f * rx->snrdB_3k_est + 0.1f * snr_est;
+        /* Update SNR estimate with moving average, from the first frame
+           after sync */
+        if (rx->snr_first) {
+            rx->snrdB_3k_est = snr_est;
+            rx->snr_first = 0;
+        } else {
+            rx->snrdB_3k_est = 0.9f * rx->snrdB_3k_est + 0.1f * snr_est;
+        }
 
         valid_output = !endofover;
 
-        if (valid_output) {
-            /* Decode latents to features */
-            int Nzmf = RADE_NZMF;
-            int latent_dim = RADE_LATENT_DIM;
-            int dec_stride = RADE_FRAMES_PER_STEP;
-            int num_used_features = RADE_NUM_FEATURES;
-            int nb_total_features = RADE_NB_TOTAL_FEATURES;
-            int num_features = rx->num_features;
-            int arch = 0;
-
-            /* Zero output buffer */
-            int n_features_out = rade_rx_n_features_out(rx);
-            memset(features_out, 0, sizeof(float) * n_features_out);
-
-            int uw_errors_total = 0;
-
-            for (int c = 0; c < Nzmf; c++) {
-                float dec_features[RADE_FRAMES_PER_STEP * RADE_NUM_FEATURES_AUX];
-
-                rade_core_decoder(&rx->dec_state, &rx->dec_model,
-                                 dec_features, &z_hat[c * latent_dim], arch);
-
-                /* Copy decoded features to output (with padding) */
-                for (int i = 0; i < dec_stride; i++) {
-                    int out_idx = (c * dec_stride + i) * nb_total_features;
-                    for (int j = 0; j < num_used_features; j++) {
-                        features_out[out_idx + j] = dec_features[i * num_features + j];
-                    }
-                }
-
-                /* Check auxiliary data for unique word errors */
-                if (rx->auxdata) {
-                    /* Use first aux symbol of each group (they repeat) */
-                    if (dec_features[num_used_features] > 0) {
-                        uw_errors_total++;
-                    }
-                }
-            }
-
-            if (rx->auxdata) {
-                rx->uw_errors += uw_errors_total;
-            }
-        }
-
         if (endofover) {
             /* Copy EOO symbols to output */
             float z_hat_eoo[(RADE_NS - 1) * RADE_NC * 2];
-            rade_ofdm_demod_eoo(&rx->ofdm, z_hat_eoo, rx_corrected, rx->time_offset);
+            rade_ofdm_demod_eoo_spectra(&rx->tab->ofdm, z_hat_eoo, rx_sym);
 
             int n_eoo_bits = rade_rx_n_eoo_bits(rx);
             memcpy(eoo_out, z_hat_eoo, sizeof(float) * n_eoo_bits);
@@ -330,9 +341,15 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
             rx->valid_count++;
             if (rx->valid_count > 3) {
                 next_state = RADE_STATE_SYNC;
-                rade_init_decoder(&rx->dec_state);  /* Reset decoder state */
+                rx->dec_reset = 1;  /* Reset decoder state before the first latents */
                 rx->synced_count = 0;
                 rx->uw_errors = 0;
+
+                /* Every sync starts from the same tracking state, so what
+                   the receiver does depends only on its recent input */
+                rade_nco_set_phase(&rx->rx_nco, 0.0);
+                rx->snr_first = 1;
+                rx->acq.seed = RADE_ACQ_SEED;
                 rx->valid_count = rx->Nmf_unsync;
 
                 /* Fine refinement of timing/frequency */
@@ -341,7 +358,7 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
                 int tfine_start = (rx->tmax > 1) ? (rx->tmax - 1) : 0;
                 int tfine_end = rx->tmax + 2;
 
-                rade_acq_refine(&rx->acq, rx->rx_buf, &rx->tmax, &rx->fmax,
+                rade_acq_refine(&rx->acq, rx_buf, &rx->tmax, &rx->fmax,
                                tfine_start, tfine_end, ffine_start, ffine_end, 0.25f);
             }
         } else {
@@ -373,10 +390,143 @@ int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, cons
 
     rx->state = next_state;
     if (rx->state == RADE_STATE_SEARCH) {
-        rx->nin = Nmf;  /* Reset nin when not synced */
+        /* Back to the frame grid, timing slips while synced move off it.
+           The one short frame follows a sync frame, whose pilot check
+           already stopped acquisition reusing correlations across frames */
+        rx->nin = Nmf - rx->grid_pos;
+        rx->search_samples = (prev_state == RADE_STATE_SEARCH) ? rx->search_samples + nin : 0;
+    } else {
+        if (rx->state == RADE_STATE_CANDIDATE) {
+            rx->nin = Nmf;  /* Candidate timing is compared a whole frame apart */
+        }
+        rx->search_samples = 0;
     }
     rx->mf++;
 
     /* Return flags */
-    return (valid_output ? 0x1 : 0) | (endofover ? 0x2 : 0);
+    int dec_reset = 0;
+    if (valid_output && rx->dec_reset) {
+        dec_reset = 1;
+        rx->dec_reset = 0;
+    }
+    return (valid_output ? 0x1 : 0) | (endofover ? 0x2 : 0) | (dec_reset ? 0x4 : 0);
+}
+
+/* Copy one decoder step to the output (with padding) and count unique word
+   errors in the auxiliary data */
+static void rx_unpack_features(const rade_rx_state *rx, float *features_out, int c,
+                               const float *dec_features, int *uw_errors) {
+    int dec_stride = RADE_FRAMES_PER_STEP;
+    int num_used_features = RADE_NUM_FEATURES;
+    int nb_total_features = RADE_NB_TOTAL_FEATURES;
+    int num_features = rx->num_features;
+
+    for (int i = 0; i < dec_stride; i++) {
+        int out_idx = (c * dec_stride + i) * nb_total_features;
+        for (int j = 0; j < num_used_features; j++) {
+            features_out[out_idx + j] = dec_features[i * num_features + j];
+        }
+    }
+
+    /* Use first aux symbol of each group (they repeat) */
+    if (rx->auxdata && dec_features[num_used_features] > 0) {
+        (*uw_errors)++;
+    }
+}
+
+void rade_rx_reset_decoder(rade_rx_state *rx) {
+    rade_init_decoder(&rx->dec_state);
+}
+
+int rade_rx_decode(rade_rx_state *rx, float *features_out, const float *z_hat) {
+    int uw_errors_total = 0;
+
+    memset(features_out, 0, sizeof(float) * rade_rx_n_features_out(rx));
+
+    for (int c = 0; c < RADE_NZMF; c++) {
+        float dec_features[RADE_FRAMES_PER_STEP * RADE_NUM_FEATURES_AUX];
+
+        rade_core_decoder(&rx->dec_state, &rx->tab->dec_model,
+                          dec_features, &z_hat[c * RADE_LATENT_DIM], rx->arch);
+        rx_unpack_features(rx, features_out, c, dec_features, &uw_errors_total);
+    }
+
+    return uw_errors_total;
+}
+
+int rade_rx_same_decoder(const rade_rx_state *a, const rade_rx_state *b) {
+    return a->arch == b->arch &&
+           (a->tab == b->tab || memcmp(&a->tab->dec_model, &b->tab->dec_model, sizeof(RADEDec)) == 0);
+}
+
+void rade_rx_decode_batch(rade_rx_state *const rx[], float *const features_out[],
+                          const float *const z_hat[], int uw_errors_out[], int n) {
+    for (int s0 = 0; s0 < n; s0 += RADE_DEC_MAX_BATCH) {
+        int nb = (n - s0 < RADE_DEC_MAX_BATCH) ? (n - s0) : RADE_DEC_MAX_BATCH;
+        RADEDecState *states[RADE_DEC_MAX_BATCH];
+        float dec_features[RADE_DEC_MAX_BATCH][RADE_FRAMES_PER_STEP * RADE_NUM_FEATURES_AUX];
+        float *features[RADE_DEC_MAX_BATCH];
+        const float *latents[RADE_DEC_MAX_BATCH];
+        int *uw_errors = &uw_errors_out[s0];
+
+        for (int s = 0; s < nb; s++) {
+            assert(rade_rx_same_decoder(rx[s0], rx[s0 + s]));
+            states[s] = &rx[s0 + s]->dec_state;
+            features[s] = dec_features[s];
+            uw_errors[s] = 0;
+            memset(features_out[s0 + s], 0, sizeof(float) * rade_rx_n_features_out(rx[s0 + s]));
+        }
+
+        /* Steps within a frame depend on each other through the decoder
+           state, the streams of one step don't */
+        for (int c = 0; c < RADE_NZMF; c++) {
+            for (int s = 0; s < nb; s++) {
+                latents[s] = &z_hat[s0 + s][c * RADE_LATENT_DIM];
+            }
+            rade_core_decoder_batch(states, &rx[s0]->tab->dec_model, features, latents, nb, rx[s0]->arch);
+            for (int s = 0; s < nb; s++) {
+                rx_unpack_features(rx[s0 + s], features_out[s0 + s], c, dec_features[s], &uw_errors[s]);
+            }
+        }
+    }
+}
+
+int rade_rx_demod(rade_rx_state *rx, float *z_hat, float *eoo_out, const RADE_COMP *rx_in) {
+    /* Apply BPF if enabled, straight into the receive window */
+    if (rx->bpf_en) {
+        rade_bpf_process(&rx->bpf, rx_ring_in(rx), rx_in, rx->nin);
+    } else {
+        memcpy(rx_ring_in(rx), rx_in, sizeof(RADE_COMP) * rx->nin);
+    }
+    return rx_demod_window(rx, z_hat, eoo_out);
+}
+
+int rade_rx_demod_real(rade_rx_state *rx, float *z_hat, float *eoo_out, const float *rx_in) {
+    /* The fused band-pass makes the analytic signal, whatever bpf_en says */
+    rade_bpf_process_real(&rx->bpf, rx_ring_in(rx), rx_in, rx->nin);
+    rx->real_in = 1;
+    return rx_demod_window(rx, z_hat, eoo_out);
+}
+
+/* Decode the latents rade_rx_demod() or rade_rx_demod_real() returned */
+static int rx_decode_flags(rade_rx_state *rx, float *features_out, const float *z_hat, int flags) {
+    if (flags & 0x1) {
+        if (flags & 0x4) {
+            rade_rx_reset_decoder(rx);
+        }
+        rade_rx_sum_uw_errors(rx, rade_rx_decode(rx, features_out, z_hat));
+    }
+    return flags;
+}
+
+int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, const RADE_COMP *rx_in) {
+    float z_hat[RADE_NZMF * RADE_LATENT_DIM];
+
+    return rx_decode_flags(rx, features_out, z_hat, rade_rx_demod(rx, z_hat, eoo_out, rx_in));
+}
+
+int rade_rx_process_real(rade_rx_state *rx, float *features_out, float *eoo_out, const float *rx_in) {
+    float z_hat[RADE_NZMF * RADE_LATENT_DIM];
+
+    return rx_decode_flags(rx, features_out, z_hat, rade_rx_demod_real(rx, z_hat, eoo_out, rx_in));
 }
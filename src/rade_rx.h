@@ -40,6 +40,7 @@
 #include "rade_dsp.h"
 #include "rade_ofdm.h"
 #include "rade_bpf.h"
+#include "rade_nco.h"
 #include "rade_acq.h"
 #include "rade_dec.h"
 #include "rade_core.h"
@@ -55,16 +56,31 @@ extern "C" {
 /* Receive buffer size: 2*Nmf + M + Ncp */
 #define RADE_RX_BUF_SIZE (2 * RADE_NMF + RADE_M + RADE_NCP)
 
+/* Tables and decoder layers, read only after rade_rx_tables_init() so any
+   number of receivers (on any threads) can share one copy */
 typedef struct {
-    /* DSP components */
     rade_ofdm ofdm;
+    rade_acq_tables acq;
+    rade_bpf_taps bpf;
+    RADEDec dec_model;        /* Layers point into the weight arrays */
+    int bottleneck;
+    int auxdata;
+} rade_rx_tables;
+
+typedef struct {
+    /* Shared tables (not owned) */
+    const rade_rx_tables *tab;
+
+    /* DSP components */
     rade_bpf bpf;
     rade_acq acq;
     int bpf_en;
+    int real_in;              /* Input has come through rade_rx_demod_real() */
 
     /* Core decoder */
-    RADEDec dec_model;
     RADEDecState dec_state;
+    int arch;                 /* Opus dnn kernel level, see rade_arch.h */
+    int dec_reset;            /* Decoder state to be reset before the next latents */
 
     /* Configuration */
     int bottleneck;
@@ -85,14 +101,20 @@ typedef struct {
     int tmax;
     int tmax_candidate;
     float fmax;
-    RADE_COMP rx_phase;
+    rade_nco rx_nco;          /* Frequency offset correction */
     int nin;                  /* Samples needed for next call */
+    int grid_pos;             /* Input samples since the last modem frame grid point, mod Nmf */
+    int search_samples;       /* Input samples since the receiver last left SEARCH */
 
-    /* Receive buffer */
-    RADE_COMP rx_buf[RADE_RX_BUF_SIZE];
+    /* Receive window, mirrored: each sample is written at i and at
+       i + RADE_RX_BUF_SIZE, so the newest RADE_RX_BUF_SIZE samples are
+       always contiguous from rx_ring[rx_head] and nothing is shifted */
+    RADE_COMP rx_ring[2 * RADE_RX_BUF_SIZE];
+    int rx_head;              /* Oldest sample, where the next input goes */
 
     /* SNR estimate */
     float snrdB_3k_est;
+    int snr_first;              /* Next synced frame seeds the average */
 
     /* Frame counter */
     int mf;
@@ -109,17 +131,35 @@ typedef struct {
                            INITIALIZATION
 \*---------------------------------------------------------------------------*/
 
-/* Initialize receiver
-   dec_model: pointer to decoder model weights (can be NULL to use built-in)
+/* Compute the shared tables
+   arrays: decoder weights, e.g. from rade_weights_arrays() (NULL to use the
+           built-in weights, which are absent when built with USE_WEIGHTS_FILE)
    bottleneck: 1, 2, or 3
    auxdata: 1 to enable auxiliary data decoding
-   bpf_en: 1 to enable input bandpass filter
+   acq_wide: 1 to search RADE_ACQ_FRANGE_WIDE for the pilots, the Rx BPF
+             then passes the offsets it can find
    Returns 0 on success */
-int rade_rx_init(rade_rx_state *rx, const RADEDec *dec_model, int bottleneck, int auxdata, int bpf_en);
+int rade_rx_tables_init(rade_rx_tables *tab, const WeightArray *arrays, int bottleneck, int auxdata,
+                        int acq_wide);
+
+/* Initialize receiver, tab must outlive rx
+   bpf_en: 1 to enable input bandpass filter
+   Returns 0 on success, -1 if out of memory */
+int rade_rx_init(rade_rx_state *rx, const rade_rx_tables *tab, int bpf_en);
+
+/* Free the memory rade_rx_init() allocated */
+void rade_rx_close(rade_rx_state *rx);
 
 /* Reset receiver state (go back to search mode) */
 void rade_rx_reset(rade_rx_state *rx);
 
+/* Non-zero between frames where the receiver holds no state from earlier
+   input: it has searched for longer than its buffers and filters remember,
+   and is back on the modem frame grid it started on. Two receivers started
+   a multiple of Nmf samples apart in the same input, that are both at a
+   restart point after the same sample, give identical output from there */
+int rade_rx_restart_point(const rade_rx_state *rx);
+
 /*---------------------------------------------------------------------------*\
                            RECEPTION
 \*---------------------------------------------------------------------------*/
@@ -152,10 +192,41 @@ float rade_rx_freq_offset(const rade_rx_state *rx);
 
    Returns:
    - bit 0 (0x1): valid speech features output
-   - bit 1 (0x2): end-of-over detected, eoo_out contains soft decision bits */
+   - bit 1 (0x2): end-of-over detected, eoo_out contains soft decision bits
+   - bit 2 (0x4): first features of a new sync, the decoder state was reset */
 int rade_rx_process(rade_rx_state *rx, float *features_out, float *eoo_out, const RADE_COMP *rx_in);
 
-/* Report unique word errors (called externally if C decoder is used)
+/* rade_rx_process() on real samples, e.g. audio: rx_in[nin] goes through
+   rade_bpf_process_real() in place of a Hilbert transformer and the BPF,
+   whether or not bpf_en is set. Use one or the other on a receiver, or
+   rade_rx_reset() in between */
+int rade_rx_process_real(rade_rx_state *rx, float *features_out, float *eoo_out, const float *rx_in);
+
+/* rade_rx_process() in two steps, so the neural decoder of several
+   receivers can run together, or on another thread. rade_rx_demod() takes
+   nin samples and returns the same flags; when bit 0 is set
+   z_hat[RADE_NZMF*RADE_LATENT_DIM] holds the latents, which must be passed
+   in order to rade_rx_decode() or rade_rx_decode_batch(), after
+   rade_rx_reset_decoder() when bit 2 is set.
+
+   The decode functions only touch the decoder state, so they may run
+   concurrently with rade_rx_demod() on the same receiver. They return the
+   unique word errors found, which the caller passes back to the
+   demodulator with rade_rx_sum_uw_errors(). */
+int rade_rx_demod(rade_rx_state *rx, float *z_hat, float *eoo_out, const RADE_COMP *rx_in);
+int rade_rx_demod_real(rade_rx_state *rx, float *z_hat, float *eoo_out, const float *rx_in);
+void rade_rx_reset_decoder(rade_rx_state *rx);
+int rade_rx_decode(rade_rx_state *rx, float *features_out, const float *z_hat);
+
+/* Decode the latents of n receivers, sharing each layer's weights across
+   them. All must use the same decoder (rade_rx_same_decoder()). */
+void rade_rx_decode_batch(rade_rx_state *const rx[], float *const features_out[],
+                          const float *const z_hat[], int uw_errors_out[], int n);
+
+/* True if a and b run the same weights with the same kernels */
+int rade_rx_same_decoder(const rade_rx_state *a, const rade_rx_state *b);
+
+/* Report unique word errors from the decoder
    This is used by the state machine for unsync detection */
 void rade_rx_sum_uw_errors(rade_rx_state *rx, int new_uw_errors);
 
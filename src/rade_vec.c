@@ -0,0 +1,793 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_vec.c
+
+  Vectorised complex kernels for the RADAE DSP core.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "rade_vec.h"
+#include <float.h>
+
+#if defined(RADE_VEC_AVX2)
+#include <immintrin.h>
+#elif defined(RADE_VEC_SSE)
+#include <emmintrin.h>
+#elif defined(RADE_VEC_NEON)
+#include <arm_neon.h>
+#endif
+
+/* Each kernel runs its vector body over the largest multiple of the vector
+   width and finishes the remainder with the scalar loop. Sums are formed in
+   a different order to the scalar path, so results agree to within float
+   rounding rather than bit for bit. */
+
+const char *rade_vec_impl(void) {
+#if defined(RADE_VEC_AVX2)
+    return "avx2";
+#elif defined(RADE_VEC_SSE)
+    return "sse";
+#elif defined(RADE_VEC_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+/* Horizontal sums of the vector accumulators */
+#if defined(RADE_VEC_AVX2)
+static inline float vec_hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#elif defined(RADE_VEC_SSE)
+static inline float vec_hsum(__m128 s) {
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(s, _mm_shuffle_ps(s, s, 1)));
+}
+#elif defined(RADE_VEC_NEON)
+static inline float vec_hsum(float32x4_t v) {
+    float32x2_t s = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+    return vget_lane_f32(vpadd_f32(s, s), 0);
+}
+#endif
+
+/*---------------------------------------------------------------------------*\
+                           LAYOUT CONVERSION
+\*---------------------------------------------------------------------------*/
+
+void rade_vec_split(float *re, float *im, const RADE_COMP *x, int n) {
+    for (int i = 0; i < n; i++) {
+        re[i] = x[i].real;
+        im[i] = x[i].imag;
+    }
+}
+
+void rade_vec_split_conj(float *re, float *im, const RADE_COMP *x, int n) {
+    for (int i = 0; i < n; i++) {
+        re[i] = x[i].real;
+        im[i] = -x[i].imag;
+    }
+}
+
+void rade_vec_join(RADE_COMP *x, const float *re, const float *im, int n) {
+    for (int i = 0; i < n; i++) {
+        x[i].real = re[i];
+        x[i].imag = im[i];
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                              REAL DOT
+\*---------------------------------------------------------------------------*/
+
+float rade_vec_dot(const float *a, const float *b, int n) {
+    int i = 0;
+    float sum = 0.0f;
+
+#if defined(RADE_VEC_AVX2)
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&a[i]), _mm256_loadu_ps(&b[i]), acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&a[i + 8]), _mm256_loadu_ps(&b[i + 8]), acc1);
+    }
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&a[i]), _mm256_loadu_ps(&b[i]), acc0);
+    }
+    sum = vec_hsum(_mm256_add_ps(acc0, acc1));
+#elif defined(RADE_VEC_SSE)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&a[i + 4]), _mm_loadu_ps(&b[i + 4])));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&a[i]), _mm_loadu_ps(&b[i])));
+    }
+    sum = vec_hsum(_mm_add_ps(acc0, acc1));
+#elif defined(RADE_VEC_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&a[i]), vld1q_f32(&b[i]));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(&a[i + 4]), vld1q_f32(&b[i + 4]));
+    }
+    for (; i + 4 <= n; i += 4) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&a[i]), vld1q_f32(&b[i]));
+    }
+    sum = vec_hsum(vaddq_f32(acc0, acc1));
+#endif
+
+    for (; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+
+    return sum;
+}
+
+/* Two real dot products sharing the b vector, so each load of b serves both */
+void rade_vec_dot2(float *y0, float *y1, const float *a0, const float *a1, const float *b, int n) {
+    int i = 0;
+    float sum0 = 0.0f, sum1 = 0.0f;
+
+#if defined(RADE_VEC_AVX2)
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+        __m256 b0 = _mm256_loadu_ps(&b[i]);
+        __m256 b1 = _mm256_loadu_ps(&b[i + 8]);
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&a0[i]), b0, acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&a1[i]), b0, acc1);
+        acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(&a0[i + 8]), b1, acc2);
+        acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(&a1[i + 8]), b1, acc3);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256 b0 = _mm256_loadu_ps(&b[i]);
+        acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(&a0[i]), b0, acc0);
+        acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(&a1[i]), b0, acc1);
+    }
+    sum0 = vec_hsum(_mm256_add_ps(acc0, acc2));
+    sum1 = vec_hsum(_mm256_add_ps(acc1, acc3));
+#elif defined(RADE_VEC_SSE)
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    __m128 acc2 = _mm_setzero_ps(), acc3 = _mm_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m128 b0 = _mm_loadu_ps(&b[i]);
+        __m128 b1 = _mm_loadu_ps(&b[i + 4]);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&a0[i]), b0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&a1[i]), b0));
+        acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(&a0[i + 4]), b1));
+        acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(&a1[i + 4]), b1));
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m128 b0 = _mm_loadu_ps(&b[i]);
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&a0[i]), b0));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&a1[i]), b0));
+    }
+    sum0 = vec_hsum(_mm_add_ps(acc0, acc2));
+    sum1 = vec_hsum(_mm_add_ps(acc1, acc3));
+#elif defined(RADE_VEC_NEON)
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+    float32x4_t acc2 = vdupq_n_f32(0.0f), acc3 = vdupq_n_f32(0.0f);
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t b0 = vld1q_f32(&b[i]);
+        float32x4_t b1 = vld1q_f32(&b[i + 4]);
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&a0[i]), b0);
+        acc1 = vmlaq_f32(acc1, vld1q_f32(&a1[i]), b0);
+        acc2 = vmlaq_f32(acc2, vld1q_f32(&a0[i + 4]), b1);
+        acc3 = vmlaq_f32(acc3, vld1q_f32(&a1[i + 4]), b1);
+    }
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t b0 = vld1q_f32(&b[i]);
+        acc0 = vmlaq_f32(acc0, vld1q_f32(&a0[i]), b0);
+        acc1 = vmlaq_f32(acc1, vld1q_f32(&a1[i]), b0);
+    }
+    sum0 = vec_hsum(vaddq_f32(acc0, acc2));
+    sum1 = vec_hsum(vaddq_f32(acc1, acc3));
+#endif
+
+    for (; i < n; i++) {
+        sum0 += a0[i] * b[i];
+        sum1 += a1[i] * b[i];
+    }
+
+    *y0 = sum0;
+    *y1 = sum1;
+}
+
+/*---------------------------------------------------------------------------*\
+                            COMPLEX DOT
+\*---------------------------------------------------------------------------*/
+
+RADE_COMP rade_vec_cdot(const float *a_re, const float *a_im,
+                        const float *b_re, const float *b_im, int n) {
+    int i = 0;
+    float re = 0.0f, im = 0.0f;
+
+#if defined(RADE_VEC_AVX2)
+    __m256 acc_rr = _mm256_setzero_ps();
+    __m256 acc_ii = _mm256_setzero_ps();
+    __m256 acc_ri = _mm256_setzero_ps();
+    __m256 acc_ir = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 ar = _mm256_loadu_ps(&a_re[i]);
+        __m256 ai = _mm256_loadu_ps(&a_im[i]);
+        __m256 br = _mm256_loadu_ps(&b_re[i]);
+        __m256 bi = _mm256_loadu_ps(&b_im[i]);
+        acc_rr = _mm256_fmadd_ps(ar, br, acc_rr);
+        acc_ii = _mm256_fmadd_ps(ai, bi, acc_ii);
+        acc_ri = _mm256_fmadd_ps(ar, bi, acc_ri);
+        acc_ir = _mm256_fmadd_ps(ai, br, acc_ir);
+    }
+    /* re = rr - ii, im = ri + ir, then reduce */
+    re = vec_hsum(_mm256_sub_ps(acc_rr, acc_ii));
+    im = vec_hsum(_mm256_add_ps(acc_ri, acc_ir));
+#elif defined(RADE_VEC_SSE)
+    __m128 acc_rr = _mm_setzero_ps();
+    __m128 acc_ii = _mm_setzero_ps();
+    __m128 acc_ri = _mm_setzero_ps();
+    __m128 acc_ir = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 ar = _mm_loadu_ps(&a_re[i]);
+        __m128 ai = _mm_loadu_ps(&a_im[i]);
+        __m128 br = _mm_loadu_ps(&b_re[i]);
+        __m128 bi = _mm_loadu_ps(&b_im[i]);
+        acc_rr = _mm_add_ps(acc_rr, _mm_mul_ps(ar, br));
+        acc_ii = _mm_add_ps(acc_ii, _mm_mul_ps(ai, bi));
+        acc_ri = _mm_add_ps(acc_ri, _mm_mul_ps(ar, bi));
+        acc_ir = _mm_add_ps(acc_ir, _mm_mul_ps(ai, br));
+    }
+    re = vec_hsum(_mm_sub_ps(acc_rr, acc_ii));
+    im = vec_hsum(_mm_add_ps(acc_ri, acc_ir));
+#elif defined(RADE_VEC_NEON)
+    float32x4_t acc_re = vdupq_n_f32(0.0f);
+    float32x4_t acc_im = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t ar = vld1q_f32(&a_re[i]);
+        float32x4_t ai = vld1q_f32(&a_im[i]);
+        float32x4_t br = vld1q_f32(&b_re[i]);
+        float32x4_t bi = vld1q_f32(&b_im[i]);
+        acc_re = vmlaq_f32(acc_re, ar, br);
+        acc_re = vmlsq_f32(acc_re, ai, bi);
+        acc_im = vmlaq_f32(acc_im, ar, bi);
+        acc_im = vmlaq_f32(acc_im, ai, br);
+    }
+    re = vec_hsum(acc_re);
+    im = vec_hsum(acc_im);
+#endif
+
+    for (; i < n; i++) {
+        re += a_re[i] * b_re[i] - a_im[i] * b_im[i];
+        im += a_re[i] * b_im[i] + a_im[i] * b_re[i];
+    }
+
+    return rade_cmplx(re, im);
+}
+
+/*---------------------------------------------------------------------------*\
+                                BLOCK FIR
+\*---------------------------------------------------------------------------*/
+
+/* Vectorised across outputs rather than taps: each tap is broadcast and
+   multiplied into a vector of consecutive outputs, two vectors at a time,
+   so there are no horizontal sums and no tails per output. Folded about
+   the centre tap: the two samples under h[k] and h[ntap-1-k] are added (or
+   subtracted, anti = 1) before the multiply, halving the multiplies and
+   tap loads. Inlined into the two public forms, so anti is a constant. */
+static inline void vec_fir_folded(float *y, const float *h, const float *x, int ntap, int n,
+                                  int anti) {
+    int c = (ntap - 1) / 2;
+    float hc = anti ? 0.0f : h[c];
+    int i = 0;
+
+#if defined(RADE_VEC_AVX2)
+    for (; i + 16 <= n; i += 16) {
+        __m256 acc0 = _mm256_mul_ps(_mm256_set1_ps(hc), _mm256_loadu_ps(&x[i + c]));
+        __m256 acc1 = _mm256_mul_ps(_mm256_set1_ps(hc), _mm256_loadu_ps(&x[i + c + 8]));
+        for (int k = 0; k < c; k++) {
+            const float *lo = &x[i + k], *hi = &x[i + ntap - 1 - k];
+            __m256 hk = _mm256_broadcast_ss(&h[k]);
+            __m256 s0 = anti ? _mm256_sub_ps(_mm256_loadu_ps(lo), _mm256_loadu_ps(hi))
+                             : _mm256_add_ps(_mm256_loadu_ps(lo), _mm256_loadu_ps(hi));
+            __m256 s1 = anti ? _mm256_sub_ps(_mm256_loadu_ps(lo + 8), _mm256_loadu_ps(hi + 8))
+                             : _mm256_add_ps(_mm256_loadu_ps(lo + 8), _mm256_loadu_ps(hi + 8));
+            acc0 = _mm256_fmadd_ps(hk, s0, acc0);
+            acc1 = _mm256_fmadd_ps(hk, s1, acc1);
+        }
+        _mm256_storeu_ps(&y[i], acc0);
+        _mm256_storeu_ps(&y[i + 8], acc1);
+    }
+#elif defined(RADE_VEC_SSE)
+    for (; i + 8 <= n; i += 8) {
+        __m128 acc0 = _mm_mul_ps(_mm_set1_ps(hc), _mm_loadu_ps(&x[i + c]));
+        __m128 acc1 = _mm_mul_ps(_mm_set1_ps(hc), _mm_loadu_ps(&x[i + c + 4]));
+        for (int k = 0; k < c; k++) {
+            const float *lo = &x[i + k], *hi = &x[i + ntap - 1 - k];
+            __m128 hk = _mm_set1_ps(h[k]);
+            __m128 s0 = anti ? _mm_sub_ps(_mm_loadu_ps(lo), _mm_loadu_ps(hi))
+                             : _mm_add_ps(_mm_loadu_ps(lo), _mm_loadu_ps(hi));
+            __m128 s1 = anti ? _mm_sub_ps(_mm_loadu_ps(lo + 4), _mm_loadu_ps(hi + 4))
+                             : _mm_add_ps(_mm_loadu_ps(lo + 4), _mm_loadu_ps(hi + 4));
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(hk, s0));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(hk, s1));
+        }
+        _mm_storeu_ps(&y[i], acc0);
+        _mm_storeu_ps(&y[i + 4], acc1);
+    }
+#elif defined(RADE_VEC_NEON)
+    for (; i + 8 <= n; i += 8) {
+        float32x4_t acc0 = vmulq_n_f32(vld1q_f32(&x[i + c]), hc);
+        float32x4_t acc1 = vmulq_n_f32(vld1q_f32(&x[i + c + 4]), hc);
+        for (int k = 0; k < c; k++) {
+            const float *lo = &x[i + k], *hi = &x[i + ntap - 1 - k];
+            float32x4_t s0 = anti ? vsubq_f32(vld1q_f32(lo), vld1q_f32(hi))
+                                  : vaddq_f32(vld1q_f32(lo), vld1q_f32(hi));
+            float32x4_t s1 = anti ? vsubq_f32(vld1q_f32(lo + 4), vld1q_f32(hi + 4))
+                                  : vaddq_f32(vld1q_f32(lo + 4), vld1q_f32(hi + 4));
+            acc0 = vmlaq_n_f32(acc0, s0, h[k]);
+            acc1 = vmlaq_n_f32(acc1, s1, h[k]);
+        }
+        vst1q_f32(&y[i], acc0);
+        vst1q_f32(&y[i + 4], acc1);
+    }
+#endif
+
+    for (; i < n; i++) {
+        float sum = hc * x[i + c];
+        for (int k = 0; k < c; k++) {
+            sum += h[k] * (anti ? x[i + k] - x[i + ntap - 1 - k] : x[i + k] + x[i + ntap - 1 - k]);
+        }
+        y[i] = sum;
+    }
+}
+
+void rade_vec_fir_sym(float *y, const float *h, const float *x, int ntap, int n) {
+    vec_fir_folded(y, h, x, ntap, n, 0);
+}
+
+void rade_vec_fir_antisym(float *y, const float *h, const float *x, int ntap, int n) {
+    vec_fir_folded(y, h, x, ntap, n, 1);
+}
+
+/*---------------------------------------------------------------------------*\
+                          COMPLEX MATRIX PRODUCT
+\*---------------------------------------------------------------------------*/
+
+/* Two split complex dot products sharing the b vector, so each load of b
+   serves both rows */
+static void vec_cdot2(RADE_COMP *y0, RADE_COMP *y1,
+                      const float *a0_re, const float *a0_im,
+                      const float *a1_re, const float *a1_im,
+                      const float *b_re, const float *b_im, int n) {
+    int i = 0;
+    float re0 = 0.0f, im0 = 0.0f, re1 = 0.0f, im1 = 0.0f;
+
+    /* One accumulator per partial product keeps the add chains independent */
+#if defined(RADE_VEC_AVX2)
+    __m256 rr0 = _mm256_setzero_ps(), ii0 = _mm256_setzero_ps();
+    __m256 ri0 = _mm256_setzero_ps(), ir0 = _mm256_setzero_ps();
+    __m256 rr1 = _mm256_setzero_ps(), ii1 = _mm256_setzero_ps();
+    __m256 ri1 = _mm256_setzero_ps(), ir1 = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+        __m256 br = _mm256_loadu_ps(&b_re[i]);
+        __m256 bi = _mm256_loadu_ps(&b_im[i]);
+        __m256 ar = _mm256_loadu_ps(&a0_re[i]);
+        __m256 ai = _mm256_loadu_ps(&a0_im[i]);
+        rr0 = _mm256_fmadd_ps(ar, br, rr0);
+        ii0 = _mm256_fmadd_ps(ai, bi, ii0);
+        ri0 = _mm256_fmadd_ps(ar, bi, ri0);
+        ir0 = _mm256_fmadd_ps(ai, br, ir0);
+        ar = _mm256_loadu_ps(&a1_re[i]);
+        ai = _mm256_loadu_ps(&a1_im[i]);
+        rr1 = _mm256_fmadd_ps(ar, br, rr1);
+        ii1 = _mm256_fmadd_ps(ai, bi, ii1);
+        ri1 = _mm256_fmadd_ps(ar, bi, ri1);
+        ir1 = _mm256_fmadd_ps(ai, br, ir1);
+    }
+    re0 = vec_hsum(_mm256_sub_ps(rr0, ii0));
+    im0 = vec_hsum(_mm256_add_ps(ri0, ir0));
+    re1 = vec_hsum(_mm256_sub_ps(rr1, ii1));
+    im1 = vec_hsum(_mm256_add_ps(ri1, ir1));
+#elif defined(RADE_VEC_SSE)
+    __m128 rr0 = _mm_setzero_ps(), ii0 = _mm_setzero_ps();
+    __m128 ri0 = _mm_setzero_ps(), ir0 = _mm_setzero_ps();
+    __m128 rr1 = _mm_setzero_ps(), ii1 = _mm_setzero_ps();
+    __m128 ri1 = _mm_setzero_ps(), ir1 = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) {
+        __m128 br = _mm_loadu_ps(&b_re[i]);
+        __m128 bi = _mm_loadu_ps(&b_im[i]);
+        __m128 ar = _mm_loadu_ps(&a0_re[i]);
+        __m128 ai = _mm_loadu_ps(&a0_im[i]);
+        rr0 = _mm_add_ps(rr0, _mm_mul_ps(ar, br));
+        ii0 = _mm_add_ps(ii0, _mm_mul_ps(ai, bi));
+        ri0 = _mm_add_ps(ri0, _mm_mul_ps(ar, bi));
+        ir0 = _mm_add_ps(ir0, _mm_mul_ps(ai, br));
+        ar = _mm_loadu_ps(&a1_re[i]);
+        ai = _mm_loadu_ps(&a1_im[i]);
+        rr1 = _mm_add_ps(rr1, _mm_mul_ps(ar, br));
+        ii1 = _mm_add_ps(ii1, _mm_mul_ps(ai, bi));
+        ri1 = _mm_add_ps(ri1, _mm_mul_ps(ar, bi));
+        ir1 = _mm_add_ps(ir1, _mm_mul_ps(ai, br));
+    }
+    re0 = vec_hsum(_mm_sub_ps(rr0, ii0));
+    im0 = vec_hsum(_mm_add_ps(ri0, ir0));
+    re1 = vec_hsum(_mm_sub_ps(rr1, ii1));
+    im1 = vec_hsum(_mm_add_ps(ri1, ir1));
+#elif defined(RADE_VEC_NEON)
+    float32x4_t rr0 = vdupq_n_f32(0.0f), ii0 = vdupq_n_f32(0.0f);
+    float32x4_t ri0 = vdupq_n_f32(0.0f), ir0 = vdupq_n_f32(0.0f);
+    float32x4_t rr1 = vdupq_n_f32(0.0f), ii1 = vdupq_n_f32(0.0f);
+    float32x4_t ri1 = vdupq_n_f32(0.0f), ir1 = vdupq_n_f32(0.0f);
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t br = vld1q_f32(&b_re[i]);
+        float32x4_t bi = vld1q_f32(&b_im[i]);
+        float32x4_t ar = vld1q_f32(&a0_re[i]);
+        float32x4_t ai = vld1q_f32(&a0_im[i]);
+        rr0 = vmlaq_f32(rr0, ar, br);
+        ii0 = vmlaq_f32(ii0, ai, bi);
+        ri0 = vmlaq_f32(ri0, ar, bi);
+        ir0 = vmlaq_f32(ir0, ai, br);
+        ar = vld1q_f32(&a1_re[i]);
+        ai = vld1q_f32(&a1_im[i]);
+        rr1 = vmlaq_f32(rr1, ar, br);
+        ii1 = vmlaq_f32(ii1, ai, bi);
+        ri1 = vmlaq_f32(ri1, ar, bi);
+        ir1 = vmlaq_f32(ir1, ai, br);
+    }
+    re0 = vec_hsum(vsubq_f32(rr0, ii0));
+    im0 = vec_hsum(vaddq_f32(ri0, ir0));
+    re1 = vec_hsum(vsubq_f32(rr1, ii1));
+    im1 = vec_hsum(vaddq_f32(ri1, ir1));
+#endif
+
+    for (; i < n; i++) {
+        re0 += a0_re[i] * b_re[i] - a0_im[i] * b_im[i];
+        im0 += a0_re[i] * b_im[i] + a0_im[i] * b_re[i];
+        re1 += a1_re[i] * b_re[i] - a1_im[i] * b_im[i];
+        im1 += a1_re[i] * b_im[i] + a1_im[i] * b_re[i];
+    }
+
+    *y0 = rade_cmplx(re0, im0);
+    *y1 = rade_cmplx(re1, im1);
+}
+
+void rade_vec_cmatmul(RADE_COMP *y, const float *a_re, const float *a_im, int na,
+                      const float *b_re, const float *b_im, int nb, int n) {
+    for (int j = 0; j < nb; j++) {
+        const float *bj_re = &b_re[j * n];
+        const float *bj_im = &b_im[j * n];
+        int i = 0;
+
+        for (; i + 2 <= na; i += 2) {
+            vec_cdot2(&y[i * nb + j], &y[(i + 1) * nb + j],
+                      &a_re[i * n], &a_im[i * n], &a_re[(i + 1) * n], &a_im[(i + 1) * n],
+                      bj_re, bj_im, n);
+        }
+        for (; i < na; i++) {
+            y[i * nb + j] = rade_vec_cdot(&a_re[i * n], &a_im[i * n], bj_re, bj_im, n);
+        }
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                         COMPLEX MULTIPLY (MIXING)
+\*---------------------------------------------------------------------------*/
+
+void rade_vec_cmul(RADE_COMP *y, const RADE_COMP *a, const RADE_COMP *b, int n) {
+    int i = 0;
+
+#if defined(RADE_VEC_AVX2)
+    for (; i + 4 <= n; i += 4) {
+        __m256 va = _mm256_loadu_ps(&a[i].real);
+        __m256 vb = _mm256_loadu_ps(&b[i].real);
+        __m256 b_re = _mm256_moveldup_ps(vb);                   /* br br ... */
+        __m256 b_im = _mm256_movehdup_ps(vb);                   /* bi bi ... */
+        __m256 a_sw = _mm256_permute_ps(va, 0xB1);              /* ai ar ... */
+        /* even: ar*br - ai*bi, odd: ai*br + ar*bi */
+        __m256 vy = _mm256_fmaddsub_ps(va, b_re, _mm256_mul_ps(a_sw, b_im));
+        _mm256_storeu_ps(&y[i].real, vy);
+    }
+#elif defined(RADE_VEC_SSE)
+    const __m128 sign = _mm_castsi128_ps(_mm_set_epi32(0, (int)0x80000000, 0, (int)0x80000000));
+    for (; i + 2 <= n; i += 2) {
+        __m128 va = _mm_loadu_ps(&a[i].real);
+        __m128 vb = _mm_loadu_ps(&b[i].real);
+        __m128 b_re = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(2, 2, 0, 0));
+        __m128 b_im = _mm_shuffle_ps(vb, vb, _MM_SHUFFLE(3, 3, 1, 1));
+        __m128 a_sw = _mm_shuffle_ps(va, va, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 t = _mm_xor_ps(_mm_mul_ps(a_sw, b_im), sign);   /* -ai*bi, ar*bi */
+        _mm_storeu_ps(&y[i].real, _mm_add_ps(_mm_mul_ps(va, b_re), t));
+    }
+#elif defined(RADE_VEC_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t va = vld2q_f32(&a[i].real);
+        float32x4x2_t vb = vld2q_f32(&b[i].real);
+        float32x4x2_t vy;
+        vy.val[0] = vmlsq_f32(vmulq_f32(va.val[0], vb.val[0]), va.val[1], vb.val[1]);
+        vy.val[1] = vmlaq_f32(vmulq_f32(va.val[0], vb.val[1]), va.val[1], vb.val[0]);
+        vst2q_f32(&y[i].real, vy);
+    }
+#endif
+
+    for (; i < n; i++) {
+        y[i] = rade_cmul(a[i], b[i]);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                             DE-ROTATION
+\*---------------------------------------------------------------------------*/
+
+void rade_vec_derotate(RADE_COMP *y, const RADE_COMP *x, const RADE_COMP *h, int n) {
+    int i = 0;
+
+#if defined(RADE_VEC_AVX2)
+    const __m256 tiny = _mm256_set1_ps(FLT_MIN);
+    const __m256 half = _mm256_set1_ps(0.5f), three_halves = _mm256_set1_ps(1.5f);
+    for (; i + 8 <= n; i += 8) {
+        __m256 x0 = _mm256_loadu_ps(&x[i].real), x1 = _mm256_loadu_ps(&x[i + 4].real);
+        __m256 h0 = _mm256_loadu_ps(&h[i].real), h1 = _mm256_loadu_ps(&h[i + 4].real);
+        /* split, lanes come out as 0 1 4 5 2 3 6 7 for both and go back
+           the same way */
+        __m256 x_re = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 x_im = _mm256_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 h_re = _mm256_shuffle_ps(h0, h1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m256 h_im = _mm256_shuffle_ps(h0, h1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m256 m = _mm256_max_ps(_mm256_fmadd_ps(h_re, h_re, _mm256_mul_ps(h_im, h_im)), tiny);
+        __m256 r = _mm256_rsqrt_ps(m);
+        r = _mm256_mul_ps(r, _mm256_fnmadd_ps(_mm256_mul_ps(half, m), _mm256_mul_ps(r, r), three_halves));
+        __m256 y_re = _mm256_mul_ps(_mm256_fmadd_ps(x_re, h_re, _mm256_mul_ps(x_im, h_im)), r);
+        __m256 y_im = _mm256_mul_ps(_mm256_fmsub_ps(x_im, h_re, _mm256_mul_ps(x_re, h_im)), r);
+        _mm256_storeu_ps(&y[i].real, _mm256_unpacklo_ps(y_re, y_im));
+        _mm256_storeu_ps(&y[i + 4].real, _mm256_unpackhi_ps(y_re, y_im));
+    }
+#elif defined(RADE_VEC_SSE)
+    const __m128 tiny = _mm_set1_ps(FLT_MIN);
+    const __m128 half = _mm_set1_ps(0.5f), three_halves = _mm_set1_ps(1.5f);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x0 = _mm_loadu_ps(&x[i].real), x1 = _mm_loadu_ps(&x[i + 2].real);
+        __m128 h0 = _mm_loadu_ps(&h[i].real), h1 = _mm_loadu_ps(&h[i + 2].real);
+        __m128 x_re = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 x_im = _mm_shuffle_ps(x0, x1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 h_re = _mm_shuffle_ps(h0, h1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 h_im = _mm_shuffle_ps(h0, h1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 m = _mm_max_ps(_mm_add_ps(_mm_mul_ps(h_re, h_re), _mm_mul_ps(h_im, h_im)), tiny);
+        __m128 r = _mm_rsqrt_ps(m);
+        r = _mm_mul_ps(r, _mm_sub_ps(three_halves, _mm_mul_ps(_mm_mul_ps(half, m), _mm_mul_ps(r, r))));
+        __m128 y_re = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(x_re, h_re), _mm_mul_ps(x_im, h_im)), r);
+        __m128 y_im = _mm_mul_ps(_mm_sub_ps(_mm_mul_ps(x_im, h_re), _mm_mul_ps(x_re, h_im)), r);
+        _mm_storeu_ps(&y[i].real, _mm_unpacklo_ps(y_re, y_im));
+        _mm_storeu_ps(&y[i + 2].real, _mm_unpackhi_ps(y_re, y_im));
+    }
+#elif defined(RADE_VEC_NEON)
+    const float32x4_t tiny = vdupq_n_f32(FLT_MIN);
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t vx = vld2q_f32(&x[i].real);
+        float32x4x2_t vh = vld2q_f32(&h[i].real);
+        float32x4_t m = vmaxq_f32(vmlaq_f32(vmulq_f32(vh.val[0], vh.val[0]), vh.val[1], vh.val[1]), tiny);
+        float32x4_t r = vrsqrteq_f32(m);
+        r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(m, r), r));
+        r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(m, r), r));
+        float32x4x2_t vy;
+        vy.val[0] = vmulq_f32(vmlaq_f32(vmulq_f32(vx.val[0], vh.val[0]), vx.val[1], vh.val[1]), r);
+        vy.val[1] = vmulq_f32(vmlsq_f32(vmulq_f32(vx.val[1], vh.val[0]), vx.val[0], vh.val[1]), r);
+        vst2q_f32(&y[i].real, vy);
+    }
+#endif
+
+    for (; i < n; i++) {
+        float m = h[i].real * h[i].real + h[i].imag * h[i].imag;
+        float r = 1.0f / sqrtf(m > FLT_MIN ? m : FLT_MIN);
+        y[i] = rade_cscale(rade_cmul(x[i], rade_cconj(h[i])), r);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                             MAGNITUDE
+\*---------------------------------------------------------------------------*/
+
+void rade_vec_cabs(float *mag, const RADE_COMP *x, int n) {
+    int i = 0;
+
+#if defined(RADE_VEC_AVX2)
+    for (; i + 8 <= n; i += 8) {
+        __m256 v0 = _mm256_loadu_ps(&x[i].real);
+        __m256 v1 = _mm256_loadu_ps(&x[i + 4].real);
+        __m256 p0 = _mm256_mul_ps(v0, v0);
+        __m256 p1 = _mm256_mul_ps(v1, v1);
+        /* pairwise re^2 + im^2, lanes come out as 0 1 4 5 2 3 6 7 */
+        __m256 s = _mm256_hadd_ps(p0, p1);
+        s = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(s), 0xD8));
+        _mm256_storeu_ps(&mag[i], _mm256_sqrt_ps(s));
+    }
+#elif defined(RADE_VEC_SSE)
+    for (; i + 4 <= n; i += 4) {
+        __m128 v0 = _mm_loadu_ps(&x[i].real);
+        __m128 v1 = _mm_loadu_ps(&x[i + 2].real);
+        __m128 re = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 im = _mm_shuffle_ps(v0, v1, _MM_SHUFFLE(3, 1, 3, 1));
+        __m128 s = _mm_add_ps(_mm_mul_ps(re, re), _mm_mul_ps(im, im));
+        _mm_storeu_ps(&mag[i], _mm_sqrt_ps(s));
+    }
+#elif defined(RADE_VEC_NEON)
+    for (; i + 4 <= n; i += 4) {
+        float32x4x2_t v = vld2q_f32(&x[i].real);
+        float32x4_t s = vmlaq_f32(vmulq_f32(v.val[0], v.val[0]), v.val[1], v.val[1]);
+#if defined(__aarch64__)
+        vst1q_f32(&mag[i], vsqrtq_f32(s));
+#else
+        mag[i] = sqrtf(vgetq_lane_f32(s, 0));
+        mag[i + 1] = sqrtf(vgetq_lane_f32(s, 1));
+        mag[i + 2] = sqrtf(vgetq_lane_f32(s, 2));
+        mag[i + 3] = sqrtf(vgetq_lane_f32(s, 3));
+#endif
+    }
+#endif
+
+    for (; i < n; i++) {
+        mag[i] = rade_cabs(x[i]);
+    }
+}
+
+/*---------------------------------------------------------------------------*\
+                       MULTI-STREAM MATRIX PRODUCTS
+\*---------------------------------------------------------------------------*/
+
+/* Eight output rows of up to four streams are held in registers while the
+   weights stream past once. Per output the products are summed in column
+   order, the same order as the Opus sgemv kernels. */
+
+#if defined(RADE_VEC_AVX2)
+typedef __m256 vec8;
+static inline vec8 vec8_zero(void) { return _mm256_setzero_ps(); }
+static inline vec8 vec8_load(const float *p) { return _mm256_loadu_ps(p); }
+static inline void vec8_store(float *p, vec8 v) { _mm256_storeu_ps(p, v); }
+static inline vec8 vec8_madd(vec8 acc, vec8 w, float x) {
+    return _mm256_fmadd_ps(w, _mm256_set1_ps(x), acc);
+}
+#elif defined(RADE_VEC_SSE)
+typedef struct { __m128 lo, hi; } vec8;
+static inline vec8 vec8_zero(void) { vec8 v = { _mm_setzero_ps(), _mm_setzero_ps() }; return v; }
+static inline vec8 vec8_load(const float *p) { vec8 v = { _mm_loadu_ps(p), _mm_loadu_ps(p + 4) }; return v; }
+static inline void vec8_store(float *p, vec8 v) { _mm_storeu_ps(p, v.lo); _mm_storeu_ps(p + 4, v.hi); }
+static inline vec8 vec8_madd(vec8 acc, vec8 w, float x) {
+    __m128 xv = _mm_set1_ps(x);
+    acc.lo = _mm_add_ps(acc.lo, _mm_mul_ps(w.lo, xv));
+    acc.hi = _mm_add_ps(acc.hi, _mm_mul_ps(w.hi, xv));
+    return acc;
+}
+#elif defined(RADE_VEC_NEON)
+typedef float32x4x2_t vec8;
+static inline vec8 vec8_zero(void) { vec8 v = { { vdupq_n_f32(0.0f), vdupq_n_f32(0.0f) } }; return v; }
+static inline vec8 vec8_load(const float *p) { vec8 v = { { vld1q_f32(p), vld1q_f32(p + 4) } }; return v; }
+static inline void vec8_store(float *p, vec8 v) { vst1q_f32(p, v.val[0]); vst1q_f32(p + 4, v.val[1]); }
+static inline vec8 vec8_madd(vec8 acc, vec8 w, float x) {
+    acc.val[0] = vmlaq_n_f32(acc.val[0], w.val[0], x);
+    acc.val[1] = vmlaq_n_f32(acc.val[1], w.val[1], x);
+    return acc;
+}
+#else
+typedef struct { float v[8]; } vec8;
+static inline vec8 vec8_zero(void) { vec8 v = { { 0.0f } }; return v; }
+static inline vec8 vec8_load(const float *p) { vec8 v; for (int k = 0; k < 8; k++) v.v[k] = p[k]; return v; }
+static inline void vec8_store(float *p, vec8 v) { for (int k = 0; k < 8; k++) p[k] = v.v[k]; }
+static inline vec8 vec8_madd(vec8 acc, vec8 w, float x) {
+    for (int k = 0; k < 8; k++) acc.v[k] += w.v[k] * x;
+    return acc;
+}
+#endif
+
+/* One block of 8 output rows for ns <= 4 streams starting at x[0]. ns is a
+   constant at each call site so the unused accumulators drop out. */
+static inline void vec8_dense_block(float *const y[], const float *w, int n_out, int n_in,
+                                    const float *const x[], int i, int ns) {
+    vec8 a0 = vec8_zero(), a1 = vec8_zero(), a2 = vec8_zero(), a3 = vec8_zero();
+
+    for (int j = 0; j < n_in; j++) {
+        vec8 wj = vec8_load(&w[j * n_out + i]);
+        a0 = vec8_madd(a0, wj, x[0][j]);
+        if (ns > 1) a1 = vec8_madd(a1, wj, x[1][j]);
+        if (ns > 2) a2 = vec8_madd(a2, wj, x[2][j]);
+        if (ns > 3) a3 = vec8_madd(a3, wj, x[3][j]);
+    }
+    vec8_store(&y[0][i], a0);
+    if (ns > 1) vec8_store(&y[1][i], a1);
+    if (ns > 2) vec8_store(&y[2][i], a2);
+    if (ns > 3) vec8_store(&y[3][i], a3);
+}
+
+static inline void vec8_sparse_block(float *const y[], const float *w, const int *idx, int nblocks,
+                                     const float *const x[], int i, int ns) {
+    vec8 a0 = vec8_zero(), a1 = vec8_zero(), a2 = vec8_zero(), a3 = vec8_zero();
+
+    for (int b = 0; b < nblocks; b++) {
+        int pos = idx[b];
+        for (int k = 0; k < 4; k++) {
+            vec8 wk = vec8_load(&w[32 * b + 8 * k]);
+            a0 = vec8_madd(a0, wk, x[0][pos + k]);
+            if (ns > 1) a1 = vec8_madd(a1, wk, x[1][pos + k]);
+            if (ns > 2) a2 = vec8_madd(a2, wk, x[2][pos + k]);
+            if (ns > 3) a3 = vec8_madd(a3, wk, x[3][pos + k]);
+        }
+    }
+    vec8_store(&y[0][i], a0);
+    if (ns > 1) vec8_store(&y[1][i], a1);
+    if (ns > 2) vec8_store(&y[2][i], a2);
+    if (ns > 3) vec8_store(&y[3][i], a3);
+}
+
+void rade_vec_sgemm(float *const y[], const float *w, int n_out, int n_in,
+                    const float *const x[], int nb) {
+    int i = 0;
+
+    for (; i + 8 <= n_out; i += 8) {
+        int s = 0;
+        for (; s + 4 <= nb; s += 4) {
+            vec8_dense_block(&y[s], w, n_out, n_in, &x[s], i, 4);
+        }
+        switch (nb - s) {
+        case 3: vec8_dense_block(&y[s], w, n_out, n_in, &x[s], i, 3); break;
+        case 2: vec8_dense_block(&y[s], w, n_out, n_in, &x[s], i, 2); break;
+        case 1: vec8_dense_block(&y[s], w, n_out, n_in, &x[s], i, 1); break;
+        }
+    }
+
+    for (; i < n_out; i++) {
+        for (int s = 0; s < nb; s++) {
+            float acc = 0.0f;
+            for (int j = 0; j < n_in; j++) {
+                acc += w[j * n_out + i] * x[s][j];
+            }
+            y[s][i] = acc;
+        }
+    }
+}
+
+void rade_vec_sgemm_sparse8x4(float *const y[], const float *w, const int *idx, int n_out,
+                              const float *const x[], int nb) {
+    for (int i = 0; i < n_out; i += 8) {
+        int nblocks = *idx++;
+        int s = 0;
+        for (; s + 4 <= nb; s += 4) {
+            vec8_sparse_block(&y[s], w, idx, nblocks, &x[s], i, 4);
+        }
+        switch (nb - s) {
+        case 3: vec8_sparse_block(&y[s], w, idx, nblocks, &x[s], i, 3); break;
+        case 2: vec8_sparse_block(&y[s], w, idx, nblocks, &x[s], i, 2); break;
+        case 1: vec8_sparse_block(&y[s], w, idx, nblocks, &x[s], i, 1); break;
+        }
+        idx += nblocks;
+        w += 32 * nblocks;
+    }
+}
@@ -0,0 +1,138 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_vec.h
+
+  Vectorised complex kernels for the RADAE DSP core.
+  Split (re/im) and interleaved layouts, SSE/AVX2/NEON or scalar.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_VEC__
+#define __RADE_VEC__
+
+#include "rade_dsp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*\
+                           KERNEL SELECTION
+\*---------------------------------------------------------------------------*/
+
+/* The instruction set is chosen at compile time from the target flags.
+   Define RADE_VEC_SCALAR to force the plain C kernels (reference path). */
+#if !defined(RADE_VEC_SCALAR)
+#if defined(__AVX2__) && defined(__FMA__)
+#define RADE_VEC_AVX2
+#elif defined(__SSE2__) || defined(_M_X64)
+#define RADE_VEC_SSE
+#elif defined(__ARM_NEON)
+#define RADE_VEC_NEON
+#endif
+#endif
+
+/* Name of the compiled kernel set: "avx2", "sse", "neon" or "scalar" */
+const char *rade_vec_impl(void);
+
+/*---------------------------------------------------------------------------*\
+                           LAYOUT CONVERSION
+\*---------------------------------------------------------------------------*/
+
+/* Interleaved to split: re[i] = x[i].real, im[i] = x[i].imag */
+void rade_vec_split(float *re, float *im, const RADE_COMP *x, int n);
+
+/* Interleaved to split, conjugated: re[i] = x[i].real, im[i] = -x[i].imag */
+void rade_vec_split_conj(float *re, float *im, const RADE_COMP *x, int n);
+
+/* Split to interleaved: x[i] = re[i] + j*im[i] */
+void rade_vec_join(RADE_COMP *x, const float *re, const float *im, int n);
+
+/*---------------------------------------------------------------------------*\
+                              KERNELS
+\*---------------------------------------------------------------------------*/
+
+/* Real dot product: sum(a[i] * b[i]) */
+float rade_vec_dot(const float *a, const float *b, int n);
+
+/* Two real dot products sharing b: y0 = sum(a0[i] * b[i]), y1 = sum(a1[i] * b[i]) */
+void rade_vec_dot2(float *y0, float *y1, const float *a0, const float *a1, const float *b, int n);
+
+/* Split complex dot product (no conjugate): sum(a[i] * b[i]) */
+RADE_COMP rade_vec_cdot(const float *a_re, const float *a_im,
+                        const float *b_re, const float *b_im, int n);
+
+/* Block FIR over a linear delay line for a symmetric filter, h[k] ==
+   h[ntap-1-k] with ntap odd: y[i] = sum(h[k] * x[i + k]), k < ntap, i < n,
+   h in time order (oldest sample first), x holds n + ntap - 1 samples.
+   Only h[0..(ntap-1)/2] is read */
+void rade_vec_fir_sym(float *y, const float *h, const float *x, int ntap, int n);
+
+/* rade_vec_fir_sym() for an antisymmetric filter, h[k] == -h[ntap-1-k],
+   so the centre tap is zero; only h[0..(ntap-3)/2] is read */
+void rade_vec_fir_antisym(float *y, const float *h, const float *x, int ntap, int n);
+
+/* Split complex matrix product with both operands stored by rows:
+   y[i*nb + j] = sum_k a[i][k] * b[j][k], a is na x n, b is nb x n */
+void rade_vec_cmatmul(RADE_COMP *y, const float *a_re, const float *a_im, int na,
+                      const float *b_re, const float *b_im, int nb, int n);
+
+/* Interleaved complex multiply (mixing): y[i] = a[i] * b[i], y may alias a or b */
+void rade_vec_cmul(RADE_COMP *y, const RADE_COMP *a, const RADE_COMP *b, int n);
+
+/* Interleaved de-rotation by the phase of h: y[i] = x[i] * conj(h[i]) / |h[i]|,
+   y may alias x.  The vector paths use a reciprocal square root estimate
+   refined by Newton steps, good to a few float ulps; h[i] == 0 gives 0 */
+void rade_vec_derotate(RADE_COMP *y, const RADE_COMP *x, const RADE_COMP *h, int n);
+
+/* Interleaved complex magnitude: mag[i] = |x[i]| */
+void rade_vec_cabs(float *mag, const RADE_COMP *x, int n);
+
+/*---------------------------------------------------------------------------*\
+                       MULTI-STREAM MATRIX PRODUCTS
+\*---------------------------------------------------------------------------*/
+
+/* One weight matrix applied to the inputs of nb streams, for batched neural
+   decoding. Dense, column major as the Opus float weights:
+   y[s][i] = sum_j w[j*n_out + i] * x[s][j], i < n_out, j < n_in */
+void rade_vec_sgemm(float *const y[], const float *w, int n_out, int n_in,
+                    const float *const x[], int nb);
+
+/* Opus 8x4 block sparse layout: for each group of 8 rows idx holds the
+   block count then the first input of each 4 column block, w holds the
+   blocks as 4 columns of 8. n_out must be a multiple of 8. */
+void rade_vec_sgemm_sparse8x4(float *const y[], const float *w, const int *idx, int n_out,
+                              const float *const x[], int nb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_VEC__ */
@@ -0,0 +1,137 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_weights.c
+
+  Decoder weights loaded from a binary blob for RADAE C implementation.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "rade_weights.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*---------------------------------------------------------------------------*\
+                              WEIGHT BLOB
+\*---------------------------------------------------------------------------*/
+
+struct rade_weights {
+    const void *data;                       /* read only mapping of the file */
+    size_t len;
+    WeightArray *arrays;                    /* from parse_weights(), points into data */
+};
+
+/* Map the whole file read only, returns NULL on failure */
+static const void *map_file(const char *path, size_t *len) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER size;
+    const void *data = NULL;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL) {
+            data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);           /* the view keeps the mapping alive */
+        }
+        *len = (size_t)size.QuadPart;
+    }
+    CloseHandle(file);
+    return data;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void *data = NULL;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) data = NULL;
+        *len = (size_t)st.st_size;
+    }
+    close(fd);                              /* the mapping keeps the file open */
+    return data;
+#endif
+}
+
+static void unmap_file(const void *data, size_t len) {
+#ifdef _WIN32
+    (void)len;
+    UnmapViewOfFile(data);
+#else
+    munmap((void *)data, len);
+#endif
+}
+
+rade_weights *rade_weights_open(const char *path) {
+    size_t len = 0;
+    const void *data = map_file(path, &len);
+    if (data == NULL) {
+        fprintf(stderr, "rade_weights_open: can't map %s\n", path);
+        return NULL;
+    }
+
+    rade_weights *w = (rade_weights *)calloc(1, sizeof(rade_weights));
+    if (w == NULL) {
+        unmap_file(data, len);
+        return NULL;
+    }
+    w->data = data;
+    w->len = len;
+
+    /* parse_weights() checks every header against the remaining length */
+    if (len > 0x7fffffff || parse_weights(&w->arrays, data, (int)len) <= 0) {
+        fprintf(stderr, "rade_weights_open: %s is not a valid weight file\n", path);
+        rade_weights_close(w);
+        return NULL;
+    }
+    return w;
+}
+
+void rade_weights_close(rade_weights *w) {
+    if (w == NULL) return;
+    free(w->arrays);
+    unmap_file(w->data, w->len);
+    free(w);
+}
+
+const WeightArray *rade_weights_arrays(const rade_weights *w) {
+    return w->arrays;
+}
@@ -0,0 +1,71 @@
+/*---------------------------------------------------------------------------*\
+
+  rade_weights.h
+
+  Decoder weights loaded from a binary blob for RADAE C implementation.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __RADE_WEIGHTS__
+#define __RADE_WEIGHTS__
+
+#include "nnet.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*---------------------------------------------------------------------------*\
+                              WEIGHT BLOB
+\*---------------------------------------------------------------------------*/
+
+/* A weight file in the Opus dnn blob format (64 byte "DNNw" header per
+   array, data padded to 64 bytes), as written by write_rade_weights. The
+   file is mapped read only and the arrays point straight into the mapping,
+   so every process using the same file shares one page cache copy. The
+   mapping must outlive any RADEDec initialised from it. */
+
+typedef struct rade_weights rade_weights;
+
+/* Map and parse a weight file, returns NULL (with a message on stderr) if
+   it can't be opened or isn't a valid blob */
+rade_weights *rade_weights_open(const char *path);
+
+/* Unmap the file, arrays from rade_weights_arrays() become invalid */
+void rade_weights_close(rade_weights *w);
+
+/* NULL terminated list for init_radedec() */
+const WeightArray *rade_weights_arrays(const rade_weights *w);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __RADE_WEIGHTS__ */
@@ -0,0 +1,134 @@
+#include "resampler.h"
+#include "rade_vec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* ── filter design ─────────────────────────────────────────────────── */
+
+/* zeroth order modified Bessel function, for the Kaiser window */
+static double bessel_i0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+void Resampler::reset(int in_rate, int out_rate)
+{
+    in_rate_  = std::max(in_rate, 1);
+    out_rate_ = std::max(out_rate, 1);
+    size_t g  = static_cast<size_t>(std::gcd(in_rate_, out_rate_));
+    L_ = static_cast<size_t>(out_rate_) / g;
+    M_ = static_cast<size_t>(in_rate_) / g;
+
+    /* branches: L_ of them for the exact rational path, oversampled so an
+       adjusted phase interpolates between close neighbours */
+    phases_ = L_ * ((MIN_PHASES + L_ - 1) / L_);
+
+    /* TAPS_PER_ZERO zero crossings a side at the lower rate, counted in
+       input samples */
+    double min_rate = std::min(in_rate_, out_rate_);
+    taps_ = static_cast<size_t>(std::ceil(2.0 * TAPS_PER_ZERO * in_rate_ / min_rate));
+
+    /* prototype at phases_ times the input rate, one tap longer than the
+       bank needs so branch phases_ (the next input's branch 0) exists for
+       interpolation.  Centred as near the middle as puts the delay on a
+       whole output sample, so callers can drop it exactly */
+    size_t n_proto = taps_ * phases_ + 1;
+    delay_ = static_cast<size_t>(std::lround(0.5 * taps_ * L_ / M_));
+    double centre  = static_cast<double>(delay_ * M_ * (phases_ / L_));
+    double half    = std::min(centre, static_cast<double>(n_proto - 1) - centre);
+    double fc      = 0.5 * PASSBAND * min_rate / (static_cast<double>(in_rate_) * phases_);
+    double i0_beta = bessel_i0(KAISER_BETA);
+
+    std::vector<double> proto(n_proto);
+    for (size_t j = 0; j < n_proto; j++) {
+        double t = static_cast<double>(j) - centre;
+        double x = 2.0 * fc * t;
+        double sinc = (t == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+        double r = t / half;
+        double w = (std::fabs(r) >= 1.0) ? 0.0
+                 : bessel_i0(KAISER_BETA * std::sqrt(1.0 - r * r)) / i0_beta;
+        proto[j] = 2.0 * fc * sinc * w * static_cast<double>(phases_);
+    }
+
+    /* branch q applies proto[q + k * phases_] to x[n - k]; stored reversed,
+       oldest sample first, for a contiguous dot */
+    bank_.assign((phases_ + 1) * taps_, 0.0f);
+    for (size_t q = 0; q <= phases_; q++)
+        for (size_t k = 0; k < taps_; k++)
+            bank_[q * taps_ + (taps_ - 1 - k)] = static_cast<float>(proto[q + k * phases_]);
+
+    adjust_ = 0.0;
+    step_   = static_cast<double>(M_ * (phases_ / L_));
+    clear();
+}
+
+void Resampler::clear()
+{
+    buf_.assign(taps_ - 1, 0.0f);
+    next_  = taps_ - 1;
+    phase_ = 0.0;
+}
+
+void Resampler::set_ratio_adjust(double adjust)
+{
+    adjust_ = std::clamp(adjust, -0.01, 0.01);
+    step_   = static_cast<double>(M_ * (phases_ / L_)) * (1.0 + adjust_);
+}
+
+size_t Resampler::max_output(size_t n) const
+{
+    if (passthrough()) return n;
+    double avail = static_cast<double>(buf_.size() - std::min(next_, buf_.size()) + n);
+    return static_cast<size_t>(avail * static_cast<double>(phases_) / step_) + 2;
+}
+
+/* ── streaming ─────────────────────────────────────────────────────── */
+
+size_t Resampler::process(const float* in, size_t n, float* out)
+{
+    if (passthrough()) {
+        std::memcpy(out, in, n * sizeof(float));
+        return n;
+    }
+
+    buf_.insert(buf_.end(), in, in + n);
+
+    const int taps = static_cast<int>(taps_);
+    size_t produced = 0;
+    while (next_ < buf_.size()) {
+        const float* x = &buf_[next_ + 1 - taps_];
+        size_t q = static_cast<size_t>(phase_);
+        double f = phase_ - static_cast<double>(q);
+
+        float y = rade_vec_dot(&bank_[q * taps_], x, taps);
+        if (f > 0.0) {
+            float y1 = rade_vec_dot(&bank_[(q + 1) * taps_], x, taps);
+            y += static_cast<float>(f) * (y1 - y);
+        }
+        out[produced++] = y;
+
+        phase_ += step_;
+        size_t adv = static_cast<size_t>(phase_ / static_cast<double>(phases_));
+        phase_ -= static_cast<double>(adv * phases_);
+        next_  += adv;
+    }
+
+    /* keep taps_ - 1 samples of history behind next_ */
+    size_t drop = std::min(next_ + 1 - taps_, buf_.size());
+    buf_.erase(buf_.begin(), buf_.begin() + static_cast<std::ptrdiff_t>(drop));
+    next_ -= drop;
+    return produced;
+}
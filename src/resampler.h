@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/* ── Resampler ─────────────────────────────────────────────────────────────
+ *
+ *  Streaming polyphase windowed-sinc sample rate converter, shared by the
+ *  file reader and both audio backends.  reset() reduces in/out to L/M and
+ *  designs one Kaiser-windowed sinc, cut off just below the lower of the
+ *  two Nyquist rates, as a bank of branches: one branch per output phase,
+ *  each a contiguous reversed run of taps, so every output sample is a
+ *  single rade_vec_dot() over the input history.  48k->8k, 44.1k->8k and
+ *  16k->48k all land on short exact integer phase sequences.
+ *
+ *  Memory and CPU are fixed by the rate pair: TAPS_PER_ZERO zero crossings
+ *  a side at the lower rate, so 192 taps per output for 48k->8k and 32 for
+ *  16k->48k.  Equal rates pass through untouched.
+ *
+ *  set_ratio_adjust() trims the ratio by a small fraction for drift
+ *  correction between two clocks; the phase then falls between branches
+ *  and the two neighbours are interpolated.  The bank is oversampled to
+ *  MIN_PHASES so that stays below -90 dB even when L is 1.  At zero
+ *  adjustment the output is bit-exact with the plain rational path.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+class Resampler {
+public:
+    static constexpr int    TAPS_PER_ZERO = 16;    // zero crossings each side
+    static constexpr double PASSBAND      = 0.9;   // of the lower Nyquist rate
+    static constexpr double KAISER_BETA   = 8.6;   // ~ -85 dB sidelobes
+    static constexpr int    MIN_PHASES    = 256;   // bank resolution for set_ratio_adjust()
+
+    Resampler() = default;
+
+    /* design for in_rate -> out_rate and clear the history */
+    void reset(int in_rate, int out_rate);
+
+    /* clear the history only, for a seek or a restarted stream */
+    void clear();
+
+    int in_rate() const  { return in_rate_; }
+    int out_rate() const { return out_rate_; }
+    bool passthrough() const { return in_rate_ == out_rate_ && adjust_ == 0.0; }
+
+    /* trim the input step per output by (1 + adjust), |adjust| < 0.01;
+       positive consumes input faster, so produces fewer samples */
+    void set_ratio_adjust(double adjust);
+    double ratio_adjust() const { return adjust_; }
+
+    /* most samples process() can return for n more input */
+    size_t max_output(size_t n) const;
+
+    /* consume all n input samples, write the outputs they complete to out
+       (room for max_output(n)), return the number written */
+    size_t process(const float* in, size_t n, float* out);
+
+    /* group delay, a whole number of output samples */
+    size_t delay() const { return delay_; }
+
+private:
+    int    in_rate_  = 1;
+    int    out_rate_ = 1;
+    size_t L_ = 1;                      // upsample factor, out / gcd
+    size_t M_ = 1;                      // downsample factor, in / gcd
+    size_t phases_ = 1;                 // branches in the bank, a multiple of L_
+    size_t taps_   = 1;                 // taps per branch
+    size_t delay_  = 0;                 // output samples
+    std::vector<float> bank_;           // (phases_ + 1) branches of taps_, reversed
+
+    double adjust_ = 0.0;
+    double step_   = 1.0;               // bank phases per output
+    double phase_  = 0.0;               // [0, phases_), integral unless adjusted
+
+    /* taps_ - 1 samples of history then unconsumed input; next_ indexes the
+       newest sample under the filter for the next output */
+    std::vector<float> buf_;
+    size_t             next_ = 0;
+};
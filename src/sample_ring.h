@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+/* ── SampleRing ────────────────────────────────────────────────────────────
+ *
+ *  Lock-free single-producer / single-consumer ring of float samples, used
+ *  to hand audio from the capture thread to the DSP thread.  The producer
+ *  only moves head_ and the consumer only moves tail_; both are
+ *  free-running counters over a power-of-two buffer, so neither side ever
+ *  waits for the other.
+ *
+ *  A full ring drops the newest samples and counts them rather than block
+ *  the producer, since a stalled capture thread loses samples in the
+ *  driver instead.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+class SampleRing {
+public:
+    /* not thread-safe: call before the producer and consumer start ------- */
+    void reset(size_t min_capacity)
+    {
+        size_t cap = 1;
+        while (cap < min_capacity) cap <<= 1;
+        buf_.assign(cap, 0.0f);
+        mask_ = cap - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        high_water_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return buf_.size(); }
+
+    /* producer: returns the number of samples stored ---------------------- */
+    size_t write(const float* in, size_t n)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t fill = head - tail_.load(std::memory_order_acquire);
+        size_t room = capacity() - fill;
+        if (n > room) {
+            dropped_.fetch_add(n - room, std::memory_order_relaxed);
+            n = room;
+        }
+        if (fill + n > high_water_.load(std::memory_order_relaxed))
+            high_water_.store(fill + n, std::memory_order_relaxed);
+
+        size_t pos   = head & mask_;
+        size_t first = std::min(n, capacity() - pos);
+        std::memcpy(&buf_[pos], in, first * sizeof(float));
+        std::memcpy(&buf_[0], in + first, (n - first) * sizeof(float));
+
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /* free space, for a producer that waits rather than drop */
+    size_t room() const
+    {
+        return capacity() - (head_.load(std::memory_order_relaxed) -
+                             tail_.load(std::memory_order_acquire));
+    }
+
+    /* consumer, or any thread for a depth reading ------------------------- */
+    size_t available() const
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);   // tail first: never passes head
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    /* the next n (<= available()) samples: a view into the ring when they
+       are contiguous, otherwise copied into scratch[n] */
+    const float* peek(size_t n, float* scratch) const
+    {
+        size_t pos   = tail_.load(std::memory_order_relaxed) & mask_;
+        size_t first = capacity() - pos;
+        if (n <= first) return &buf_[pos];
+
+        std::memcpy(scratch, &buf_[pos], first * sizeof(float));
+        std::memcpy(scratch + first, &buf_[0], (n - first) * sizeof(float));
+        return scratch;
+    }
+
+    void consume(size_t n)
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    /* samples lost to a full ring, and the deepest fill, since reset() (any thread) */
+    size_t dropped() const    { return dropped_.load(std::memory_order_relaxed); }
+    size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<float>  buf_;
+    size_t              mask_ = 0;
+
+    /* separate cache lines, each written by one side only */
+    alignas(64) std::atomic<size_t> head_    {0};
+    alignas(64) std::atomic<size_t> tail_    {0};
+    alignas(64) std::atomic<size_t> dropped_ {0};
+    std::atomic<size_t>             high_water_ {0};
+};
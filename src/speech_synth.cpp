@@ -0,0 +1,71 @@
+#include "speech_synth.h"
+
+#include <cstring>
+
+extern "C" {
+#include "rade_dsp.h"
+#include "fargan.h"
+#include "lpcnet.h"
+}
+
+static_assert(SpeechSynth::FRAME_SAMPLES == LPCNET_FRAME_SIZE, "FARGAN frame size");
+static_assert(SpeechSynth::NB_TOTAL_FEAT == RADE_NB_TOTAL_FEATURES, "RADE feature stride");
+
+SpeechSynth::~SpeechSynth()
+{
+    delete static_cast<FARGANState*>(fargan_);
+}
+
+/* ── (re)initialisation ──────────────────────────────────────────────
+ *
+ *  fargan_init() picks its own CPU kernels; use the receiver's arch instead
+ *  so an override (RADE_ARCH, rade_set_arch) covers synthesis too.
+ * ──────────────────────────────────────────────────────────────────── */
+
+void SpeechSynth::reset(int arch)
+{
+    if (!fargan_) fargan_ = new FARGANState;
+    FARGANState* st = static_cast<FARGANState*>(fargan_);
+    fargan_init(st);
+    st->arch = arch;
+    ready_        = false;
+    warmup_count_ = 0;
+}
+
+/* ── synthesis ───────────────────────────────────────────────────────── */
+
+int SpeechSynth::synthesize(const float* features, int n_features, float* pcm)
+{
+    FARGANState* st = static_cast<FARGANState*>(fargan_);
+    int n_frames = n_features / NB_TOTAL_FEAT;
+    int n_out    = 0;
+
+    for (int fi = 0; fi < n_frames; fi++) {
+        const float* feat = &features[fi * NB_TOTAL_FEAT];
+
+        /* ── FARGAN warmup: buffer first 5 frames ─────────────────── */
+        if (!ready_) {
+            std::memcpy(&warmup_buf_[warmup_count_ * NB_TOTAL_FEAT], feat,
+                        static_cast<size_t>(NB_TOTAL_FEAT) * sizeof(float));
+
+            if (++warmup_count_ >= WARMUP_FRAMES) {
+                /* pack to NB_FEATURES stride for fargan_cont */
+                float packed[WARMUP_FRAMES * NB_FEATURES];
+                for (int i = 0; i < WARMUP_FRAMES; i++)
+                    std::memcpy(&packed[i * NB_FEATURES],
+                                &warmup_buf_[i * NB_TOTAL_FEAT],
+                                static_cast<size_t>(NB_FEATURES) * sizeof(float));
+
+                float zeros[FARGAN_CONT_SAMPLES] = {};
+                fargan_cont(st, zeros, packed);
+                ready_ = true;
+            }
+            continue;   /* warmup frames not synthesised */
+        }
+
+        /* ── one 10-ms speech frame ───────────────────────────────── */
+        fargan_synthesize(st, &pcm[n_out], feat);
+        n_out += FRAME_SAMPLES;
+    }
+    return n_out;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+/* ── SpeechSynth ───────────────────────────────────────────────────────────
+ *
+ *  FARGAN vocoder fed with the RADE receiver's feature frames.  The first
+ *  five 10 ms frames after a reset only warm FARGAN up (fargan_cont), so
+ *  synthesize() returns no speech for them.  Used by the GUI's synthesis
+ *  stage and the headless batch decoder.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+class SpeechSynth {
+public:
+    static constexpr int FRAME_SAMPLES = 160;   // 10 ms at 16 kHz (LPCNET_FRAME_SIZE)
+    static constexpr int NB_TOTAL_FEAT = 36;    // RADE_NB_TOTAL_FEATURES
+    static constexpr int WARMUP_FRAMES = 5;
+
+    SpeechSynth() = default;
+    ~SpeechSynth();
+    SpeechSynth(const SpeechSynth&)            = delete;
+    SpeechSynth& operator=(const SpeechSynth&) = delete;
+
+    /* fresh FARGAN state using the given CPU arch (rade_arch()), warms up again */
+    void reset(int arch);
+    bool ready() const { return ready_; }
+
+    /* n_features floats, NB_TOTAL_FEAT per 10 ms frame; writes up to
+       n_features / NB_TOTAL_FEAT * FRAME_SAMPLES samples to pcm, returns
+       the number written */
+    int synthesize(const float* features, int n_features, float* pcm);
+
+private:
+    void* fargan_       = nullptr;   // FARGANState, opaque to keep the C header out
+    bool  ready_        = false;
+    int   warmup_count_ = 0;
+    float warmup_buf_[WARMUP_FRAMES * NB_TOTAL_FEAT] = {};
+};
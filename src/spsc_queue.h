@@ -0,0 +1,83 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/* ── SpscQueue ─────────────────────────────────────────────────────────────
+ *
+ *  Bounded lock-free single-producer / single-consumer queue of T, for
+ *  passing frames between pipeline stages.  Slots are allocated once by
+ *  reset() and filled in place: the producer claims the next free slot,
+ *  writes it and publishes it; the consumer reads the front slot and pops
+ *  it.  Nothing is copied or allocated on the way through.
+ *
+ *  A full queue is the backpressure signal: claim() returns nullptr and
+ *  the producer waits rather than drop.  size() and high_water() give the
+ *  current and deepest fill, for watching pipeline latency.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+template <typename T>
+class SpscQueue {
+public:
+    /* not thread-safe: call before the producer and consumer start ------- */
+    void reset(size_t min_capacity)
+    {
+        size_t cap = 1;
+        while (cap < min_capacity) cap <<= 1;
+        slots_.assign(cap, T());
+        mask_ = cap - 1;
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        high_water_.store(0, std::memory_order_relaxed);
+    }
+
+    size_t capacity() const { return slots_.size(); }
+
+    /* producer: next free slot, nullptr when full ------------------------ */
+    T* claim()
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= capacity()) return nullptr;
+        return &slots_[head & mask_];
+    }
+
+    void publish()
+    {
+        size_t head  = head_.load(std::memory_order_relaxed) + 1;
+        size_t depth = head - tail_.load(std::memory_order_relaxed);
+        if (depth > high_water_.load(std::memory_order_relaxed))
+            high_water_.store(depth, std::memory_order_relaxed);
+        head_.store(head, std::memory_order_release);
+    }
+
+    /* consumer: oldest published slot, nullptr when empty ---------------- */
+    T* front()
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (head_.load(std::memory_order_acquire) == tail) return nullptr;
+        return &slots_[tail & mask_];
+    }
+
+    void pop()
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /* depth counters (any thread, approximate while running) ------------- */
+    size_t size() const
+    {
+        size_t tail = tail_.load(std::memory_order_acquire);   // tail first: never passes head
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+    size_t high_water() const { return high_water_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<T> slots_;
+    size_t         mask_ = 0;
+
+    /* separate cache lines, each written by one side only */
+    alignas(64) std::atomic<size_t> head_       {0};
+    alignas(64) std::atomic<size_t> tail_       {0};
+    std::atomic<size_t>             high_water_ {0};
+};
@@ -0,0 +1,425 @@
+#include "wav_io.h"
+
+#include <algorithm>
+#include <cstring>
+
+/* ── WAV header (adapted from rade_demod.c) ──────────────────────────── */
+
+#define WAV_FMT_PCM        1
+#define WAV_FMT_FLOAT      3
+#define WAV_FMT_EXTENSIBLE 0xFFFE
+
+bool wav_read_header(FILE* f, wav_info& info)
+{
+    char     tag[4];
+    uint32_t riff_size;
+
+    if (std::fread(tag, 1, 4, f) != 4) return false;
+    /* RF64 (and BW64) keep the 64-bit sizes in a ds64 chunk */
+    bool rf64 = !std::memcmp(tag, "RF64", 4) || !std::memcmp(tag, "BW64", 4);
+    if (!rf64 && std::memcmp(tag, "RIFF", 4)) return false;
+    if (std::fread(&riff_size, 4, 1, f) != 1) return false;
+    if (std::fread(tag, 1, 4, f) != 4 || std::memcmp(tag, "WAVE", 4)) return false;
+
+    info.data_offset = -1;
+    info.sample_rate = 0;
+    uint64_t ds64_data_size = WAV_SIZE_UNKNOWN;
+
+    while (true) {
+        char     chunk_id[4];
+        uint32_t chunk_size;
+        if (std::fread(chunk_id, 1, 4, f) != 4) break;
+        if (std::fread(&chunk_size, 4, 1, f) != 1) break;
+
+        if (std::memcmp(chunk_id, "fmt ", 4) == 0) {
+            if (chunk_size < 16) return false;
+            uint8_t buf[40] = {};
+            uint32_t n = std::min<uint32_t>(chunk_size, sizeof(buf));
+            if (std::fread(buf, 1, n, f) != n) return false;
+
+            uint16_t audio_fmt, nch, bps;
+            uint32_t sr;
+            std::memcpy(&audio_fmt, buf + 0,  2);
+            std::memcpy(&nch,       buf + 2,  2);
+            std::memcpy(&sr,        buf + 4,  4);
+            std::memcpy(&bps,       buf + 14, 2);
+            if (audio_fmt == WAV_FMT_EXTENSIBLE && n >= 26)
+                std::memcpy(&audio_fmt, buf + 24, 2);   /* sub-format GUID */
+
+            info.sample_rate     = static_cast<int>(sr);
+            info.num_channels    = static_cast<int>(nch);
+            info.bits_per_sample = static_cast<int>(bps);
+            info.is_float        = (audio_fmt == WAV_FMT_FLOAT);
+            if (audio_fmt != WAV_FMT_PCM && audio_fmt != WAV_FMT_FLOAT) return false;
+
+            if (chunk_size > n)
+                std::fseek(f, static_cast<long>((chunk_size - n + 1) & ~1u), SEEK_CUR);
+
+        } else if (std::memcmp(chunk_id, "ds64", 4) == 0 && rf64) {
+            if (chunk_size < 24) return false;
+            uint8_t buf[24];
+            if (std::fread(buf, 1, 24, f) != 24) return false;
+            std::memcpy(&ds64_data_size, buf + 8, 8);
+            std::fseek(f, static_cast<long>((chunk_size - 24 + 1) & ~1u), SEEK_CUR);
+
+        } else if (std::memcmp(chunk_id, "data", 4) == 0) {
+            info.data_offset = std::ftell(f);
+            if (rf64 && chunk_size == 0xFFFFFFFFu)
+                info.data_size = ds64_data_size;
+            else if (chunk_size == 0xFFFFFFFFu)        /* written while streaming */
+                info.data_size = WAV_SIZE_UNKNOWN;
+            else
+                info.data_size = chunk_size;
+            break;
+        } else {
+            std::fseek(f, static_cast<long>((chunk_size + 1) & ~1u), SEEK_CUR);
+        }
+    }
+    return info.data_offset >= 0 && info.sample_rate > 0 && info.num_channels > 0;
+}
+
+/* ── sample conversion ─────────────────────────────────────────────────
+ *
+ *  One loop per format over a whole block, each simple enough for the
+ *  compiler to vectorise; memcpy keeps the unaligned loads well defined.
+ * ──────────────────────────────────────────────────────────────────── */
+
+static bool format_supported(const wav_info& w)
+{
+    if (w.is_float) return w.bits_per_sample == 32 || w.bits_per_sample == 64;
+    return w.bits_per_sample == 16 || w.bits_per_sample == 24 || w.bits_per_sample == 32;
+}
+
+static void convert_s16(const uint8_t* in, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int16_t v;
+        std::memcpy(&v, in + 2 * i, 2);
+        out[i] = v * (1.0f / 32768.0f);
+    }
+}
+
+static void convert_s24(const uint8_t* in, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        /* to the top of an int32, then an arithmetic shift sign-extends */
+        int32_t v = static_cast<int32_t>((static_cast<uint32_t>(in[3 * i + 2]) << 24) |
+                                         (static_cast<uint32_t>(in[3 * i + 1]) << 16) |
+                                         (static_cast<uint32_t>(in[3 * i])     << 8));
+        out[i] = static_cast<float>(v >> 8) * (1.0f / 8388608.0f);
+    }
+}
+
+static void convert_s32(const uint8_t* in, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t v;
+        std::memcpy(&v, in + 4 * i, 4);
+        out[i] = static_cast<float>(v) * (1.0f / 2147483648.0f);
+    }
+}
+
+static void convert_f32(const uint8_t* in, float* out, size_t n)
+{
+    std::memcpy(out, in, n * sizeof(float));
+}
+
+static void convert_f64(const uint8_t* in, float* out, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        double v;
+        std::memcpy(&v, in + 8 * i, 8);
+        out[i] = static_cast<float>(v);
+    }
+}
+
+/* ── WavReader ───────────────────────────────────────────────────────── */
+
+bool WavReader::open(const std::string& path, int out_rate, bool raw, int raw_rate)
+{
+    close();
+    error_.clear();
+    f_ = std::fopen(path.c_str(), "rb");
+    if (!f_) {
+        error_ = "can't open " + path;
+        return false;
+    }
+
+    if (raw) {
+        info_ = wav_info{raw_rate, 1, 16, false, 0, WAV_SIZE_UNKNOWN};
+    } else if (!wav_read_header(f_, info_)) {
+        error_ = path + ": not a WAV file (use --raw for raw samples)";
+        close();
+        return false;
+    } else if (!format_supported(info_)) {
+        error_ = path + ": unsupported WAV format";
+        close();
+        return false;
+    }
+
+    remaining_ = info_.data_size;
+    size_t frame_size = static_cast<size_t>(info_.num_channels) *
+                        static_cast<size_t>(info_.bits_per_sample / 8);
+    bytes_.resize(BLOCK_FRAMES * frame_size);
+
+    rs_.reset(info_.sample_rate, out_rate);
+
+    /* the data that is actually there, for a header written while
+       streaming or a file cut short (a pipe can't seek: the header's) */
+    uint64_t data_bytes = (remaining_ != WAV_SIZE_UNKNOWN) ? remaining_ : 0;
+    if (std::fseek(f_, 0, SEEK_END) == 0) {
+        long end = std::ftell(f_);
+        uint64_t there = (end > info_.data_offset) ? static_cast<uint64_t>(end - info_.data_offset) : 0;
+        data_bytes = (remaining_ != WAV_SIZE_UNKNOWN) ? std::min(there, remaining_) : there;
+        if (std::fseek(f_, info_.data_offset, SEEK_SET) != 0) {
+            error_ = path + ": seek error";
+            close();
+            return false;
+        }
+    }
+    uint64_t frames = data_bytes / frame_size;
+    length_ = rs_.passthrough() ? frames
+            : (frames * static_cast<uint64_t>(out_rate) + static_cast<uint64_t>(info_.sample_rate) - 1) /
+              static_cast<uint64_t>(info_.sample_rate);
+    in_.resize(BLOCK_FRAMES);
+    out_.clear();
+    out_pos_   = 0;
+    skip_      = rs_.delay();
+    in_frames_ = 0;
+    produced_  = 0;
+    eof_       = false;
+    return true;
+}
+
+void WavReader::close()
+{
+    if (f_) std::fclose(f_);
+    f_ = nullptr;
+    in_.clear();
+    in_.shrink_to_fit();
+    out_.clear();
+    out_.shrink_to_fit();
+    bytes_.clear();
+    bytes_.shrink_to_fit();
+}
+
+size_t WavReader::read_file(float* out, size_t n)
+{
+    if (!f_) return 0;
+    size_t nch         = static_cast<size_t>(info_.num_channels);
+    size_t sample_size = static_cast<size_t>(info_.bits_per_sample / 8);
+    size_t frame_size  = nch * sample_size;
+
+    size_t want = std::min(n, BLOCK_FRAMES) * frame_size;
+    if (remaining_ != WAV_SIZE_UNKNOWN) want = static_cast<size_t>(std::min<uint64_t>(want, remaining_));
+    size_t got = std::fread(bytes_.data(), 1, want, f_);
+    if (got < want && std::ferror(f_)) error_ = "read error";
+    if (remaining_ != WAV_SIZE_UNKNOWN) remaining_ -= got;
+
+    size_t frames  = got / frame_size;
+    size_t samples = frames * nch;
+
+    /* interleaved samples to float in place of the output when mono, else
+       in a scratch block that is then averaged down */
+    float  scratch[BLOCK_FRAMES * 2];
+    float* dst = (nch == 1) ? out : scratch;
+    for (size_t done = 0; done < samples; ) {
+        size_t m = (nch == 1) ? samples : std::min(samples - done, sizeof(scratch) / sizeof(scratch[0]) / nch * nch);
+        const uint8_t* src = bytes_.data() + done * sample_size;
+        if (info_.is_float)
+            (info_.bits_per_sample == 32 ? convert_f32 : convert_f64)(src, dst, m);
+        else if (info_.bits_per_sample == 16)
+            convert_s16(src, dst, m);
+        else if (info_.bits_per_sample == 24)
+            convert_s24(src, dst, m);
+        else
+            convert_s32(src, dst, m);
+
+        if (nch > 1) {
+            float scale = 1.0f / static_cast<float>(nch);
+            size_t f0 = done / nch;
+            for (size_t i = 0; i < m / nch; i++) {
+                float sum = 0.0f;
+                for (size_t ch = 0; ch < nch; ch++) sum += scratch[i * nch + ch];
+                out[f0 + i] = sum * scale;
+            }
+        }
+        done += m;
+    }
+    return frames;
+}
+
+/* resample the next block of the file into out_.  The filter delay is
+   dropped from the start and flushed out with zeros at the end, so output
+   sample k lines up with input time k * in / out and the count is the
+   same as for an ideal converter */
+bool WavReader::refill()
+{
+    if (eof_) return false;
+    out_.clear();
+    out_pos_ = 0;
+
+    size_t got = read_file(in_.data(), BLOCK_FRAMES);
+    in_frames_ += got;
+    if (got == 0) {
+        eof_ = true;
+        got  = rs_.delay() * static_cast<size_t>(rs_.in_rate()) / static_cast<size_t>(rs_.out_rate()) + 2;
+        std::fill_n(in_.begin(), got, 0.0f);
+    }
+
+    out_.resize(rs_.max_output(got));
+    out_.resize(rs_.process(in_.data(), got, out_.data()));
+    out_pos_ = std::min(skip_, out_.size());
+    skip_   -= out_pos_;
+
+    if (eof_) {
+        uint64_t total = (in_frames_ * static_cast<uint64_t>(rs_.out_rate()) + rs_.in_rate() - 1) /
+                         static_cast<uint64_t>(rs_.in_rate());
+        uint64_t left  = (total > produced_) ? total - produced_ : 0;
+        out_.resize(out_pos_ + static_cast<size_t>(std::min<uint64_t>(left, out_.size() - out_pos_)));
+    }
+    produced_ += out_.size() - out_pos_;
+    return out_pos_ < out_.size();
+}
+
+size_t WavReader::read(float* out, size_t n)
+{
+    if (!f_) return 0;
+
+    if (rs_.passthrough()) {                /* no resampling */
+        size_t got = 0;
+        while (got < n) {
+            size_t m = read_file(out + got, n - got);
+            if (m == 0) break;
+            got += m;
+        }
+        return got;
+    }
+
+    size_t got = 0;
+    while (got < n) {
+        if (out_pos_ == out_.size() && !refill()) {
+            if (eof_) break;
+            continue;                       /* a block still inside the filter delay */
+        }
+        size_t m = std::min(n - got, out_.size() - out_pos_);
+        std::memcpy(out + got, &out_[out_pos_], m * sizeof(float));
+        out_pos_ += m;
+        got      += m;
+    }
+    return got;
+}
+
+bool WavReader::skip(uint64_t n)
+{
+    if (!f_) return false;
+
+    if (rs_.passthrough()) {
+        uint64_t frame_size = static_cast<uint64_t>(info_.num_channels) *
+                              static_cast<uint64_t>(info_.bits_per_sample / 8);
+        uint64_t bytes = n * frame_size;
+        if (remaining_ != WAV_SIZE_UNKNOWN) {
+            bytes = std::min(bytes, remaining_);
+            remaining_ -= bytes;
+        }
+        for (; bytes > 0; ) {                   /* long may be 32 bit */
+            uint64_t step = std::min<uint64_t>(bytes, 1u << 30);
+            if (std::fseek(f_, static_cast<long>(step), SEEK_CUR) != 0) {
+                error_ = "seek error";
+                return false;
+            }
+            bytes -= step;
+        }
+        return true;
+    }
+
+    std::vector<float> scratch(BLOCK_FRAMES);
+    while (n > 0) {
+        size_t m = static_cast<size_t>(std::min<uint64_t>(n, BLOCK_FRAMES));
+        if (read(scratch.data(), m) < m) break;
+        n -= m;
+    }
+    return error_.empty();
+}
+
+/* ── WavWriter ───────────────────────────────────────────────────────── */
+
+static void put_le(uint8_t* p, uint64_t v, int n)
+{
+    for (int i = 0; i < n; i++) p[i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+/* 16-bit PCM header with room for a ds64 chunk, held by a JUNK chunk until
+   the data outgrows the 32-bit RIFF sizes (about 37 hours of 16 kHz mono),
+   when it becomes RF64 as in EBU Tech 3306 */
+static constexpr size_t WAV_HEADER_SIZE = 80;
+
+static bool write_header(FILE* f, int sample_rate, int channels, uint64_t data_size)
+{
+    bool rf64 = data_size > 0xFFFFFFFFu - (WAV_HEADER_SIZE - 8);
+    uint64_t riff_size = data_size + (WAV_HEADER_SIZE - 8);
+
+    uint8_t h[WAV_HEADER_SIZE] = {};
+    std::memcpy(h, rf64 ? "RF64" : "RIFF", 4);
+    put_le(h + 4, rf64 ? 0xFFFFFFFFu : riff_size, 4);
+    std::memcpy(h + 8, "WAVE", 4);
+    std::memcpy(h + 12, rf64 ? "ds64" : "JUNK", 4);
+    put_le(h + 16, 28, 4);
+    if (rf64) {
+        put_le(h + 20, riff_size, 8);
+        put_le(h + 28, data_size, 8);
+        put_le(h + 36, data_size / (2 * static_cast<uint64_t>(channels)), 8);   /* table length 0 */
+    }
+    std::memcpy(h + 48, "fmt ", 4);     put_le(h + 52, 16, 4);
+    put_le(h + 56, WAV_FMT_PCM, 2);     put_le(h + 58, static_cast<uint32_t>(channels), 2);
+    put_le(h + 60, static_cast<uint32_t>(sample_rate), 4);
+    put_le(h + 64, static_cast<uint32_t>(sample_rate * channels * 2), 4);
+    put_le(h + 68, static_cast<uint32_t>(channels * 2), 2);
+    put_le(h + 70, 16, 2);
+    std::memcpy(h + 72, "data", 4);     put_le(h + 76, rf64 ? 0xFFFFFFFFu : data_size, 4);
+    return std::fwrite(h, 1, sizeof(h), f) == sizeof(h);
+}
+
+bool WavWriter::open(const std::string& path, int sample_rate, int channels)
+{
+    close();
+    f_ = std::fopen(path.c_str(), "wb");
+    if (!f_) return false;
+    sample_rate_ = sample_rate;
+    channels_    = channels;
+    n_samples_   = 0;
+    ok_          = write_header(f_, sample_rate, channels, 0);
+    return ok_;
+}
+
+bool WavWriter::write(const float* in, size_t n)
+{
+    if (!f_) return false;
+    int16_t pcm[512];
+    for (size_t done = 0; done < n; ) {
+        size_t m = std::min(n - done, sizeof(pcm) / sizeof(pcm[0]));
+        for (size_t i = 0; i < m; i++) {
+            float s = in[done + i] * 32768.0f;
+            if (s > 32767.0f) s = 32767.0f;
+            if (s < -32768.0f) s = -32768.0f;
+            pcm[i] = static_cast<int16_t>(s);
+        }
+        if (std::fwrite(pcm, sizeof(int16_t), m, f_) != m) ok_ = false;
+        done += m;
+    }
+    n_samples_ += n;
+    return ok_;
+}
+
+bool WavWriter::close()
+{
+    if (!f_) return ok_;
+    /* patch the sizes now the length is known */
+    if (std::fseek(f_, 0, SEEK_SET) != 0 ||
+        !write_header(f_, sample_rate_, channels_,
+                      static_cast<uint64_t>(n_samples_) * sizeof(int16_t)))
+        ok_ = false;
+    if (std::fclose(f_) != 0) ok_ = false;
+    f_ = nullptr;
+    return ok_;
+}
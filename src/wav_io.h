@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "resampler.h"
+
+/* ── WAV / raw audio file I/O ──────────────────────────────────────────────
+ *
+ *  Shared by the GUI's file playback and the headless batch decoder.
+ *  WavReader streams mono float samples in [-1, 1) a block at a time, so
+ *  its memory is the same for a minute or a day of audio; multi-channel
+ *  files are averaged down and other sample rates converted on the way by
+ *  the polyphase Resampler.  The writer produces 16-bit PCM and patches
+ *  the sizes on close(), so it can stream output of unknown length; past
+ *  4 GB the header becomes RF64.
+ * ──────────────────────────────────────────────────────────────────────── */
+
+struct wav_info {
+    int      sample_rate;
+    int      num_channels;
+    int      bits_per_sample;
+    bool     is_float;
+    long     data_offset;
+    uint64_t data_size;        // bytes, WAV_SIZE_UNKNOWN when the data runs to EOF
+};
+
+static constexpr uint64_t WAV_SIZE_UNKNOWN = UINT64_MAX;
+
+/* parse the RIFF or RF64 header and leave f at the start of the data chunk */
+bool wav_read_header(FILE* f, wav_info& info);
+
+class WavReader {
+public:
+    static constexpr size_t BLOCK_FRAMES = 4096;
+
+    WavReader() = default;
+    ~WavReader() { close(); }
+    WavReader(const WavReader&)            = delete;
+    WavReader& operator=(const WavReader&) = delete;
+
+    /* a WAV file, or with raw headerless signed 16-bit mono at raw_rate;
+       read() returns samples at out_rate.  false with error() set on failure */
+    bool open(const std::string& path, int out_rate, bool raw = false, int raw_rate = 8000);
+    void close();
+
+    const wav_info&    info() const  { return info_; }
+    const std::string& error() const { return error_; }
+
+    /* samples at out_rate in the whole file, from the header and the file
+       size at open() */
+    uint64_t length() const { return length_; }
+
+    /* up to n samples at out_rate, fewer only at the end of the data (or on
+       a read error, see error()) */
+    size_t read(float* out, size_t n);
+
+    /* pass over the next n samples at out_rate, as if read: a seek when no
+       rate conversion is needed, otherwise they are converted and dropped
+       so what follows matches a straight read.  false on a seek error */
+    bool skip(uint64_t n);
+
+private:
+    size_t read_file(float* out, size_t n);     // mono at the file's rate
+    bool   refill();
+
+    FILE*                f_ = nullptr;
+    wav_info             info_{};
+    std::string          error_;
+    uint64_t             remaining_ = 0;        // data bytes not yet read
+    uint64_t             length_    = 0;
+    std::vector<uint8_t> bytes_;
+
+    /* file-rate blocks through the resampler, out_[out_pos_..] not yet read */
+    Resampler            rs_;
+    std::vector<float>   in_;
+    std::vector<float>   out_;
+    size_t               out_pos_   = 0;
+    size_t               skip_      = 0;        // filter delay still to drop
+    uint64_t             in_frames_ = 0;
+    uint64_t             produced_  = 0;
+    bool                 eof_       = false;
+};
+
+class WavWriter {
+public:
+    WavWriter() = default;
+    ~WavWriter() { close(); }
+    WavWriter(const WavWriter&)            = delete;
+    WavWriter& operator=(const WavWriter&) = delete;
+
+    bool open(const std::string& path, int sample_rate, int channels = 1);
+    bool write(const float* in, size_t n);    // n samples (all channels), clipped to 16 bit
+    bool close();                             // false if any write failed
+
+    size_t samples_written() const { return n_samples_; }
+
+private:
+    FILE*  f_           = nullptr;
+    int    sample_rate_ = 0;
+    int    channels_    = 1;
+    size_t n_samples_   = 0;
+    bool   ok_          = true;
+};
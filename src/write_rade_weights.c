@@ -0,0 +1,119 @@
+/*---------------------------------------------------------------------------*\
+
+  write_rade_weights.c
+
+  Writes the compiled-in RADAE decoder weights to a binary weight file
+  that rade_open() can map instead.
+
+  usage: write_rade_weights [--int8] rade_weights.bin
+
+  --int8 leaves out the float copy of every layer that has int8 weights,
+  the decoder then runs those layers quantized (like the RADE_INT8 flag)
+  from a file of about a quarter of the size.
+
+\*---------------------------------------------------------------------------*/
+
+/*
+  Copyright (C) 2024 David Rowe
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+  - Redistributions of source code must retain the above copyright
+  notice, this list of conditions and the following disclaimer.
+
+  - Redistributions in binary form must reproduce the above copyright
+  notice, this list of conditions and the following disclaimer in the
+  documentation and/or other materials provided with the distribution.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE FOUNDATION OR
+  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "nnet.h"
+#include "rade_core.h"
+
+/* True if name is "<layer>_weights_float" and "<layer>_weights_int8" is
+   also in the list */
+static int has_int8_copy(const WeightArray *list, const char *name) {
+    const char *suffix = "_weights_float";
+    size_t len = strlen(name), slen = strlen(suffix);
+    char int8_name[64];
+
+    if (len < slen || strcmp(name + len - slen, suffix) != 0 || len + 1 > sizeof(int8_name)) {
+        return 0;
+    }
+    memcpy(int8_name, name, len - slen);
+    strcpy(int8_name + len - slen, "_weights_int8");
+    for (int i = 0; list[i].name != NULL; i++) {
+        if (strcmp(list[i].name, int8_name) == 0) return 1;
+    }
+    return 0;
+}
+
+/* Same record layout as Opus write_lpcnet_weights.c, so parse_weights()
+   reads it back: a 64 byte header then the data padded to 64 bytes */
+static int write_weights(const WeightArray *list, int int8, FILE *fout) {
+    unsigned char zeros[WEIGHT_BLOCK_SIZE] = {0};
+
+    for (int i = 0; list[i].name != NULL; i++) {
+        WeightHead h;
+        if (int8 && has_int8_copy(list, list[i].name)) {
+            continue;
+        }
+        if (strlen(list[i].name) >= sizeof(h.name)) {
+            fprintf(stderr, "write_rade_weights: name %s too long\n", list[i].name);
+            return -1;
+        }
+        memset(&h, 0, sizeof(h));
+        memcpy(h.head, "DNNw", 4);
+        h.version = WEIGHT_BLOB_VERSION;
+        h.type = list[i].type;
+        h.size = list[i].size;
+        h.block_size = (h.size + WEIGHT_BLOCK_SIZE - 1) / WEIGHT_BLOCK_SIZE * WEIGHT_BLOCK_SIZE;
+        strcpy(h.name, list[i].name);
+
+        if (fwrite(&h, 1, WEIGHT_BLOCK_SIZE, fout) != WEIGHT_BLOCK_SIZE ||
+            fwrite(list[i].data, 1, h.size, fout) != (size_t)h.size ||
+            fwrite(zeros, 1, h.block_size - h.size, fout) != (size_t)(h.block_size - h.size)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    int int8 = (argc == 3 && strcmp(argv[1], "--int8") == 0);
+    if (argc != 2 + int8) {
+        fprintf(stderr, "usage: %s [--int8] rade_weights.bin\n", argv[0]);
+        return 1;
+    }
+    const char *path = argv[argc - 1];
+
+    FILE *fout = fopen(path, "wb");
+    if (fout == NULL) {
+        fprintf(stderr, "write_rade_weights: can't open %s\n", path);
+        return 1;
+    }
+    int ret = write_weights(radedec_arrays, int8, fout);
+    if (fclose(fout) != 0) ret = -1;
+    if (ret != 0) {
+        fprintf(stderr, "write_rade_weights: error writing %s\n", path);
+        remove(path);
+        return 1;
+    }
+    return 0;
+}
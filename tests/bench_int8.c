@@ -0,0 +1,170 @@
+/*---------------------------------------------------------------------------*\
+  bench_int8.c
+
+  Int8 decoder benchmark: run a float and an int8 (RADE_INT8) receiver side
+  by side over the same signal and report the feature error of the int8
+  path and the receiver time of both.
+
+  usage: bench_int8 [recording.wav]
+
+  The recording is 8 kHz 16 bit mono, e.g. from the app's raw recording.
+  Without one a synthetic signal of random latents is used.
+\*---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "rade_api.h"
+#include "rade_dsp.h"
+#include "rade_ofdm.h"
+#include "rade_hilbert.h"
+
+#define SYNTH_FRAMES    500         /* 60 s of synthetic modem frames */
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+/* Read a 16 bit mono 8 kHz WAV file as complex samples, returns NULL if the
+   file can't be read or has another format */
+static RADE_COMP *read_wav(const char *path, int *n_samples) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return NULL;
+
+    unsigned char hdr[12], chunk[8];
+    int channels = 0, rate = 0, bits = 0, format = 0;
+    RADE_COMP *out = NULL;
+
+    if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(&hdr[8], "WAVE", 4)) {
+        fclose(f);
+        return NULL;
+    }
+    while (fread(chunk, 1, 8, f) == 8) {
+        long len = chunk[4] | (chunk[5] << 8) | (chunk[6] << 16) | ((long)chunk[7] << 24);
+        if (memcmp(chunk, "fmt ", 4) == 0 && len >= 16) {
+            unsigned char fmt[16];
+            if (fread(fmt, 1, 16, f) != 16) break;
+            format = fmt[0] | (fmt[1] << 8);
+            channels = fmt[2] | (fmt[3] << 8);
+            rate = fmt[4] | (fmt[5] << 8) | (fmt[6] << 16);
+            bits = fmt[14] | (fmt[15] << 8);
+            fseek(f, len - 16 + (len & 1), SEEK_CUR);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (format != 1 || channels != 1 || rate != RADE_MODEM_SAMPLE_RATE || bits != 16) {
+                fprintf(stderr, "%s: need 16 bit mono %d Hz PCM\n", path, RADE_MODEM_SAMPLE_RATE);
+                break;
+            }
+            int n = (int)(len / 2);
+            short *pcm = (short *)malloc(sizeof(short) * (n > 0 ? n : 1));
+            float *x = (float *)malloc(sizeof(float) * (n > 0 ? n : 1));
+            out = (RADE_COMP *)malloc(sizeof(RADE_COMP) * (n > 0 ? n : 1));
+            n = (int)fread(pcm, sizeof(short), n, f);
+            for (int i = 0; i < n; i++) x[i] = pcm[i] / 32768.0f;
+            rade_hilbert hilbert;
+            rade_hilbert_init(&hilbert);
+            rade_hilbert_process(&hilbert, out, x, n);
+            *n_samples = n;
+            free(pcm);
+            free(x);
+            break;
+        } else {
+            fseek(f, len + (len & 1), SEEK_CUR);
+        }
+    }
+    fclose(f);
+    return out;
+}
+
+/* Random latents through the OFDM modulator, as the loopback test does */
+static RADE_COMP *synth_signal(int *n_samples) {
+    int n = SYNTH_FRAMES * RADE_NMF;
+    RADE_COMP *out = (RADE_COMP *)calloc(n, sizeof(RADE_COMP));
+    float z[RADE_NZMF * RADE_LATENT_DIM];
+    rade_ofdm ofdm;
+
+    rade_ofdm_init(&ofdm, 3);
+    srand(1);
+    for (int f = 0; f < SYNTH_FRAMES; f++) {
+        for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+            z[i] = 2.0f * (float)rand() / RAND_MAX - 1.0f;
+        }
+        rade_ofdm_mod_frame(&ofdm, &out[f * RADE_NMF], z);
+    }
+    *n_samples = n;
+    return out;
+}
+
+int main(int argc, char *argv[]) {
+    int n_samples = 0;
+    RADE_COMP *rx = (argc > 1) ? read_wav(argv[1], &n_samples) : synth_signal(&n_samples);
+    if (rx == NULL) {
+        fprintf(stderr, "can't read %s\n", argv[1]);
+        return 1;
+    }
+
+    struct rade *r_float = rade_open(NULL, RADE_VERBOSE_0);
+    struct rade *r_int8 = rade_open(NULL, RADE_VERBOSE_0 | RADE_INT8);
+    if (r_float == NULL || r_int8 == NULL) {
+        fprintf(stderr, "FAIL: rade_open\n");
+        return 1;
+    }
+
+    int n_feat = rade_n_features_in_out(r_float);
+    float *feat_float = (float *)calloc(n_feat, sizeof(float));
+    float *feat_int8 = (float *)calloc(n_feat, sizeof(float));
+    float *eoo = (float *)calloc(rade_n_eoo_bits(r_float), sizeof(float));
+
+    fprintf(stderr, "=== RADE int8 decoder benchmark (%s, %.1f s) ===\n",
+            argc > 1 ? argv[1] : "synthetic", (float)n_samples / RADE_MODEM_SAMPLE_RATE);
+
+    /* Both receivers see identical input, so their DSP (and nin) track */
+    double t_float = 0.0, t_int8 = 0.0;
+    double err2 = 0.0, sig2 = 0.0, max_err = 0.0;
+    int n_frames = 0;
+    for (int pos = 0; pos + rade_nin(r_float) <= n_samples; ) {
+        int nin = rade_nin(r_float);
+        if (rade_nin(r_int8) != nin) {
+            fprintf(stderr, "FAIL: receivers diverged at sample %d\n", pos);
+            return 1;
+        }
+        int has_eoo;
+
+        double t0 = now_s();
+        int n_out = rade_rx(r_float, feat_float, &has_eoo, eoo, &rx[pos]);
+        double t1 = now_s();
+        int n_out8 = rade_rx(r_int8, feat_int8, &has_eoo, eoo, &rx[pos]);
+        t_int8 += now_s() - t1;
+        t_float += t1 - t0;
+        pos += nin;
+
+        if (n_out > 0 && n_out8 == n_out) {
+            for (int i = 0; i < n_out; i++) {
+                double e = (double)feat_int8[i] - feat_float[i];
+                err2 += e * e;
+                sig2 += (double)feat_float[i] * feat_float[i];
+                if (fabs(e) > max_err) max_err = fabs(e);
+            }
+            n_frames++;
+        }
+    }
+
+    double dur = (double)n_samples / RADE_MODEM_SAMPLE_RATE;
+    fprintf(stderr, "decoded frames: %d\n", n_frames);
+    if (n_frames > 0) {
+        fprintf(stderr, "int8 feature SNR: %.1f dB  max abs error: %.4f\n",
+                10.0 * log10(sig2 / (err2 + 1E-30)), max_err);
+    }
+    fprintf(stderr, "rx time float: %.3f s (RTF %.4f)\n", t_float, t_float / dur);
+    fprintf(stderr, "rx time int8:  %.3f s (RTF %.4f)  %.2fx\n", t_int8, t_int8 / dur,
+            t_float / (t_int8 + 1E-12));
+
+    rade_close(r_float);
+    rade_close(r_int8);
+    free(feat_float); free(feat_int8); free(eoo); free(rx);
+    return 0;
+}
@@ -2,74 +2,23 @@
   test_loopback.c
 
   Loopback test: generate OFDM frames -> take real part -> Hilbert -> rade_rx
-  This verifies the C DSP stack can achieve sync on a known signal.
+  This verifies the C DSP stack can achieve sync on a known signal, and
+  that rade_rx_real() does as well without the Hilbert transformer, and
+  that RADE_FAST_MATH stays within tolerance of the exact equalizer.
 \*---------------------------------------------------------------------------*/
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #include "rade_api.h"
 #include "rade_dsp.h"
 #include "rade_ofdm.h"
 #include "rade_rx.h"
-
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-/* Hilbert transform FIR (same as rade_decoder.cpp) */
-#define HILBERT_NTAPS 127
-#define HILBERT_DELAY ((HILBERT_NTAPS - 1) / 2)  /* 63 */
-
-static float hilbert_coeffs[HILBERT_NTAPS];
-static float hilbert_hist[HILBERT_NTAPS];
-static int   hilbert_pos = 0;
-static float delay_buf[HILBERT_NTAPS];
-static int   delay_pos = 0;
-
-static void init_hilbert(void) {
-    int center = (HILBERT_NTAPS - 1) / 2;
-    for (int i = 0; i < HILBERT_NTAPS; i++) {
-        int n = i - center;
-        if (n == 0 || (n & 1) == 0) {
-            hilbert_coeffs[i] = 0.0f;
-        } else {
-            float h = 2.0f / (M_PI * n);
-            float w = 0.54f - 0.46f * cosf(2.0f * M_PI * i / (HILBERT_NTAPS - 1));
-            hilbert_coeffs[i] = h * w;
-        }
-    }
-    memset(hilbert_hist, 0, sizeof(hilbert_hist));
-    memset(delay_buf, 0, sizeof(delay_buf));
-    hilbert_pos = 0;
-    delay_pos = 0;
-}
-
-static void hilbert_process(const float *in, RADE_COMP *out, int n) {
-    for (int i = 0; i < n; i++) {
-        float sample = in[i];
-
-        hilbert_hist[hilbert_pos] = sample;
-
-        float imag = 0.0f;
-        for (int k = 0; k < HILBERT_NTAPS; k++) {
-            int idx = hilbert_pos - k;
-            if (idx < 0) idx += HILBERT_NTAPS;
-            imag += hilbert_coeffs[k] * hilbert_hist[idx];
-        }
-
-        delay_buf[delay_pos] = sample;
-        int read_pos = delay_pos - HILBERT_DELAY;
-        if (read_pos < 0) read_pos += HILBERT_NTAPS;
-        out[i].real = delay_buf[read_pos];
-        out[i].imag = imag;
-
-        hilbert_pos = (hilbert_pos + 1) % HILBERT_NTAPS;
-        delay_pos = (delay_pos + 1) % HILBERT_NTAPS;
-    }
-}
+#include "rade_bpf.h"
+#include "rade_hilbert.h"
 
 int main(int argc, char *argv[]) {
     (void)argc; (void)argv;
@@ -184,7 +133,8 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "Generated %d samples of real signal\n", total_samples);
 
         /* Apply Hilbert transform and feed to receiver */
-        init_hilbert();
+        rade_hilbert hilbert;
+        rade_hilbert_init(&hilbert);
 
         int tx_pos = 0;
         int synced = 0;
@@ -195,7 +145,7 @@ int main(int argc, char *argv[]) {
             if (avail < nin) break;
 
             /* Hilbert transform: real -> complex IQ */
-            hilbert_process(&real_signal[tx_pos], rx_buf, nin);
+            rade_hilbert_process(&hilbert, rx_buf, &real_signal[tx_pos], nin);
             tx_pos += nin;
 
             int has_eoo = 0;
@@ -285,6 +235,586 @@ int main(int argc, char *argv[]) {
         free(tx_signal);
     }
 
+    fprintf(stderr, "\n");
+
+    /* ── Test 3: Several receivers through rade_rx_multi() ─────────────── */
+    fprintf(stderr, "--- Test 3: Batched decoding with rade_rx_multi() ---\n");
+    {
+        enum { NSTREAMS = 5 };
+        struct rade *ref = rade_open(NULL, RADE_VERBOSE_0);
+        if (!ref) { fprintf(stderr, "FAIL: rade_open\n"); return 1; }
+
+        /* The batched receivers share one context, which they keep alive */
+        struct rade_context *ctx = rade_context_open(NULL, 0);
+        if (!ctx) { fprintf(stderr, "FAIL: rade_context_open\n"); return 1; }
+        struct rade *r[NSTREAMS];
+        for (int s = 0; s < NSTREAMS; s++) {
+            r[s] = rade_open_context(ctx, RADE_VERBOSE_0);
+            if (!r[s]) { fprintf(stderr, "FAIL: rade_open_context\n"); return 1; }
+        }
+        rade_context_close(ctx);
+
+        int n_feat = rade_n_features_in_out(ref);
+        int n_eoo = rade_n_eoo_bits(ref);
+        int Nmf = RADE_NMF;
+        int n_frames = 20;
+
+        /* Streams start at different offsets so they don't sync together */
+        RADE_COMP *tx_signal = (RADE_COMP *)calloc((n_frames + NSTREAMS) * Nmf, sizeof(RADE_COMP));
+        rade_ofdm ofdm;
+        rade_ofdm_init(&ofdm, 3);
+        float z[RADE_NZMF * RADE_LATENT_DIM];
+        for (int f = 0; f < n_frames + NSTREAMS; f++) {
+            for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+                z[i] = 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+            }
+            rade_ofdm_mod_frame(&ofdm, &tx_signal[f * Nmf], z);
+        }
+
+        float *ref_features = (float *)calloc(n_feat, sizeof(float));
+        float *features[NSTREAMS], *eoo[NSTREAMS];
+        RADE_COMP *rx_in[NSTREAMS];
+        int pos[NSTREAMS], n_out[NSTREAMS], has_eoo[NSTREAMS], decoded[NSTREAMS];
+        for (int s = 0; s < NSTREAMS; s++) {
+            features[s] = (float *)calloc(n_feat, sizeof(float));
+            eoo[s] = (float *)calloc(n_eoo, sizeof(float));
+            pos[s] = s * Nmf / 2;
+            decoded[s] = 0;
+        }
+
+        /* Stream 0 against a lone receiver on the same input */
+        float max_err = 0.0f;
+        for (int iter = 0; iter < n_frames; iter++) {
+            for (int s = 0; s < NSTREAMS; s++) {
+                rx_in[s] = &tx_signal[pos[s]];
+                pos[s] += rade_nin(r[s]);
+            }
+            int ref_has_eoo = 0;
+            int ref_out = rade_rx(ref, ref_features, &ref_has_eoo, eoo[0], rx_in[0]);
+            rade_rx_multi(r, NSTREAMS, n_out, features, has_eoo, eoo, rx_in);
+
+            if (n_out[0] != ref_out || rade_nin(r[0]) != rade_nin(ref)) {
+                fprintf(stderr, ">>> FAIL: stream 0 and lone receiver differ at frame %d\n", iter);
+                max_err = 1E9f;
+                break;
+            }
+            for (int i = 0; i < ref_out; i++) {
+                float e = fabsf(features[0][i] - ref_features[i]);
+                if (e > max_err) max_err = e;
+            }
+            for (int s = 0; s < NSTREAMS; s++) {
+                if (n_out[s] > 0) decoded[s]++;
+            }
+        }
+
+        int all_decoded = 1;
+        for (int s = 0; s < NSTREAMS; s++) {
+            if (!decoded[s]) all_decoded = 0;
+        }
+        fprintf(stderr, "Decoded frames per stream:");
+        for (int s = 0; s < NSTREAMS; s++) fprintf(stderr, " %d", decoded[s]);
+        fprintf(stderr, "\nMax feature difference batched vs single: %g\n", max_err);
+        if (!all_decoded || max_err > 1E-3f) {
+            fprintf(stderr, ">>> FAIL: batched decoding\n");
+        } else {
+            fprintf(stderr, ">>> Batched decoding matches\n");
+        }
+
+        for (int s = 0; s < NSTREAMS; s++) {
+            free(features[s]); free(eoo[s]);
+            rade_close(r[s]);
+        }
+        free(ref_features); free(tx_signal);
+        rade_close(ref);
+    }
+
+    fprintf(stderr, "\n");
+
+    /* ── Test 4: Demodulator and decoder run apart, as in a pipeline ───── */
+    fprintf(stderr, "--- Test 4: Split demod/decode with a lagging decoder ---\n");
+    {
+        enum { LAG = 2, MAX_DECODED = 32 };
+        struct rade *ref = rade_open(NULL, RADE_VERBOSE_0);
+        struct rade *r = rade_open(NULL, RADE_VERBOSE_0);
+        if (!ref || !r) { fprintf(stderr, "FAIL: rade_open\n"); return 1; }
+
+        /* Unique word errors reach the demodulator LAG frames late, which
+           can move an unsync on the random test latents, so keep sync */
+        rade_set_disable_unsync(ref, 0.1f);
+        rade_set_disable_unsync(r, 0.1f);
+
+        int n_feat = rade_n_features_in_out(ref);
+        int n_latent = rade_n_latent_frame(r);
+        int Nmf = RADE_NMF;
+        int n_frames = 20;
+
+        RADE_COMP *tx_signal = (RADE_COMP *)calloc((n_frames + 2) * Nmf, sizeof(RADE_COMP));
+        rade_ofdm ofdm;
+        rade_ofdm_init(&ofdm, 3);
+        float z[RADE_NZMF * RADE_LATENT_DIM];
+        for (int f = 0; f < n_frames + 2; f++) {
+            for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+                z[i] = 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+            }
+            rade_ofdm_mod_frame(&ofdm, &tx_signal[f * Nmf], z);
+        }
+
+        /* Latent frames wait LAG frames in a FIFO before being decoded,
+           the lone receiver's features are kept to compare against */
+        float *ref_features = (float *)calloc(MAX_DECODED * n_feat, sizeof(float));
+        float *latents = (float *)calloc(MAX_DECODED * n_latent, sizeof(float));
+        float *features = (float *)calloc(n_feat, sizeof(float));
+        float *eoo = (float *)calloc(rade_n_eoo_bits(r), sizeof(float));
+        int n_ref = 0, n_demod = 0, n_decoded = 0;
+        float max_err = 0.0f;
+        int pos = 0, ok = 1;
+
+        for (int iter = 0; iter < n_frames + LAG && ok; iter++) {
+            if (iter < n_frames) {
+                int has_eoo = 0;
+                int nin = rade_nin(r);
+                if (rade_nin(ref) != nin) { ok = 0; break; }
+                if (rade_rx(ref, &ref_features[n_ref * n_feat], &has_eoo, eoo, &tx_signal[pos])) {
+                    n_ref++;
+                }
+                if (rade_rx_demod_frame(r, &latents[n_demod * n_latent], &has_eoo, eoo, &tx_signal[pos])) {
+                    n_demod++;
+                }
+                pos += nin;
+                if (n_ref != n_demod || n_ref >= MAX_DECODED) { ok = 0; break; }
+            }
+            while (n_decoded < n_demod && (n_demod - n_decoded > LAG || iter >= n_frames)) {
+                rade_rx_decode_frame(r, features, &latents[n_decoded * n_latent]);
+                for (int i = 0; i < n_feat; i++) {
+                    float e = fabsf(features[i] - ref_features[n_decoded * n_feat + i]);
+                    if (e > max_err) max_err = e;
+                }
+                n_decoded++;
+            }
+        }
+
+        fprintf(stderr, "Decoded frames: %d (lone receiver %d)\n", n_decoded, n_ref);
+        fprintf(stderr, "Max feature difference split vs rade_rx(): %g\n", max_err);
+        if (!ok || n_decoded == 0 || n_decoded != n_ref || max_err > 1E-3f) {
+            fprintf(stderr, ">>> FAIL: split demod/decode\n");
+        } else {
+            fprintf(stderr, ">>> Split demod/decode matches\n");
+        }
+
+        free(ref_features); free(latents); free(features); free(eoo); free(tx_signal);
+        rade_close(r);
+        rade_close(ref);
+    }
+
+    fprintf(stderr, "\n");
+
+    /* ── Test 5: Restart points, for decoding a recording in segments ─── */
+    fprintf(stderr, "--- Test 5: Receivers started apart agree after a restart point ---\n");
+    {
+        enum { GAP = 20, OVER = 12, MAX_FRAMES = 128 };
+        int Nmf = RADE_NMF;
+        int n_frames = GAP + OVER + GAP + OVER + GAP;
+        int n_samples = n_frames * Nmf;
+
+        /* Two overs in low level noise */
+        RADE_COMP *tx_signal = (RADE_COMP *)calloc(n_samples, sizeof(RADE_COMP));
+        rade_ofdm ofdm;
+        rade_ofdm_init(&ofdm, 3);
+        float z[RADE_NZMF * RADE_LATENT_DIM];
+        for (int f = 0; f < n_frames; f++) {
+            int in_over = (f >= GAP && f < GAP + OVER) ||
+                          (f >= 2 * GAP + OVER && f < 2 * GAP + 2 * OVER);
+            if (!in_over) continue;
+            for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+                z[i] = 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+            }
+            rade_ofdm_mod_frame(&ofdm, &tx_signal[f * Nmf], z);
+        }
+        for (int i = 0; i < n_samples; i++) {
+            tx_signal[i].real += 0.01f * ((float)rand() / RAND_MAX - 0.5f);
+            tx_signal[i].imag += 0.01f * ((float)rand() / RAND_MAX - 0.5f);
+        }
+
+        /* Receiver 0 from the start, receiver 1 from inside the first over */
+        struct rade *r[2];
+        int start[2] = { 0, (GAP + OVER / 2) * Nmf };
+        int n_feat = 0;
+        int *end[2], *restart[2], *n_out[2], n_rx[2];
+        float *features[2];
+        float *eoo = NULL;
+        for (int s = 0; s < 2; s++) {
+            r[s] = rade_open(NULL, RADE_VERBOSE_0);
+            if (!r[s]) { fprintf(stderr, "FAIL: rade_open\n"); return 1; }
+            n_feat = rade_n_features_in_out(r[s]);
+            end[s] = (int *)calloc(MAX_FRAMES, sizeof(int));
+            restart[s] = (int *)calloc(MAX_FRAMES, sizeof(int));
+            n_out[s] = (int *)calloc(MAX_FRAMES, sizeof(int));
+            features[s] = (float *)calloc(MAX_FRAMES * n_feat, sizeof(float));
+        }
+        eoo = (float *)calloc(rade_n_eoo_bits(r[0]), sizeof(float));
+        if (start[1] % rade_frame_grid(r[1]) != 0) {
+            fprintf(stderr, ">>> FAIL: receiver 1 starts off the frame grid\n");
+        }
+
+        for (int s = 0; s < 2; s++) {
+            int pos = start[s];
+            n_rx[s] = 0;
+            while (n_rx[s] < MAX_FRAMES && n_samples - pos >= rade_nin(r[s])) {
+                int has_eoo = 0;
+                int f = n_rx[s]++;
+                int nin = rade_nin(r[s]);
+                n_out[s][f] = rade_rx(r[s], &features[s][f * n_feat], &has_eoo, eoo, &tx_signal[pos]);
+                pos += nin;
+                end[s][f] = pos;
+                restart[s][f] = rade_restart_point(r[s]);
+            }
+        }
+
+        /* First sample after which both are at a restart point */
+        int f0 = 0, f1 = 0, found = 0;
+        while (f0 < n_rx[0] && f1 < n_rx[1] && !found) {
+            if (end[0][f0] < end[1][f1]) f0++;
+            else if (end[1][f1] < end[0][f0]) f1++;
+            else if (restart[0][f0] && restart[1][f1]) found = 1;
+            else { f0++; f1++; }
+        }
+
+        int match = found && (n_rx[0] - f0 == n_rx[1] - f1);
+        int n_decoded = 0;
+        float max_err = 0.0f;
+        for (int k = 1; match && f0 + k < n_rx[0]; k++) {
+            int a = f0 + k, b = f1 + k;
+            if (end[0][a] != end[1][b] || n_out[0][a] != n_out[1][b]) { match = 0; break; }
+            for (int i = 0; i < n_out[0][a]; i++) {
+                float e = fabsf(features[0][a * n_feat + i] - features[1][b * n_feat + i]);
+                if (e > max_err) max_err = e;
+            }
+            n_decoded += (n_out[0][a] > 0);
+        }
+
+        if (found) {
+            fprintf(stderr, "Common restart point at sample %d, %d frames decoded after it\n",
+                    end[0][f0], n_decoded);
+        }
+        fprintf(stderr, "Max feature difference after the restart point: %g\n", max_err);
+        if (!match || n_decoded == 0 || max_err != 0.0f) {
+            fprintf(stderr, ">>> FAIL: receivers disagree after the restart point\n");
+        } else {
+            fprintf(stderr, ">>> Receivers agree after the restart point\n");
+        }
+
+        for (int s = 0; s < 2; s++) {
+            free(end[s]); free(restart[s]); free(n_out[s]); free(features[s]);
+            rade_close(r[s]);
+        }
+        free(eoo); free(tx_signal);
+    }
+
+    fprintf(stderr, "\n");
+
+    /* ── Test 6: Real input through the fused band-pass front end ──────── */
+    fprintf(stderr, "--- Test 6: rade_rx_real() against Hilbert -> rade_rx() ---\n");
+    {
+        enum { GAP = 8, OVER = 24, N_OVERS = 3 };
+        int Nmf = RADE_NMF;
+        int n_frames = GAP + N_OVERS * (OVER + GAP);
+        int n_samples = n_frames * Nmf;
+
+        /* Overs separated by silence, real part only */
+        RADE_COMP *tx_signal = (RADE_COMP *)calloc(n_samples, sizeof(RADE_COMP));
+        float *real_signal = (float *)calloc(n_samples, sizeof(float));
+        float *noisy = (float *)calloc(n_samples, sizeof(float));
+        rade_ofdm ofdm;
+        rade_ofdm_init(&ofdm, 3);
+        float z[RADE_NZMF * RADE_LATENT_DIM];
+        double p_sig = 0.0;
+        for (int f = GAP; f < n_frames; f++) {
+            if ((f - GAP) % (OVER + GAP) >= OVER) continue;
+            for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+                z[i] = 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+            }
+            rade_ofdm_mod_frame(&ofdm, &tx_signal[f * Nmf], z);
+        }
+        for (int i = 0; i < n_samples; i++) {
+            real_signal[i] = tx_signal[i].real;
+            p_sig += (double)real_signal[i] * real_signal[i];
+        }
+        p_sig /= N_OVERS * OVER * Nmf;
+
+        struct rade *r = rade_open(NULL, RADE_VERBOSE_0);
+        if (!r) { fprintf(stderr, "FAIL: rade_open\n"); return 1; }
+        int n_feat = rade_n_features_in_out(r);
+        float *features = (float *)calloc(n_feat, sizeof(float));
+        float *eoo = (float *)calloc(rade_n_eoo_bits(r), sizeof(float));
+        RADE_COMP *rx_buf = (RADE_COMP *)calloc(rade_nin_max(r), sizeof(RADE_COMP));
+        rade_close(r);
+
+        /* Same input both ways at each SNR (in the whole 4 kHz band), down
+           to where the Hilbert path starts to miss overs: the fused path must
+           sync as often and decode as many frames */
+        const float snr_dB[] = { 10.0f, 0.0f, -10.0f, -16.0f, -17.0f };
+        int fails = 0;
+        for (int t = 0; t < (int)(sizeof(snr_dB) / sizeof(snr_dB[0])); t++) {
+            float sigma = sqrtf((float)p_sig * powf(10.0f, -snr_dB[t] / 10.0f) * 3.0f);
+            for (int i = 0; i < n_samples; i++) {
+                noisy[i] = real_signal[i] + sigma * ((float)rand() / RAND_MAX - 0.5f) * 2.0f;
+            }
+
+            int decoded[2], syncs[2];
+            for (int path = 0; path < 2; path++) {
+                struct rade *rp = rade_open(NULL, RADE_VERBOSE_0);
+                rade_hilbert hilbert;
+                rade_hilbert_init(&hilbert);
+                int was_synced = 0;
+                decoded[path] = syncs[path] = 0;
+                for (int pos = 0; n_samples - pos >= rade_nin(rp); ) {
+                    int nin = rade_nin(rp);
+                    int has_eoo = 0, n_out;
+                    if (path == 0) {
+                        rade_hilbert_process(&hilbert, rx_buf, &noisy[pos], nin);
+                        n_out = rade_rx(rp, features, &has_eoo, eoo, rx_buf);
+                    } else {
+                        n_out = rade_rx_real(rp, features, &has_eoo, eoo, &noisy[pos]);
+                    }
+                    pos += nin;
+                    int synced = rade_sync(rp);
+                    syncs[path] += synced && !was_synced;
+                    was_synced = synced;
+                    decoded[path] += (n_out > 0);
+                }
+                rade_close(rp);
+            }
+
+            int ok = syncs[1] >= syncs[0] && decoded[1] >= decoded[0] * 9 / 10;
+            fprintf(stderr, "SNR %5.1f dB: Hilbert %d syncs %3d frames, fused %d syncs %3d frames  %s\n",
+                    snr_dB[t], syncs[0], decoded[0], syncs[1], decoded[1], ok ? "OK" : "FAIL");
+            fails += !ok;
+        }
+
+        /* Front end cost per input sample, one modem frame at a time */
+        {
+            /* The receiver's filter, as rade_rx_tables_init() designs it */
+            float w_min = ofdm.w[0], w_max = ofdm.w[RADE_NC - 1];
+            rade_bpf_taps taps;
+            rade_bpf_taps_init(&taps, RADE_BPF_NTAP, RADE_FS, 1.2f * (w_max - w_min) * RADE_FS / (2.0f * M_PI),
+                               (w_max + w_min) * RADE_FS / (2.0f * M_PI) / 2.0f);
+            rade_hilbert hilbert;
+            rade_bpf bpf;
+            rade_hilbert_init(&hilbert);
+            rade_bpf_init(&bpf, &taps, RADE_FS);
+            RADE_COMP *iq = (RADE_COMP *)calloc(Nmf, sizeof(RADE_COMP));
+            int reps = 60 * RADE_FS / n_samples + 1;
+
+            struct timespec t0, t1, t2;
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            for (int k = 0; k < reps; k++) {
+                for (int pos = 0; pos + Nmf <= n_samples; pos += Nmf) {
+                    rade_hilbert_process(&hilbert, iq, &noisy[pos], Nmf);
+                    rade_bpf_process(&bpf, rx_buf, iq, Nmf);
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            rade_bpf_reset(&bpf);
+            for (int k = 0; k < reps; k++) {
+                for (int pos = 0; pos + Nmf <= n_samples; pos += Nmf) {
+                    rade_bpf_process_real(&bpf, rx_buf, &noisy[pos], Nmf);
+                }
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t2);
+
+            double n = (double)reps * (n_samples / Nmf) * Nmf;
+            double t_sep = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1E-9;
+            double t_fused = (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec) * 1E-9;
+            fprintf(stderr, "Front end: Hilbert + BPF %.1f ns/sample, fused %.1f ns/sample (%.2fx)\n",
+                    t_sep / n * 1E9, t_fused / n * 1E9, t_fused / t_sep);
+
+            free(iq);
+        }
+
+        fprintf(stderr, fails ? ">>> FAIL: fused front end lost frames\n"
+                              : ">>> Fused front end matches the Hilbert path\n");
+        free(features); free(eoo); free(rx_buf); free(tx_signal); free(real_signal); free(noisy);
+    }
+
+    /* ── Test 7: Fast math equalizer within tolerance of the exact one ── */
+    fprintf(stderr, "--- Test 7: RADE_FAST_MATH features against the exact equalizer ---\n");
+    {
+        enum { GAP = 8, OVER = 24, N_OVERS = 3 };
+        int Nmf = RADE_NMF;
+        int n_frames = GAP + N_OVERS * (OVER + 2 + GAP);
+        int n_samples = n_frames * Nmf;
+
+        /* Overs ending in an EOO frame, separated by silence, real part only */
+        RADE_COMP *tx_signal = (RADE_COMP *)calloc(n_samples, sizeof(RADE_COMP));
+        float *real_signal = (float *)calloc(n_samples, sizeof(float));
+        float *noisy = (float *)calloc(n_samples, sizeof(float));
+        static rade_ofdm ofdm;
+        rade_ofdm_init(&ofdm, 3);
+        float z[RADE_NZMF * RADE_LATENT_DIM];
+        int n_eoo_samples;
+        const RADE_COMP *eoo_frame = rade_ofdm_get_eoo(&ofdm, &n_eoo_samples);
+        double p_sig = 0.0;
+        for (int o = 0; o < N_OVERS; o++) {
+            int f0 = GAP + o * (OVER + 2 + GAP);
+            for (int f = f0; f < f0 + OVER; f++) {
+                for (int i = 0; i < RADE_NZMF * RADE_LATENT_DIM; i++) {
+                    z[i] = 0.1f * ((float)rand() / RAND_MAX - 0.5f);
+                }
+                rade_ofdm_mod_frame(&ofdm, &tx_signal[f * Nmf], z);
+            }
+            memcpy(&tx_signal[(f0 + OVER) * Nmf], eoo_frame, sizeof(RADE_COMP) * n_eoo_samples);
+        }
+        for (int i = 0; i < n_samples; i++) {
+            real_signal[i] = tx_signal[i].real;
+            p_sig += (double)real_signal[i] * real_signal[i];
+        }
+        p_sig /= N_OVERS * OVER * Nmf;
+
+        struct rade *r = rade_open(NULL, RADE_VERBOSE_0);
+        if (!r) { fprintf(stderr, "FAIL: rade_open\n"); return 1; }
+        int n_feat = rade_n_features_in_out(r);
+        int n_eoo = rade_n_eoo_bits(r);
+        rade_close(r);
+        float *features[2], *eoo[2];
+        for (int k = 0; k < 2; k++) {
+            features[k] = (float *)calloc(n_feat, sizeof(float));
+            eoo[k] = (float *)calloc(n_eoo, sizeof(float));
+        }
+
+        /* Both receivers see the same input: they must sync, decode and
+           detect EOO on the same calls, with features that differ by no
+           more than float rounding carried through the decoder */
+        const float snr_dB[] = { 20.0f, 0.0f, -10.0f };
+        const double min_feat_snr_dB = 60.0;
+        int fails = 0;
+        for (int t = 0; t < (int)(sizeof(snr_dB) / sizeof(snr_dB[0])); t++) {
+            float sigma = sqrtf((float)p_sig * powf(10.0f, -snr_dB[t] / 10.0f) * 3.0f);
+            for (int i = 0; i < n_samples; i++) {
+                noisy[i] = real_signal[i] + sigma * ((float)rand() / RAND_MAX - 0.5f) * 2.0f;
+            }
+
+            struct rade *rp[2];
+            rp[0] = rade_open(NULL, RADE_VERBOSE_0);
+            rp[1] = rade_open(NULL, RADE_VERBOSE_0 | RADE_FAST_MATH);
+            int mismatch = 0, frames = 0, eoos = 0;
+            double p_feat = 0.0, p_err = 0.0, max_eoo_err = 0.0;
+            for (int pos = 0; n_samples - pos >= rade_nin(rp[0]); ) {
+                int nin = rade_nin(rp[0]);
+                if (rade_nin(rp[1]) != nin) { mismatch++; break; }
+                int n_out[2], has_eoo[2];
+                for (int k = 0; k < 2; k++) {
+                    has_eoo[k] = 0;
+                    n_out[k] = rade_rx_real(rp[k], features[k], &has_eoo[k], eoo[k], &noisy[pos]);
+                }
+                pos += nin;
+                if (n_out[0] != n_out[1] || has_eoo[0] != has_eoo[1]) { mismatch++; continue; }
+                for (int i = 0; i < n_out[0]; i++) {
+                    double e = features[1][i] - features[0][i];
+                    p_feat += (double)features[0][i] * features[0][i];
+                    p_err += e * e;
+                }
+                frames += (n_out[0] > 0);
+                if (has_eoo[0]) {
+                    for (int i = 0; i < n_eoo; i++) {
+                        max_eoo_err = fmax(max_eoo_err, fabs(eoo[1][i] - eoo[0][i]));
+                    }
+                    eoos++;
+                }
+            }
+            rade_close(rp[0]);
+            rade_close(rp[1]);
+
+            double feat_snr_dB = 10.0 * log10((p_feat + 1E-30) / (p_err + 1E-30));
+            int ok = mismatch == 0 && frames > 0 && feat_snr_dB > min_feat_snr_dB;
+            fprintf(stderr, "SNR %5.1f dB: %3d frames %d EOO, feature SNR %.1f dB, max EOO bit diff %.2e  %s\n",
+                    snr_dB[t], frames, eoos, feat_snr_dB, max_eoo_err, ok ? "OK" : "FAIL");
+            fails += !ok;
+        }
+
+        /* Equalizer cost per modem frame, normal and EOO, over the same spectra */
+        {
+            static rade_ofdm ofdm_fast;
+            ofdm_fast = ofdm;
+            ofdm_fast.fast_math = 1;
+            RADE_COMP rx_sym[(RADE_NS + 2) * RADE_NC];
+            float z_hat[RADE_NS * RADE_NC * 2];
+            float snr_est;
+            for (int i = 0; i < (RADE_NS + 2) * RADE_NC; i++) {
+                rx_sym[i] = rade_cmplx((float)rand() / RAND_MAX - 0.5f, (float)rand() / RAND_MAX - 0.5f);
+            }
+
+            /* Equalized symbols of each path straight from the spectra */
+            float z_fast[RADE_NS * RADE_NC * 2];
+            double max_eq_err = 0.0, max_eq = 0.0;
+            for (int eo = 0; eo < 2; eo++) {
+                int n = rade_ofdm_demod_frame_spectra(&ofdm, z_hat, rx_sym, eo, 1, &snr_est);
+                rade_ofdm_demod_frame_spectra(&ofdm_fast, z_fast, rx_sym, eo, 1, &snr_est);
+                for (int i = 0; i < n; i++) {
+                    max_eq_err = fmax(max_eq_err, fabs(z_fast[i] - z_hat[i]));
+                    max_eq = fmax(max_eq, fabs(z_hat[i]));
+                }
+            }
+            int eq_ok = max_eq_err < 1E-5 * max_eq;
+            fprintf(stderr, "Equalized symbols: max difference %.2e of %.2e  %s\n",
+                    max_eq_err, max_eq, eq_ok ? "OK" : "FAIL");
+            fails += !eq_ok;
+
+            int reps = 200000;
+            double t_eq[2][2];
+            for (int k = 0; k < 2; k++) {
+                const rade_ofdm *o = k ? &ofdm_fast : &ofdm;
+                for (int eo = 0; eo < 2; eo++) {
+                    struct timespec t0, t1;
+                    clock_gettime(CLOCK_MONOTONIC, &t0);
+                    for (int i = 0; i < reps; i++) {
+                        rade_ofdm_demod_frame_spectra(o, z_hat, rx_sym, eo, 1, &snr_est);
+                        rx_sym[0].real += 1E-9f * z_hat[0];
+                    }
+                    clock_gettime(CLOCK_MONOTONIC, &t1);
+                    t_eq[k][eo] = ((t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1E-9) / reps;
+                }
+            }
+            fprintf(stderr, "Equalizer: exact %.2f us/frame (EOO %.2f), fast %.2f us/frame (EOO %.2f), %.1fx\n",
+                    t_eq[0][0] * 1E6, t_eq[0][1] * 1E6, t_eq[1][0] * 1E6, t_eq[1][1] * 1E6,
+                    t_eq[0][0] / t_eq[1][0]);
+        }
+
+        fprintf(stderr, fails ? ">>> FAIL: fast math equalizer outside tolerance\n"
+                              : ">>> Fast math equalizer within tolerance\n");
+        for (int k = 0; k < 2; k++) { free(features[k]); free(eoo[k]); }
+        free(tx_signal); free(real_signal); free(noisy);
+    }
+
+    /* ── Test 8: Per-receiver memory ─────────────────────────────────── */
+    fprintf(stderr, "--- Test 8: Per-receiver memory ---\n");
+    {
+        /* A receiver on a shared context holds its state and acquisition
+           grids, sized for the context's search range. A +/-50 Hz receiver
+           must stay under the limit whatever the wide search needs */
+        const size_t rx_bytes_max = 400 * 1024;
+        size_t rx_bytes[2];
+        int fails = 0;
+        for (int wide = 0; wide < 2; wide++) {
+            rade_rx_tables *tab = (rade_rx_tables *)malloc(sizeof(rade_rx_tables));
+            rade_rx_state *rx = (rade_rx_state *)malloc(sizeof(rade_rx_state));
+            if (!tab || !rx || rade_rx_tables_init(tab, NULL, 3, 1, wide) != 0 ||
+                rade_rx_init(rx, tab, 1) != 0) {
+                fprintf(stderr, "FAIL: rade_rx_init\n");
+                return 1;
+            }
+            rx_bytes[wide] = sizeof(rade_rx_state) + rade_acq_grid_size(&tab->acq);
+            fprintf(stderr, "%s: %3d frequencies, %5zu kB per receiver (%zu kB grids), "
+                    "%zu kB shared tables\n", wide ? "+/-1 kHz" : "+/-50 Hz ",
+                    tab->acq.n_fcoarse, rx_bytes[wide] / 1024,
+                    rade_acq_grid_size(&tab->acq) / 1024, sizeof(rade_rx_tables) / 1024);
+            rade_rx_close(rx);
+            free(rx); free(tab);
+        }
+        if (rx_bytes[0] > rx_bytes_max || rx_bytes[1] <= rx_bytes[0]) fails++;
+        fprintf(stderr, fails ? ">>> FAIL: receiver over %zu kB\n"
+                              : ">>> Receiver under %zu kB\n", rx_bytes_max / 1024);
+    }
+
     fprintf(stderr, "\n=== Tests complete ===\n");
     return 0;
 }
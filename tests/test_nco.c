@@ -0,0 +1,215 @@
+/*---------------------------------------------------------------------------*\
+  test_nco.c
+
+  NCO test: phasor accuracy against a double precision reference, phase
+  drift over hours of frame by frame frequency correction, continuity
+  across frequency changes, exact repetition of the table, and the cost
+  per sample against a sincos per sample.
+\*---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "rade_dsp.h"
+#include "rade_nco.h"
+#include "rade_vec.h"
+
+#define FRAME_N         (RADE_NMF + RADE_M + RADE_NCP)  /* Frequency corrector call */
+#define DRIFT_HOURS     4
+#define CHECK_STRIDE    7           /* Samples between checks in the drift run */
+#define PHASE_TOL       1E-5        /* Radians, any sample */
+#define MAG_TOL         1E-5        /* |y| - 1, any sample */
+#define DRIFT_TOL       1E-7        /* Radians, oscillator phase after DRIFT_HOURS */
+#define TIME_ITERS      20000
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+/* Phase and magnitude error of y against exp(j*theta) */
+static void error(RADE_COMP y, double theta, double *phase_err, double *mag_err) {
+    double c = cos(theta), s = sin(theta);
+    double re = y.real * c + y.imag * s;
+    double im = y.imag * c - y.real * s;
+    *phase_err = fabs(atan2(im, re));
+    *mag_err = fabs(sqrt(re * re + im * im) - 1.0);
+}
+
+/*---------------------------------------------------------------------------*\
+                               ACCURACY
+\*---------------------------------------------------------------------------*/
+
+static int test_accuracy(void) {
+    static const float freqs_Hz[] = { 0.0f, 0.1f, -2.5f, 37.3f, -100.0f, 1500.0f, 3999.0f };
+    static RADE_COMP y[3 * RADE_NCO_RESEED + 5];
+    int n = sizeof(y) / sizeof(y[0]);
+    int fails = 0;
+
+    for (int f = 0; f < (int)(sizeof(freqs_Hz) / sizeof(freqs_Hz[0])); f++) {
+        float w = 2.0f * M_PI * freqs_Hz[f] / RADE_FS;
+        rade_nco nco;
+        rade_nco_init(&nco, w);
+        rade_nco_set_phase(&nco, 1.0);
+        rade_nco_gen(&nco, y, n);
+
+        double max_phase = 0.0, max_mag = 0.0;
+        for (int k = 0; k < n; k++) {
+            double pe, me;
+            error(y[k], 1.0 + (double)w * k, &pe, &me);
+            max_phase = fmax(max_phase, pe);
+            max_mag = fmax(max_mag, me);
+        }
+        int ok = max_phase < PHASE_TOL && max_mag < MAG_TOL;
+        fprintf(stderr, "  %7.1f Hz: phase %.2e rad  magnitude %.2e  %s\n",
+                freqs_Hz[f], max_phase, max_mag, ok ? "OK" : "FAIL");
+        fails += !ok;
+    }
+    return fails;
+}
+
+/*---------------------------------------------------------------------------*\
+                                 DRIFT
+\*---------------------------------------------------------------------------*/
+
+/* The receiver's use: one mix of FRAME_N samples per modem frame at the
+   frequency estimate, the phase carrying on.  The reference phase of
+   sample k is k*w reduced in double, exact to ~1E-9 rad at these lengths */
+static int test_drift(void) {
+    float w = 2.0f * M_PI * -37.3f / RADE_FS;
+    long frames = (long)DRIFT_HOURS * 3600 * RADE_FS / RADE_NMF;
+    static RADE_COMP y[FRAME_N];
+    rade_nco nco;
+    rade_nco_init(&nco, 0.0f);
+
+    /* The per-sample recursion this replaces, renormalised once a frame */
+    RADE_COMP old_phase = rade_cone();
+    RADE_COMP old_inc = rade_cexp(w);
+
+    double max_phase = 0.0, max_mag = 0.0;
+    long k = 0;
+    for (long fr = 0; fr < frames; fr++) {
+        rade_nco_set_freq(&nco, w);
+        rade_nco_gen(&nco, y, FRAME_N);
+        for (int i = 0; i < FRAME_N; i += CHECK_STRIDE) {
+            double pe, me;
+            error(y[i], remainder((double)w * (k + i), 2.0 * M_PI), &pe, &me);
+            max_phase = fmax(max_phase, pe);
+            max_mag = fmax(max_mag, me);
+        }
+        for (int i = 0; i < FRAME_N; i++) old_phase = rade_cmul(old_phase, old_inc);
+        old_phase = rade_cscale(old_phase, 1.0f / rade_cabs(old_phase));
+        k += FRAME_N;
+    }
+
+    double ref = remainder((double)w * k, 2.0 * M_PI);
+    double drift = fabs(remainder(nco.phase - ref, 2.0 * M_PI));
+    double old_pe, old_me;
+    error(old_phase, remainder((double)w * k, 2.0 * M_PI), &old_pe, &old_me);
+
+    int ok = max_phase < PHASE_TOL && max_mag < MAG_TOL && drift < DRIFT_TOL;
+    fprintf(stderr, "  %d hours (%ld samples): worst phase %.2e rad  magnitude %.2e  "
+            "drift %.2e rad  %s\n", DRIFT_HOURS, k, max_phase, max_mag, drift, ok ? "OK" : "FAIL");
+    fprintf(stderr, "  per-sample recursion over the same run: drift %.2e rad\n", old_pe);
+    return ok ? 0 : 1;
+}
+
+/* Frequency steps every call, as the corrector's estimate moves: the phase
+   must carry on from the last sample at the old frequency */
+static int test_continuity(void) {
+    static RADE_COMP y[FRAME_N];
+    rade_nco nco;
+    rade_nco_init(&nco, 0.0f);
+    srand(1);
+
+    double theta = 0.0, max_phase = 0.0, max_mag = 0.0;
+    for (int fr = 0; fr < 1000; fr++) {
+        float w = 2.0f * M_PI * (200.0f * rand() / RAND_MAX - 100.0f) / RADE_FS;
+        int n = 1 + rand() % FRAME_N;
+        rade_nco_set_freq(&nco, w);
+        rade_nco_gen(&nco, y, n);
+        for (int i = 0; i < n; i++) {
+            double pe, me;
+            error(y[i], theta + (double)w * i, &pe, &me);
+            max_phase = fmax(max_phase, pe);
+            max_mag = fmax(max_mag, me);
+        }
+        theta = remainder(theta + (double)w * n, 2.0 * M_PI);
+    }
+    int ok = max_phase < PHASE_TOL && max_mag < MAG_TOL;
+    fprintf(stderr, "  frequency steps: phase %.2e rad  magnitude %.2e  %s\n",
+            max_phase, max_mag, ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------*\
+                                 TABLE
+\*---------------------------------------------------------------------------*/
+
+static int test_table(void) {
+    static RADE_COMP y[2 * RADE_NMF];
+    int cycles = 180, period = RADE_NMF;
+    rade_nco_table(y, cycles, period, 2 * period);
+
+    int fails = 0;
+    double max_phase = 0.0;
+    for (int k = 0; k < period; k++) {
+        if (y[k].real != y[k + period].real || y[k].imag != y[k + period].imag) fails++;
+        double pe, me;
+        error(y[k], 2.0 * M_PI * cycles * k / period, &pe, &me);
+        max_phase = fmax(max_phase, pe);
+    }
+    int ok = fails == 0 && max_phase < PHASE_TOL;
+    fprintf(stderr, "  table: %d entries differ a period apart, phase %.2e rad  %s\n",
+            fails, max_phase, ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------*\
+                                TIMING
+\*---------------------------------------------------------------------------*/
+
+static void test_timing(void) {
+    static RADE_COMP x[FRAME_N], y[FRAME_N];
+    float w = 2.0f * M_PI * 37.3f / RADE_FS;
+    for (int i = 0; i < FRAME_N; i++) x[i] = rade_cmplx(1.0f, 0.5f);
+
+    rade_nco nco;
+    rade_nco_init(&nco, w);
+    double t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) rade_nco_mix(&nco, y, x, FRAME_N);
+    double t_nco = now_s() - t0;
+
+    volatile float sink = 0.0f;
+    t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) {
+        for (int i = 0; i < FRAME_N; i++) y[i] = rade_cmul(x[i], rade_cexp(w * i));
+        sink += y[FRAME_N - 1].real;
+    }
+    double t_cexp = now_s() - t0;
+
+    double scale = 1E9 / ((double)TIME_ITERS * FRAME_N);
+    fprintf(stderr, "Timing (mix, ns/sample): nco %.2f  cexp per sample %.2f  (%.1fx)\n",
+            t_nco * scale, t_cexp * scale, t_cexp / t_nco);
+}
+
+int main(void) {
+    fprintf(stderr, "=== RADE NCO Test (%s) ===\n", rade_vec_impl());
+    int fails = 0;
+
+    fprintf(stderr, "Accuracy:\n");
+    fails += test_accuracy();
+    fprintf(stderr, "Drift:\n");
+    fails += test_drift();
+    fails += test_continuity();
+    fprintf(stderr, "Table:\n");
+    fails += test_table();
+
+    test_timing();
+
+    fprintf(stderr, "\n=== Tests complete: %s ===\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,215 @@
+/*---------------------------------------------------------------------------*\
+  test_resampler.cpp
+
+  Resampler test: passband ripple, alias/image rejection and streaming
+  exactness for the rate pairs the app uses, the adaptive ratio mode, and
+  the cost per output sample of each path.
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+#include "resampler.h"
+#include "rade_vec.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define TEST_SECONDS    2
+#define PASS_EDGE       0.75    /* of the lower Nyquist rate */
+#define RIPPLE_DB       0.1     /* up to PASS_EDGE */
+#define REJECT_DB       (-70.0) /* aliases, images and stopband tones */
+#define TIME_SECONDS    20
+
+struct RatePair { int in, out; };
+static const RatePair PAIRS[] = {
+    {48000, 8000}, {44100, 8000}, {16000, 48000}, {16000, 44100}, {8000, 16000},
+};
+
+static double now_s() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static std::vector<float> run(Resampler& rs, const std::vector<float>& in, size_t block) {
+    std::vector<float> out;
+    std::vector<float> tmp;
+    for (size_t i = 0; i < in.size(); i += block) {
+        size_t n = std::min(block, in.size() - i);
+        tmp.resize(rs.max_output(n));
+        size_t got = rs.process(&in[i], n, tmp.data());
+        out.insert(out.end(), tmp.begin(), tmp.begin() + got);
+    }
+    return out;
+}
+
+static std::vector<float> tone(int rate, double f, size_t n) {
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = 0.5f * (float)std::sin(2.0 * M_PI * f * i / rate);
+    return x;
+}
+
+/* least squares fit of a tone at f over the settled part of y: amplitude,
+   and the power of everything else relative to the 0.5 input amplitude */
+static void fit(const std::vector<float>& y, size_t skip, int rate, double f,
+                double& amp, double& resid_dB) {
+    double ss = 0, cc = 0, sc = 0, sy = 0, cy = 0;
+    for (size_t i = skip; i < y.size(); i++) {
+        double s = std::sin(2.0 * M_PI * f * i / rate), c = std::cos(2.0 * M_PI * f * i / rate);
+        ss += s * s; cc += c * c; sc += s * c; sy += s * y[i]; cy += c * y[i];
+    }
+    double det = ss * cc - sc * sc;
+    double a = (det > 0) ? (sy * cc - cy * sc) / det : 0.0;
+    double b = (det > 0) ? (cy * ss - sy * sc) / det : 0.0;
+    double e = 0;
+    for (size_t i = skip; i < y.size(); i++) {
+        double s = std::sin(2.0 * M_PI * f * i / rate), c = std::cos(2.0 * M_PI * f * i / rate);
+        double r = y[i] - a * s - b * c;
+        e += r * r;
+    }
+    amp = std::sqrt(a * a + b * b);
+    resid_dB = 10.0 * std::log10(e / (y.size() - skip) / 0.125 + 1E-30);
+}
+
+/*---------------------------------------------------------------------------*\
+                               RESPONSE
+\*---------------------------------------------------------------------------*/
+
+static int test_response(const RatePair& p) {
+    Resampler rs;
+    rs.reset(p.in, p.out);
+    size_t n    = (size_t)p.in * TEST_SECONDS;
+    size_t skip = 2 * rs.delay();
+    double nyq  = 0.5 * std::min(p.in, p.out);
+    int fails = 0;
+
+    double ripple = 0, worst_in = -200;
+    for (double f = 100.0; f <= PASS_EDGE * nyq; f += PASS_EDGE * nyq / 17) {
+        rs.clear();
+        std::vector<float> y = run(rs, tone(p.in, f, n), 1000);
+        double amp, resid;
+        fit(y, skip, p.out, f, amp, resid);
+        ripple   = std::max(ripple, std::fabs(20.0 * std::log10(amp / 0.5)));
+        worst_in = std::max(worst_in, resid);
+    }
+
+    /* tones the output can't carry: must be filtered, not folded back */
+    double worst_out = -200;
+    for (double f = 1.1 * nyq; f < 0.5 * p.in; f += (0.5 * p.in - 1.1 * nyq) / 13) {
+        rs.clear();
+        std::vector<float> y = run(rs, tone(p.in, f, n), 1000);
+        double e = 0;
+        for (size_t i = skip; i < y.size(); i++) e += (double)y[i] * y[i];
+        worst_out = std::max(worst_out, 10.0 * std::log10(e / (y.size() - skip) / 0.125 + 1E-30));
+    }
+
+    if (ripple > RIPPLE_DB || worst_in > REJECT_DB || worst_out > REJECT_DB) fails++;
+    char stop[32] = "n/a";
+    if (p.in > p.out) snprintf(stop, sizeof(stop), "%.1f dB", worst_out);
+    fprintf(stderr, "  %5d -> %5d: ripple %.3f dB  alias/image %.1f dB  stopband %s  %s\n",
+            p.in, p.out, ripple, worst_in, stop, fails ? "FAIL" : "OK");
+    return fails;
+}
+
+/*---------------------------------------------------------------------------*\
+                              STREAMING
+\*---------------------------------------------------------------------------*/
+
+/* block size must not change a single sample */
+static int test_streaming(const RatePair& p) {
+    std::vector<float> x((size_t)p.in);
+    for (float& v : x) v = 2.0f * (float)rand() / RAND_MAX - 1.0f;
+
+    Resampler a, b;
+    a.reset(p.in, p.out);
+    b.reset(p.in, p.out);
+    std::vector<float> ya = run(a, x, x.size());
+
+    std::vector<float> yb, tmp;
+    for (size_t i = 0; i < x.size(); ) {
+        size_t n = std::min((size_t)(rand() % 700), x.size() - i);
+        tmp.resize(b.max_output(n));
+        size_t got = b.process(&x[i], n, tmp.data());
+        yb.insert(yb.end(), tmp.begin(), tmp.begin() + got);
+        i += n;
+    }
+
+    size_t expect = x.size() * (size_t)p.out / (size_t)p.in;
+    bool ok = ya == yb && ya.size() >= expect && ya.size() <= expect + 1;
+    if (!ok)
+        fprintf(stderr, "  %5d -> %5d: streaming FAIL (%zu vs %zu samples, expected %zu)\n",
+                p.in, p.out, ya.size(), yb.size(), expect);
+    return ok ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------*\
+                               ADAPTIVE
+\*---------------------------------------------------------------------------*/
+
+/* a trimmed ratio shifts the tone by the trim and keeps it clean */
+static int test_adaptive(const RatePair& p, double adjust) {
+    Resampler rs;
+    rs.reset(p.in, p.out);
+    rs.set_ratio_adjust(adjust);
+    double f = 0.3 * std::min(p.in, p.out);
+    size_t n = (size_t)p.in * TEST_SECONDS;
+    std::vector<float> y = run(rs, tone(p.in, f, n), 1000);
+
+    size_t skip = 2 * rs.delay();
+    double amp, resid;
+    fit(y, skip, p.out, f * (1.0 + adjust), amp, resid);
+    double expect = n * (double)p.out / p.in / (1.0 + adjust);
+
+    bool ok = std::fabs(y.size() - expect) <= 2.0 && resid < REJECT_DB &&
+              std::fabs(20.0 * std::log10(amp / 0.5)) < RIPPLE_DB;
+    fprintf(stderr, "  %5d -> %5d adjust %+.4f: %zu samples (expected %.0f)  residual %.1f dB  %s\n",
+            p.in, p.out, adjust, y.size(), expect, resid, ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------*\
+                                TIMING
+\*---------------------------------------------------------------------------*/
+
+static void test_timing(const RatePair& p) {
+    Resampler rs;
+    rs.reset(p.in, p.out);
+    std::vector<float> x((size_t)p.in * TIME_SECONDS);
+    for (float& v : x) v = 2.0f * (float)rand() / RAND_MAX - 1.0f;
+
+    double t0 = now_s();
+    std::vector<float> y = run(rs, x, 480);
+    double t = now_s() - t0;
+    fprintf(stderr, "  %5d -> %5d: %.1f ns/output  %.0fx real time\n",
+            p.in, p.out, t / y.size() * 1E9, TIME_SECONDS / t);
+}
+
+int main() {
+    fprintf(stderr, "=== Resampler Test (%s) ===\n", rade_vec_impl());
+    srand(1);
+    int fails = 0;
+
+    fprintf(stderr, "Response:\n");
+    for (const RatePair& p : PAIRS) fails += test_response(p);
+
+    int stream_fails = 0;
+    for (const RatePair& p : PAIRS) stream_fails += test_streaming(p);
+    fprintf(stderr, "Streaming: %s\n", stream_fails ? "FAIL" : "PASS");
+    fails += stream_fails;
+
+    fprintf(stderr, "Adaptive:\n");
+    for (double adj : {0.0005, -0.002})
+        for (const RatePair& p : PAIRS) fails += test_adaptive(p, adj);
+
+    fprintf(stderr, "Timing:\n");
+    for (const RatePair& p : PAIRS) test_timing(p);
+
+    fprintf(stderr, "\n=== Tests complete: %s ===\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}
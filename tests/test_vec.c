@@ -0,0 +1,241 @@
+/*---------------------------------------------------------------------------*\
+  test_vec.c
+
+  Vector kernel test: compare each rade_vec kernel with a double precision
+  reference over lengths that exercise the vector body and scalar tail,
+  then time the kernels against plain scalar loops.
+\*---------------------------------------------------------------------------*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "rade_dsp.h"
+#include "rade_vec.h"
+
+#define MAX_N           512
+#define TIME_N          RADE_M      /* Correlation length used by the receiver */
+#define TIME_ITERS      200000
+
+/* Tolerance relative to the sum of magnitudes of the terms, covers float
+   rounding with the different summation order of the vector paths */
+#define REL_TOL         1E-5
+
+static float frand(void) {
+    return 2.0f * (float)rand() / RAND_MAX - 1.0f;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1E-9;
+}
+
+static int check(const char *name, int n, double err, double scale) {
+    if (err > REL_TOL * (scale + 1E-12)) {
+        fprintf(stderr, "FAIL %s n=%d err=%g scale=%g\n", name, n, err, scale);
+        return 1;
+    }
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*\
+                               ACCURACY
+\*---------------------------------------------------------------------------*/
+
+static int test_accuracy(void) {
+    static float a_re[MAX_N], a_im[MAX_N], b_re[MAX_N], b_im[MAX_N];
+    static RADE_COMP a[MAX_N], b[MAX_N], y[MAX_N];
+    static float mag[MAX_N];
+    int fails = 0;
+
+    for (int n = 0; n <= MAX_N; n += (n < 40) ? 1 : 37) {
+        for (int i = 0; i < n; i++) {
+            a[i] = rade_cmplx(frand(), frand());
+            b[i] = rade_cmplx(frand(), frand());
+        }
+        rade_vec_split(a_re, a_im, a, n);
+        rade_vec_split(b_re, b_im, b, n);
+
+        /* real dot */
+        double ref = 0.0, scale = 0.0;
+        for (int i = 0; i < n; i++) {
+            ref += (double)a_re[i] * b_re[i];
+            scale += fabs((double)a_re[i] * b_re[i]);
+        }
+        fails += check("dot", n, fabs(rade_vec_dot(a_re, b_re, n) - ref), scale);
+
+        /* paired real dots against a_im too */
+        double ref1 = 0.0, scale1 = 0.0;
+        for (int i = 0; i < n; i++) {
+            ref1 += (double)a_im[i] * b_re[i];
+            scale1 += fabs((double)a_im[i] * b_re[i]);
+        }
+        float d0, d1;
+        rade_vec_dot2(&d0, &d1, a_re, a_im, b_re, n);
+        fails += check("dot2", n, fabs(d0 - ref), scale);
+        fails += check("dot2", n, fabs(d1 - ref1), scale1);
+
+        /* folded block FIRs over a_re, odd length n/4 + 1 or so */
+        int nt = (n / 4) | 1;
+        if (n >= 2 * nt) {
+            static float h[MAX_N], yf[MAX_N];
+            for (int anti = 0; anti < 2; anti++) {
+                for (int i = 0; i <= nt / 2; i++) {
+                    h[i] = b_im[i];
+                    h[nt - 1 - i] = anti ? -b_im[i] : b_im[i];
+                }
+                if (anti) {
+                    h[nt / 2] = 0.0f;
+                    rade_vec_fir_antisym(yf, h, a_re, nt, n - nt + 1);
+                } else {
+                    rade_vec_fir_sym(yf, h, a_re, nt, n - nt + 1);
+                }
+                for (int i = 0; i + nt <= n; i++) {
+                    double ref_f = 0.0, scale_f = 0.0;
+                    for (int k = 0; k < nt; k++) {
+                        ref_f += (double)h[k] * a_re[i + k];
+                        scale_f += fabs((double)h[k] * a_re[i + k]);
+                    }
+                    fails += check(anti ? "fir_antisym" : "fir_sym", n, fabs(yf[i] - ref_f), scale_f);
+                }
+            }
+        }
+
+        /* complex dot */
+        double ref_re = 0.0, ref_im = 0.0;
+        scale = 0.0;
+        for (int i = 0; i < n; i++) {
+            ref_re += (double)a_re[i] * b_re[i] - (double)a_im[i] * b_im[i];
+            ref_im += (double)a_re[i] * b_im[i] + (double)a_im[i] * b_re[i];
+            scale += rade_cabs(a[i]) * rade_cabs(b[i]);
+        }
+        RADE_COMP d = rade_vec_cdot(a_re, a_im, b_re, b_im, n);
+        fails += check("cdot", n, hypot(d.real - ref_re, d.imag - ref_im), scale);
+
+        /* complex multiply, then magnitude of the product */
+        rade_vec_cmul(y, a, b, n);
+        rade_vec_cabs(mag, y, n);
+        for (int i = 0; i < n; i++) {
+            double p_re = (double)a[i].real * b[i].real - (double)a[i].imag * b[i].imag;
+            double p_im = (double)a[i].real * b[i].imag + (double)a[i].imag * b[i].real;
+            double p_abs = hypot(p_re, p_im);
+            fails += check("cmul", n, hypot(y[i].real - p_re, y[i].imag - p_im), p_abs);
+            fails += check("cabs", n, fabs(mag[i] - p_abs), p_abs);
+        }
+
+        /* de-rotation of a by the phase of b, in place */
+        memcpy(y, a, sizeof(RADE_COMP) * n);
+        rade_vec_derotate(y, y, b, n);
+        for (int i = 0; i < n; i++) {
+            double b_abs = hypot(b[i].real, b[i].imag);
+            double p_re = ((double)a[i].real * b[i].real + (double)a[i].imag * b[i].imag) / b_abs;
+            double p_im = ((double)a[i].imag * b[i].real - (double)a[i].real * b[i].imag) / b_abs;
+            fails += check("derotate", n, hypot(y[i].real - p_re, y[i].imag - p_im), hypot(p_re, p_im));
+        }
+
+        /* matrix product, 3 rows of a by 2 rows of b, each of length n/3 */
+        int nk = n / 3;
+        RADE_COMP prod[3 * 2];
+        rade_vec_cmatmul(prod, a_re, a_im, 3, b_re, b_im, 2, nk);
+        for (int j = 0; j < 2; j++) {
+            for (int i = 0; i < 3; i++) {
+                ref_re = ref_im = scale = 0.0;
+                for (int k = 0; k < nk; k++) {
+                    RADE_COMP ai = a[i * nk + k], bj = b[j * nk + k];
+                    ref_re += (double)ai.real * bj.real - (double)ai.imag * bj.imag;
+                    ref_im += (double)ai.real * bj.imag + (double)ai.imag * bj.real;
+                    scale += rade_cabs(ai) * rade_cabs(bj);
+                }
+                RADE_COMP yij = prod[i * 2 + j];
+                fails += check("cmatmul", n, hypot(yij.real - ref_re, yij.imag - ref_im), scale);
+            }
+        }
+
+        /* conjugating split */
+        rade_vec_split_conj(b_re, b_im, a, n);
+        for (int i = 0; i < n; i++) {
+            if (b_re[i] != a[i].real || b_im[i] != -a[i].imag) {
+                fprintf(stderr, "FAIL split_conj n=%d i=%d\n", n, i);
+                fails++;
+                break;
+            }
+        }
+    }
+
+    return fails;
+}
+
+/*---------------------------------------------------------------------------*\
+                                TIMING
+\*---------------------------------------------------------------------------*/
+
+static void test_timing(void) {
+    static float a_re[TIME_N], a_im[TIME_N], b_re[TIME_N], b_im[TIME_N];
+    static RADE_COMP a[TIME_N], b[TIME_N], y[TIME_N];
+    volatile float sink = 0.0f;
+
+    for (int i = 0; i < TIME_N; i++) {
+        a[i] = rade_cmplx(frand(), frand());
+        b[i] = rade_cmplx(frand(), frand());
+    }
+    rade_vec_split(a_re, a_im, a, TIME_N);
+    rade_vec_split(b_re, b_im, b, TIME_N);
+
+    /* Interleaved scalar correlation, as the DSP code did before */
+    double t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) {
+        RADE_COMP acc = rade_czero();
+        for (int i = 0; i < TIME_N; i++) {
+            acc = rade_cadd(acc, rade_cmul(a[i], b[i]));
+        }
+        sink += acc.real;
+        a[it % TIME_N].real += 1E-9f;
+    }
+    double t_ref = now_s() - t0;
+
+    t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) {
+        RADE_COMP acc = rade_vec_cdot(a_re, a_im, b_re, b_im, TIME_N);
+        sink += acc.real;
+        a_re[it % TIME_N] += 1E-9f;
+    }
+    double t_cdot = now_s() - t0;
+
+    t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) {
+        for (int i = 0; i < TIME_N; i++) {
+            y[i] = rade_cmul(a[i], b[i]);
+        }
+        sink += y[it % TIME_N].real;
+    }
+    double t_ref_mul = now_s() - t0;
+
+    t0 = now_s();
+    for (int it = 0; it < TIME_ITERS; it++) {
+        rade_vec_cmul(y, a, b, TIME_N);
+        sink += y[it % TIME_N].real;
+    }
+    double t_mul = now_s() - t0;
+
+    fprintf(stderr, "  cdot  n=%d: scalar %.1f ns  %s %.1f ns  (%.1fx)\n", TIME_N,
+            t_ref / TIME_ITERS * 1E9, rade_vec_impl(), t_cdot / TIME_ITERS * 1E9, t_ref / t_cdot);
+    fprintf(stderr, "  cmul  n=%d: scalar %.1f ns  %s %.1f ns  (%.1fx)\n", TIME_N,
+            t_ref_mul / TIME_ITERS * 1E9, rade_vec_impl(), t_mul / TIME_ITERS * 1E9, t_ref_mul / t_mul);
+    (void)sink;
+}
+
+int main(void) {
+    fprintf(stderr, "=== RADE Vector Kernel Test (%s) ===\n", rade_vec_impl());
+
+    srand(1);
+    int fails = test_accuracy();
+    fprintf(stderr, "Accuracy: %s (relative tolerance %g)\n", fails ? "FAIL" : "PASS", REL_TOL);
+
+    test_timing();
+
+    fprintf(stderr, "\n=== Tests complete ===\n");
+    return fails ? 1 : 0;
+}
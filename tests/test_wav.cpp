@@ -0,0 +1,239 @@
+/*---------------------------------------------------------------------------*\
+  test_wav.cpp
+
+  WAV reader/writer test: every sample format, multi-channel downmix,
+  RF64/ds64 and streamed headers, exact output length across the
+  resampler flush, skip(), and a writer round trip.
+\*---------------------------------------------------------------------------*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "wav_io.h"
+
+#define TOL     1E-6f   /* downmix by 1/3 isn't exact in float */
+
+enum Header { HDR_RIFF, HDR_RF64, HDR_STREAMED };
+
+struct Format {
+    const char* name;
+    int  bits;
+    bool is_float;
+};
+static const Format FORMATS[] = {
+    {"s16", 16, false}, {"s24", 24, false}, {"s32", 32, false},
+    {"f32", 32, true},  {"f64", 64, true},
+};
+
+static std::string tmp_path(const char* name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+static void put(std::vector<uint8_t>& b, uint64_t v, int n) {
+    for (int i = 0; i < n; i++) b.push_back((uint8_t)(v >> (8 * i)));
+}
+static void put_tag(std::vector<uint8_t>& b, const char* tag) {
+    b.insert(b.end(), tag, tag + 4);
+}
+
+/* the test signal: a multiple of 2^-15 in every channel, so each format
+   holds it exactly, with channel offsets that cancel in the downmix */
+static float expected(size_t i) {
+    return (float)((int)(i * 37 % 2001) - 1000) / 32768.0f;
+}
+static float channel(size_t i, int ch, int nch) {
+    return expected(i) + (float)(2 * ch - (nch - 1)) * 64.0f / 32768.0f;
+}
+
+static void put_sample(std::vector<uint8_t>& b, const Format& f, float v) {
+    if (f.is_float && f.bits == 32) {
+        uint32_t u; std::memcpy(&u, &v, 4); put(b, u, 4);
+    } else if (f.is_float) {
+        double d = v; uint64_t u; std::memcpy(&u, &d, 8); put(b, u, 8);
+    } else {
+        int64_t q = (int64_t)std::lround((double)v * (double)(1LL << (f.bits - 1)));
+        put(b, (uint64_t)q, f.bits / 8);
+    }
+}
+
+/* a WAV file of frames x nch, with a chunk after the data that must not
+   be read as samples when the header gives the data size */
+static std::string write_test_wav(const char* name, const Format& f, int rate, int nch,
+                                  size_t frames, Header hdr) {
+    std::vector<uint8_t> data;
+    for (size_t i = 0; i < frames; i++)
+        for (int ch = 0; ch < nch; ch++) put_sample(data, f, channel(i, ch, nch));
+
+    std::vector<uint8_t> b;
+    put_tag(b, hdr == HDR_RF64 ? "RF64" : "RIFF");
+    put(b, 0xFFFFFFFFu, 4);                     /* riff size, unused by the reader */
+    put_tag(b, "WAVE");
+    if (hdr == HDR_RF64) {
+        put_tag(b, "ds64"); put(b, 28, 4);
+        put(b, 0, 8);                           /* riff size */
+        put(b, data.size(), 8);                 /* data size */
+        put(b, frames, 8);                      /* sample count */
+        put(b, 0, 4);                           /* table length */
+    }
+    put_tag(b, "fmt "); put(b, 16, 4);
+    put(b, f.is_float ? 3 : 1, 2); put(b, (uint64_t)nch, 2);
+    put(b, (uint64_t)rate, 4);     put(b, (uint64_t)rate * nch * f.bits / 8, 4);
+    put(b, (uint64_t)nch * f.bits / 8, 2); put(b, (uint64_t)f.bits, 2);
+    put_tag(b, "data");
+    put(b, hdr == HDR_RIFF ? data.size() : 0xFFFFFFFFu, 4);
+    b.insert(b.end(), data.begin(), data.end());
+    if (hdr != HDR_STREAMED) {
+        put_tag(b, "LIST"); put(b, 8, 4); put(b, 0x1234567890ABCDEFull, 8);
+    }
+
+    std::string path = tmp_path(name);
+    FILE* fp = std::fopen(path.c_str(), "wb");
+    if (fp) {
+        std::fwrite(b.data(), 1, b.size(), fp);
+        std::fclose(fp);
+    }
+    return path;
+}
+
+static std::vector<float> read_all(WavReader& r, size_t block) {
+    std::vector<float> out, buf(block);
+    for (size_t n; (n = r.read(buf.data(), block)) > 0; )
+        out.insert(out.end(), buf.begin(), buf.begin() + n);
+    return out;
+}
+
+/*---------------------------------------------------------------------------*\
+                                FORMATS
+\*---------------------------------------------------------------------------*/
+
+/* every format, mono to 6 channels, at the output rate: exact samples */
+static int test_formats(Header hdr) {
+    static const char* HDR_NAMES[] = {"RIFF", "RF64", "streamed"};
+    const size_t frames = 10007;
+    int fails = 0;
+    for (const Format& f : FORMATS) {
+        for (int nch : {1, 2, 3, 6}) {
+            std::string path = write_test_wav("test_wav_fmt.wav", f, 8000, nch, frames, hdr);
+            WavReader r;
+            if (!r.open(path, 8000)) {
+                fprintf(stderr, "  %s %s %dch: %s  FAIL\n", HDR_NAMES[hdr], f.name, nch,
+                        r.error().c_str());
+                fails++;
+                continue;
+            }
+            std::vector<float> y = read_all(r, 1000);
+            float err = 0.0f;
+            for (size_t i = 0; i < std::min(y.size(), frames); i++)
+                err = std::max(err, std::fabs(y[i] - expected(i)));
+            bool ok = y.size() == frames && r.length() == frames && err <= TOL &&
+                      r.error().empty();
+            if (!ok) {
+                fprintf(stderr, "  %s %s %dch: %zu samples (length %llu, expected %zu)  "
+                        "error %.2g  FAIL\n", HDR_NAMES[hdr], f.name, nch, y.size(),
+                        (unsigned long long)r.length(), frames, (double)err);
+                fails++;
+            }
+        }
+    }
+    fprintf(stderr, "  %-8s  %s\n", HDR_NAMES[hdr], fails ? "FAIL" : "OK");
+    std::filesystem::remove(tmp_path("test_wav_fmt.wav"));
+    return fails;
+}
+
+/*---------------------------------------------------------------------------*\
+                                 LENGTH
+\*---------------------------------------------------------------------------*/
+
+/* resampled to 8 kHz: ceil(frames * 8000 / rate) samples after the flush,
+   whatever the block size, and skip() lands on the same samples */
+struct LengthCase {
+    const char* name;
+    Header hdr;
+    int    format;          /* index into FORMATS */
+    int    rate, nch;
+    size_t frames;
+    size_t expect;
+};
+static const LengthCase LENGTHS[] = {
+    {"RF64 stereo s24 48k",  HDR_RF64, 1, 48000, 2, 480000, 80000},
+    {"mono s16 48k",         HDR_RIFF, 0, 48000, 1, 480000, 80000},
+    {"mono s16 48k + 5",     HDR_RIFF, 0, 48000, 1, 480005, 80001},
+    {"mono s16 44.1k",       HDR_RIFF, 0, 44100, 1, 441000, 80000},
+    {"mono f32 44.1k + 7",   HDR_RIFF, 3, 44100, 1, 132307, 24002},
+    {"stereo f64 16k",       HDR_RIFF, 4, 16000, 2, 160001, 80001},
+};
+
+static int test_length(const LengthCase& c) {
+    std::string path = write_test_wav("test_wav_len.wav", FORMATS[c.format], c.rate, c.nch,
+                                      c.frames, c.hdr);
+    WavReader a, b, s;
+    bool opened = a.open(path, 8000) && b.open(path, 8000) && s.open(path, 8000);
+    std::vector<float> ya = opened ? read_all(a, 4096) : std::vector<float>();
+    std::vector<float> yb = opened ? read_all(b, 333) : std::vector<float>();
+
+    const size_t k = 12345;
+    bool skip_ok = opened && s.skip(k);
+    std::vector<float> ys = skip_ok ? read_all(s, 1000) : std::vector<float>();
+    skip_ok = skip_ok && ys.size() + k == ya.size() &&
+              std::equal(ys.begin(), ys.end(), ya.begin() + k);
+
+    bool ok = opened && ya.size() == c.expect && a.length() == c.expect && ya == yb && skip_ok;
+    fprintf(stderr, "  %-20s %zu samples (length %llu, expected %zu)  skip %s  %s\n",
+            c.name, ya.size(), (unsigned long long)a.length(), c.expect,
+            skip_ok ? "ok" : "differs", ok ? "OK" : "FAIL");
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
+
+/*---------------------------------------------------------------------------*\
+                                 WRITER
+\*---------------------------------------------------------------------------*/
+
+/* 16-bit round trip, including clipping */
+static int test_writer() {
+    std::string path = tmp_path("test_wav_out.wav");
+    const size_t n = 16001;
+    std::vector<float> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = expected(i);
+    x[1] = 1.5f;
+    x[2] = -1.5f;
+
+    WavWriter w;
+    bool ok = w.open(path, 16000) && w.write(x.data(), n) && w.close() &&
+              w.samples_written() == n;
+
+    WavReader r;
+    ok = ok && r.open(path, 16000);
+    std::vector<float> y = ok ? read_all(r, 1000) : std::vector<float>();
+    ok = ok && y.size() == n && r.info().sample_rate == 16000 &&
+         r.info().num_channels == 1 && r.info().bits_per_sample == 16;
+    for (size_t i = 0; ok && i < n; i++) {
+        float want = (i == 1) ? 32767.0f / 32768.0f : (i == 2) ? -1.0f : x[i];
+        ok = y[i] == want;
+    }
+    fprintf(stderr, "Writer: %s\n", ok ? "PASS" : "FAIL");
+    std::filesystem::remove(path);
+    return ok ? 0 : 1;
+}
+
+int main() {
+    fprintf(stderr, "=== WAV I/O Test ===\n");
+    int fails = 0;
+
+    fprintf(stderr, "Formats (16/24/32-bit, float 32/64, 1-6 channels):\n");
+    for (Header h : {HDR_RIFF, HDR_RF64, HDR_STREAMED}) fails += test_formats(h);
+
+    fprintf(stderr, "Length at 8 kHz:\n");
+    for (const LengthCase& c : LENGTHS) fails += test_length(c);
+
+    fails += test_writer();
+
+    fprintf(stderr, "\n=== Tests complete: %s ===\n", fails ? "FAIL" : "PASS");
+    return fails ? 1 : 0;
+}